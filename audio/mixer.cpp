@@ -22,6 +22,8 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -143,6 +145,11 @@ public:
 	 */
 	SoundHandle getHandle() const { return _handle; }
 
+	/**
+	 * Queries the number of sample pairs mixed so far.
+	 */
+	uint32 getSamplesMixed() const { return _samplesDecoded; }
+
 private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
@@ -172,51 +179,233 @@ private:
 #pragma mark --- Mixer ---
 #pragma mark -
 
-MixerImpl::MixerImpl(uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+uint MixerImpl::getConfiguredChannelCount(uint numChannels) {
+	if (numChannels == 0 && ConfMan.hasKey("mixer_channels"))
+		numChannels = ConfMan.getInt("mixer_channels");
+	if (numChannels == 0)
+		return DEFAULT_NUM_CHANNELS;
+	return CLIP<uint>(numChannels, 1, MAX_NUM_CHANNELS);
+}
+
+MixerImpl::MixerImpl(uint sampleRate, uint numChannels)
+	: _mutex(), _queueMutex(), _sampleRate(sampleRate), _numChannels(getConfiguredChannelCount(numChannels)),
+	  _mixerReady(0), _handleSeed(0), _soundTypeSettings(), _commandsHead(0), _commandsTail(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	_channels = new Channel *[_numChannels];
+	_channelStates = new ChannelState[_numChannels];
+
+	for (uint i = 0; i != _numChannels; i++)
 		_channels[i] = 0;
+
+	for (int i = 0; i != ARRAYSIZE(_samplesMixed); i++)
+		_samplesMixed[i] = 0;
 }
 
 MixerImpl::~MixerImpl() {
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	processCommands();
+
+	for (uint i = 0; i != _numChannels; i++)
 		delete _channels[i];
+
+	delete[] _channels;
+	delete[] _channelStates;
 }
 
 void MixerImpl::setReady(bool ready) {
-	Common::StackLock lock(_mutex);
-
-	_mixerReady = ready;
+	_mixerReady.store(ready);
 }
 
 uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
-	int index = -1;
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
-			index = i;
+/**
+ * Producer side lock of the command queue.
+ *
+ * Normally only _queueMutex is held, so that queueing commands never waits
+ * for the mixer callback. When the pending commands have to be executed
+ * right away, or a channel has to be stolen, the lock is made exclusive by
+ * also taking _mutex. To keep the lock order, _queueMutex is released
+ * before _mutex is taken.
+ */
+class MixerImpl::QueueLock {
+public:
+	explicit QueueLock(MixerImpl *mixer) : _mixer(mixer), _exclusive(false) {
+		_mixer->_queueMutex.lock();
+
+		// The mixer callback is not keeping up (or not running at all),
+		// so execute the pending commands ourselves.
+		if (_mixer->_commandsTail.load() - _mixer->_commandsHead.load() == COMMAND_QUEUE_SIZE)
+			makeExclusive();
+	}
+
+	~QueueLock() {
+		_mixer->_queueMutex.unlock();
+		if (_exclusive)
+			_mixer->_mutex.unlock();
+	}
+
+	void makeExclusive() {
+		if (_exclusive)
+			return;
+
+		_mixer->_queueMutex.unlock();
+		_mixer->_mutex.lock();
+		_mixer->_queueMutex.lock();
+		_mixer->processCommands();
+		_exclusive = true;
+	}
+
+private:
+	MixerImpl *_mixer;
+	bool _exclusive;
+};
+
+void MixerImpl::queueCommand(CommandType type, uint32 handle, Channel *channel, int param) {
+	const uint32 tail = _commandsTail.load();
+	assert(tail - _commandsHead.load() < COMMAND_QUEUE_SIZE);
+
+	Command &cmd = _commands[tail % COMMAND_QUEUE_SIZE];
+	cmd.type = type;
+	cmd.handle = handle;
+	cmd.channel = channel;
+	cmd.param = param;
+
+	_commandsTail.store(tail + 1);
+}
+
+void MixerImpl::processCommands() {
+	const uint32 tail = _commandsTail.load();
+	uint32 head = _commandsHead.load();
+
+	for (; head != tail; head++) {
+		const Command &cmd = _commands[head % COMMAND_QUEUE_SIZE];
+		const int index = cmd.handle % _numChannels;
+		Channel *chan = _channels[index];
+
+		switch (cmd.type) {
+		case kCommandInsert:
+			assert(!chan);
+			_channels[index] = cmd.channel;
+			break;
+
+		case kCommandSetVolume:
+			if (chan && chan->getHandle()._val == cmd.handle)
+				chan->setVolume(cmd.param);
+			break;
+
+		case kCommandSetBalance:
+			if (chan && chan->getHandle()._val == cmd.handle)
+				chan->setBalance(cmd.param);
 			break;
 		}
 	}
+
+	_commandsHead.store(head);
+}
+
+void MixerImpl::destroyChannel(int index) {
+	delete _channels[index];
+	_channels[index] = 0;
+	_channelStates[index].handle.store(kFreeSlot);
+}
+
+void MixerImpl::notifySoundTypeChange(SoundType type) {
+	for (uint i = 0; i != _numChannels; i++) {
+		if (_channels[i] && _channels[i]->getType() == type)
+			_channels[i]->notifyGlobalVolChange();
+	}
+}
+
+int MixerImpl::findChannel(SoundHandle handle) const {
+	const int index = handle._val % _numChannels;
+	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+		return -1;
+	return index;
+}
+
+/**
+ * Relative importance of the sound types when a channel has to be freed.
+ */
+static int getSoundTypePriority(Mixer::SoundType type) {
+	switch (type) {
+	case Mixer::kSpeechSoundType:
+		return 3;
+	case Mixer::kSFXSoundType:
+		return 2;
+	case Mixer::kMusicSoundType:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+int MixerImpl::stealChannel(SoundType type) {
+	// Pick the oldest sound of the lowest priority. Handles grow with each
+	// new sound, so the smallest handle belongs to the oldest one.
+	int victim = -1;
+	int victimPriority = getSoundTypePriority(type);
+	for (uint i = 0; i != _numChannels; i++) {
+		if (!_channels[i] || _channels[i]->isPermanent())
+			continue;
+
+		const int priority = getSoundTypePriority(_channels[i]->getType());
+		if (priority < victimPriority ||
+		    (priority == victimPriority && (victim == -1 || _channels[i]->getHandle()._val < _channels[victim]->getHandle()._val))) {
+			victim = i;
+			victimPriority = priority;
+		}
+	}
+
+	if (victim != -1) {
+		debug(5, "MixerImpl: stopping sound %d of type %d to play a sound of type %d",
+		      _channels[victim]->getId(), _channels[victim]->getType(), type);
+		destroyChannel(victim);
+	}
+	return victim;
+}
+
+int MixerImpl::findFreeSlot() const {
+	for (uint i = 0; i != _numChannels; i++) {
+		if (_channelStates[i].handle.load() == kFreeSlot)
+			return i;
+	}
+	return -1;
+}
+
+void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
+	int index = findFreeSlot();
+	if (index == -1)
+		index = stealChannel(chan->getType());
 	if (index == -1) {
 		warning("MixerImpl::out of mixer slots");
 		delete chan;
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
-	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	chanHandle._val = index + (_handleSeed * _numChannels);
+	_handleSeed++;
+
+	// The handle wrapped around into the value marking free slots
+	if (chanHandle._val == kFreeSlot) {
+		chanHandle._val = index + (_handleSeed * _numChannels);
+		_handleSeed++;
+	}
 
 	chan->setHandle(chanHandle);
-	_handleSeed++;
+
+	ChannelState &state = _channelStates[index];
+	state.id.store(chan->getId());
+	state.type.store(chan->getType());
+	state.volume.store(chan->getVolume());
+	state.balance.store(chan->getBalance());
+	state.handle.store(chanHandle._val);
+
+	queueCommand(kCommandInsert, chanHandle._val, chan);
+
 	if (handle)
 		*handle = chanHandle;
 }
@@ -229,30 +418,31 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
-	Common::StackLock lock(_mutex);
-
 	if (stream == 0) {
 		warning("stream is 0");
 		return;
 	}
 
+	QueueLock lock(this);
 
-	assert(_mixerReady);
+	// Slots are only released with _mutex held, so a free slot found now
+	// stays free until insertChannel() takes it.
+	if (findFreeSlot() == -1)
+		lock.makeExclusive();
+
+	assert(_mixerReady.load());
 
 	// Prevent duplicate sounds
-	if (id != -1) {
-		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
-				// Delete the stream if were asked to auto-dispose it.
-				// Note: This could cause trouble if the client code does not
-				// yet expect the stream to be gone. The primary example to
-				// keep in mind here is QueuingAudioStream.
-				// Thus, as a quick rule of thumb, you should never, ever,
-				// try to play QueuingAudioStreams with a sound id.
-				if (autofreeStream == DisposeAfterUse::YES)
-					delete stream;
-				return;
-			}
+	if (id != -1 && isSoundIDActive(id)) {
+		// Delete the stream if were asked to auto-dispose it.
+		// Note: This could cause trouble if the client code does not
+		// yet expect the stream to be gone. The primary example to
+		// keep in mind here is QueuingAudioStream.
+		// Thus, as a quick rule of thumb, you should never, ever,
+		// try to play QueuingAudioStreams with a sound id.
+		if (autofreeStream == DisposeAfterUse::YES)
+			delete stream;
+		return;
 	}
 
 #ifdef AUDIO_REVERSE_STEREO
@@ -277,20 +467,22 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	len >>= 2;
 
 	// Since the mixer callback has been called, the mixer must be ready...
-	_mixerReady = true;
+	_mixerReady.store(1);
+
+	processCommands();
 
 	//  zero the buf
 	memset(buf, 0, 2 * len * sizeof(int16));
 
 	// mix all channels
 	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (uint i = 0; i != _numChannels; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
+				destroyChannel(i);
 			} else if (!_channels[i]->isPaused()) {
 				tmp = _channels[i]->mix(buf, len);
+				_samplesMixed[_channels[i]->getType()] += tmp;
 
 				if (tmp > res)
 					res = tmp;
@@ -302,44 +494,47 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+	processCommands();
+
+	for (uint i = 0; i != _numChannels; i++) {
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			destroyChannel(i);
 	}
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+	processCommands();
+
+	for (uint i = 0; i != _numChannels; i++) {
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			destroyChannel(i);
 	}
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!isSoundHandleActive(handle))
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	Common::StackLock lock(_mutex);
+	processCommands();
+
+	const int index = findChannel(handle);
+	if (index != -1)
+		destroyChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	// The mixer callback reads the sound type settings, so they are only
+	// ever changed with _mutex held.
+	Common::StackLock lock(_mutex);
+	processCommands();
+
+	_soundTypeSettings[type].mute = mute;
+	notifySoundTypeChange(type);
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
@@ -348,39 +543,43 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
+	QueueLock lock(this);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = handle._val % _numChannels;
+	if (_channelStates[index].handle.load() != handle._val)
 		return;
 
-	_channels[index]->setVolume(volume);
+	_channelStates[index].volume.store(volume);
+	queueCommand(kCommandSetVolume, handle._val, 0, volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const ChannelState &state = _channelStates[handle._val % _numChannels];
+	const byte volume = state.volume.load();
+	if (state.handle.load() != handle._val)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return volume;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
+	QueueLock lock(this);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = handle._val % _numChannels;
+	if (_channelStates[index].handle.load() != handle._val)
 		return;
 
-	_channels[index]->setBalance(balance);
+	_channelStates[index].balance.store(balance);
+	queueCommand(kCommandSetBalance, handle._val, 0, balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const ChannelState &state = _channelStates[handle._val % _numChannels];
+	const int8 balance = state.balance.load();
+	if (state.handle.load() != handle._val)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return balance;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -389,26 +588,34 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processCommands();
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	const int index = findChannel(handle);
+	if (index == -1)
 		return Timestamp(0, _sampleRate);
 
 	return _channels[index]->getElapsedTime();
 }
 
+// Pausing is not queued: callers rely on the sound being silent as soon as
+// the call returns, e.g. before they modify the stream that is being played.
+// Executing the queued commands first keeps their order relative to the pause.
+
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0) {
+	processCommands();
+
+	for (uint i = 0; i != _numChannels; i++) {
+		if (_channels[i] != 0)
 			_channels[i]->pause(paused);
-		}
 	}
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
+	processCommands();
+
+	for (uint i = 0; i != _numChannels; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
 			return;
@@ -417,52 +624,48 @@ void MixerImpl::pauseID(int id, bool paused) {
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
-	Common::StackLock lock(_mutex);
-
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (!isSoundHandleActive(handle))
 		return;
 
-	_channels[index]->pause(paused);
+	Common::StackLock lock(_mutex);
+	processCommands();
+
+	const int index = findChannel(handle);
+	if (index != -1)
+		_channels[index]->pause(paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+	for (uint i = 0; i != _numChannels; i++)
+		if (_channelStates[i].handle.load() != kFreeSlot && _channelStates[i].id.load() == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
+	const ChannelState &state = _channelStates[handle._val % _numChannels];
+	const int id = state.id.load();
+	if (state.handle.load() == handle._val)
+		return id;
 	return 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
-
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return _channelStates[handle._val % _numChannels].handle.load() == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+	for (uint i = 0; i != _numChannels; i++)
+		if (_channelStates[i].handle.load() != kFreeSlot && _channelStates[i].type.load() == type)
 			return true;
 	return false;
 }
@@ -477,12 +680,10 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// scaling? See also Player_V2::setMasterVolume
 
 	Common::StackLock lock(_mutex);
-	_soundTypeSettings[type].volume = volume;
+	processCommands();
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	_soundTypeSettings[type].volume = volume;
+	notifySoundTypeChange(type);
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
@@ -491,6 +692,33 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 	return _soundTypeSettings[type].volume;
 }
 
+bool MixerImpl::getChannelStats(uint channel, ChannelStats &stats) {
+	assert(channel < _numChannels);
+
+	Common::StackLock lock(_mutex);
+	processCommands();
+
+	const Channel *chan = _channels[channel];
+	if (!chan)
+		return false;
+
+	stats.id = chan->getId();
+	stats.type = chan->getType();
+	stats.permanent = chan->isPermanent();
+	stats.paused = chan->isPaused();
+	stats.volume = _channelStates[channel].volume.load();
+	stats.balance = _channelStates[channel].balance.load();
+	stats.samplesMixed = chan->getSamplesMixed();
+	return true;
+}
+
+uint32 MixerImpl::getSamplesMixedForSoundType(SoundType type) {
+	assert(0 <= (int)type && (int)type < ARRAYSIZE(_samplesMixed));
+
+	Common::StackLock lock(_mutex);
+	return _samplesMixed[type];
+}
+
 
 #pragma mark -
 #pragma mark --- Channel implementations ---
@@ -295,6 +295,40 @@ public:
 	 * @return The output sample rate in Hz.
 	 */
 	virtual uint getOutputRate() const = 0;
+
+	/**
+	 * Statistics about a playing sound, for debugging purposes.
+	 */
+	struct ChannelStats {
+		int id;                /*!< ID of the sound, or -1. */
+		SoundType type;        /*!< Type of the sound. */
+		bool permanent;        /*!< Whether stopAll() leaves the sound alone. */
+		bool paused;           /*!< Whether the sound is paused. */
+		byte volume;           /*!< Channel volume. */
+		int8 balance;          /*!< Channel balance. */
+		uint32 samplesMixed;   /*!< Number of sample pairs mixed so far. */
+	};
+
+	/**
+	 * Return the maximum number of sounds that can play at the same time.
+	 */
+	virtual uint getChannelCount() const = 0;
+
+	/**
+	 * Retrieve statistics about the sound playing in the given channel.
+	 *
+	 * @param channel  Channel index, in the range 0 - getChannelCount() - 1.
+	 * @param stats    Receives the statistics.
+	 *
+	 * @return False if no sound is playing in that channel.
+	 */
+	virtual bool getChannelStats(uint channel, ChannelStats &stats) = 0;
+
+	/**
+	 * Return the number of sample pairs mixed for sounds of the given type
+	 * since the mixer was created, including sounds which already ended.
+	 */
+	virtual uint32 getSamplesMixedForSoundType(SoundType type) = 0;
 };
 
 /** @} */
@@ -24,6 +24,7 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
 
@@ -54,20 +55,82 @@ namespace Audio {
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
  *
+ * Requests which only change the state of a channel (starting a sound,
+ * volume, balance and pausing) do not wait for the mixer callback: they
+ * are queued in a lock-free command queue which the callback drains before
+ * mixing. Queries are answered from channel state published alongside it.
+ * Stopping sounds and querying the elapsed time still synchronize with the
+ * callback, as callers commonly free the sound data right after stopping.
+ *
+ * When all channels are in use, a new sound replaces the oldest sound of
+ * the lowest priority type (plain < music < SFX < speech), provided that
+ * priority is not higher than its own. Permanent sounds are never replaced.
+ *
  * @see OSystem::getMixer()
  */
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		DEFAULT_NUM_CHANNELS = 32,
+		MAX_NUM_CHANNELS = 256,
+		COMMAND_QUEUE_SIZE = 256
 	};
 
+	/**
+	 * Held by the mixer callback and whoever changes the channel list.
+	 * Streams may call back into the mixer while it is held, so when both
+	 * locks are needed, _mutex is always taken before _queueMutex.
+	 */
 	Common::Mutex _mutex;
+	/** Serializes the threads queueing commands, never held while mixing. */
+	Common::Mutex _queueMutex;
+
+	class QueueLock;
 
 	const uint _sampleRate;
-	bool _mixerReady;
+	const uint _numChannels;
+	Common::Atomic<int32> _mixerReady;
 	uint32 _handleSeed;
 
+	enum CommandType {
+		kCommandInsert,
+		kCommandSetVolume,
+		kCommandSetBalance
+	};
+
+	struct Command {
+		CommandType type;
+		uint32 handle;
+		Channel *channel;
+		int param;
+	};
+
+	/**
+	 * Single-producer/single-consumer ring buffer of pending commands.
+	 * The producer side is serialized by _queueMutex, the consumer side
+	 * by _mutex.
+	 */
+	Command _commands[COMMAND_QUEUE_SIZE];
+	Common::Atomic<uint32> _commandsHead;
+	Common::Atomic<uint32> _commandsTail;
+
+	/**
+	 * Channel state which can be queried without synchronizing with the
+	 * mixer callback. A slot is reserved by the thread starting a sound and
+	 * only released again once its channel has been destroyed.
+	 */
+	static const uint32 kFreeSlot = 0xFFFFFFFF;
+
+	struct ChannelState {
+		ChannelState() : handle(kFreeSlot), id(-1), type(0), volume(0), balance(0) {}
+
+		Common::Atomic<uint32> handle;
+		Common::Atomic<int32> id;
+		Common::Atomic<int32> type;
+		Common::Atomic<int32> volume;
+		Common::Atomic<int32> balance;
+	};
+
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
 
@@ -76,15 +139,25 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
-	Channel *_channels[NUM_CHANNELS];
+	Channel **_channels;
+	ChannelState *_channelStates;
+
+	/** Sample pairs mixed per sound type, only accessed with _mutex held. */
+	uint32 _samplesMixed[4];
 
 
 public:
 
-	MixerImpl(uint sampleRate);
+	/**
+	 * @param sampleRate   Output sample rate in Hz.
+	 * @param numChannels  Maximum number of sounds playing at the same
+	 *                     time. If 0, the "mixer_channels" config setting
+	 *                     is used, or 32 if it is not set.
+	 */
+	MixerImpl(uint sampleRate, uint numChannels = 0);
 	~MixerImpl();
 
-	virtual bool isReady() const { Common::StackLock lock(_mutex); return _mixerReady; }
+	virtual bool isReady() const { return _mixerReady.load() != 0; }
 
 	virtual void playStream(
 		SoundType type,
@@ -126,9 +199,60 @@ public:
 
 	virtual uint getOutputRate() const;
 
+	virtual uint getChannelCount() const { return _numChannels; }
+	virtual bool getChannelStats(uint channel, ChannelStats &stats);
+	virtual uint32 getSamplesMixedForSoundType(SoundType type);
+
 protected:
+	static uint getConfiguredChannelCount(uint numChannels);
+
+	/**
+	 * Reserve a slot for the channel and queue it for the mixer callback.
+	 * Must be called with a QueueLock held, which has to be exclusive when
+	 * no slot is free.
+	 */
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/** Return a free channel slot, or -1 if all slots are in use. */
+	int findFreeSlot() const;
+
+	/**
+	 * Queue a command for the mixer callback. Must be called with a
+	 * QueueLock held.
+	 */
+	void queueCommand(CommandType type, uint32 handle, Channel *channel = 0, int param = 0);
+
+	/**
+	 * Execute all queued commands. Must be called with _mutex held.
+	 */
+	void processCommands();
+
+	/**
+	 * Destroy the channel in the given slot and release the slot. Must be
+	 * called with _mutex held.
+	 */
+	void destroyChannel(int index);
+
+	/**
+	 * Return the slot of the channel with the given handle, or -1 if the
+	 * sound has already terminated. Must be called with _mutex held.
+	 */
+	int findChannel(SoundHandle handle) const;
+
+	/**
+	 * Let all channels of the given type pick up a changed type volume or
+	 * mute setting. Must be called with _mutex held.
+	 */
+	void notifySoundTypeChange(SoundType type);
+
+	/**
+	 * Stop a sound to make room for a new sound of the given type. Must be
+	 * called with _mutex held.
+	 *
+	 * @return The freed slot, or -1 if all sounds are more important.
+	 */
+	int stealChannel(SoundType type);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
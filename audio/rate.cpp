@@ -31,10 +31,21 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/endian.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+#if defined(__SSE2__)
+#define USE_SSE2_RATE_MIXER
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define USE_NEON_RATE_MIXER
+#include <arm_neon.h>
+#endif
+#endif
+
 namespace Audio {
 
 
@@ -57,6 +68,157 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+#pragma mark -
+
+
+/**
+ * Scale a block of input samples by the channel volumes and add them to the
+ * interleaved stereo output buffer, clamping the result. Mono input samples
+ * are duplicated into both output channels.
+ */
+template<bool stereo, bool reverseStereo>
+static inline void mixBlockScalar(st_sample_t *obuf, const st_sample_t *in, st_size_t pairs, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; pairs > 0; --pairs) {
+		st_sample_t out0, out1;
+		out0 = *in++;
+		out1 = (stereo ? *in++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+#ifdef USE_SSE2_RATE_MIXER
+
+/**
+ * Multiply eight samples by their volume and divide by kMaxMixerVolume,
+ * rounding towards zero exactly like the scalar code does.
+ */
+static inline __m128i scaleSamplesSSE2(__m128i samples, __m128i volume) {
+	const __m128i lo = _mm_mullo_epi16(samples, volume);
+	const __m128i hi = _mm_mulhi_epi16(samples, volume);
+	const __m128i bias = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 8);
+
+	return _mm_packs_epi32(p0, p1);
+}
+
+/**
+ * SSE2 version of mixBlockScalar, processing four sample pairs at a time.
+ * The pair count must be a multiple of four.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixBlockVector(st_sample_t *obuf, const st_sample_t *in, st_size_t pairs, st_volume_t vol_l, st_volume_t vol_r) {
+	// Samples are swapped into output order first, so the volumes follow them
+	const int16 vol0 = reverseStereo ? vol_r : vol_l;
+	const int16 vol1 = reverseStereo ? vol_l : vol_r;
+	const __m128i volume = _mm_set_epi16(vol1, vol0, vol1, vol0, vol1, vol0, vol1, vol0);
+
+	for (; pairs > 0; pairs -= 4) {
+		__m128i samples;
+		if (stereo) {
+			samples = _mm_loadu_si128((const __m128i *)in);
+			if (reverseStereo) {
+				samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+				samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(2, 3, 0, 1));
+			}
+			in += 8;
+		} else {
+			samples = _mm_loadl_epi64((const __m128i *)in);
+			samples = _mm_unpacklo_epi16(samples, samples);
+			in += 4;
+		}
+
+		const __m128i out = _mm_loadu_si128((const __m128i *)obuf);
+		_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(out, scaleSamplesSSE2(samples, volume)));
+		obuf += 8;
+	}
+}
+
+#endif // USE_SSE2_RATE_MIXER
+
+#ifdef USE_NEON_RATE_MIXER
+
+/**
+ * Multiply eight samples by their volume and divide by kMaxMixerVolume,
+ * rounding towards zero exactly like the scalar code does.
+ */
+static inline int16x8_t scaleSamplesNEON(int16x8_t samples, int16x8_t volume) {
+	const int32x4_t bias = vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	int32x4_t p0 = vmull_s16(vget_low_s16(samples), vget_low_s16(volume));
+	int32x4_t p1 = vmull_s16(vget_high_s16(samples), vget_high_s16(volume));
+	p0 = vshrq_n_s32(vaddq_s32(p0, vandq_s32(vshrq_n_s32(p0, 31), bias)), 8);
+	p1 = vshrq_n_s32(vaddq_s32(p1, vandq_s32(vshrq_n_s32(p1, 31), bias)), 8);
+
+	return vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1));
+}
+
+/**
+ * NEON version of mixBlockScalar, processing four sample pairs at a time.
+ * The pair count must be a multiple of four.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixBlockVector(st_sample_t *obuf, const st_sample_t *in, st_size_t pairs, st_volume_t vol_l, st_volume_t vol_r) {
+	// Samples are swapped into output order first, so the volumes follow them
+	const int16 vol0 = reverseStereo ? vol_r : vol_l;
+	const int16 vol1 = reverseStereo ? vol_l : vol_r;
+	const int16 volumes[8] = { vol0, vol1, vol0, vol1, vol0, vol1, vol0, vol1 };
+	const int16x8_t volume = vld1q_s16(volumes);
+
+	for (; pairs > 0; pairs -= 4) {
+		int16x8_t samples;
+		if (stereo) {
+			samples = vld1q_s16(in);
+			if (reverseStereo)
+				samples = vrev32q_s16(samples);
+			in += 8;
+		} else {
+			const int16x4_t mono = vld1_s16(in);
+			const int16x4x2_t zipped = vzip_s16(mono, mono);
+			samples = vcombine_s16(zipped.val[0], zipped.val[1]);
+			in += 4;
+		}
+
+		vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), scaleSamplesNEON(samples, volume)));
+		obuf += 8;
+	}
+}
+
+#endif // USE_NEON_RATE_MIXER
+
+/**
+ * Mix a block of resampled input into the output buffer, using the vector
+ * code where available and the scalar code for the remainder.
+ */
+template<bool stereo, bool reverseStereo>
+static inline void mixBlock(st_sample_t *obuf, const st_sample_t *in, st_size_t pairs, st_volume_t vol_l, st_volume_t vol_r) {
+#if defined(USE_SSE2_RATE_MIXER) || defined(USE_NEON_RATE_MIXER)
+	// The vector code relies on 16-bit multiplies, which only hold for
+	// volumes in the range the mixer produces.
+	if (vol_l <= Audio::Mixer::kMaxMixerVolume && vol_r <= Audio::Mixer::kMaxMixerVolume) {
+		const st_size_t vectorPairs = pairs & ~3;
+		mixBlockVector<stereo, reverseStereo>(obuf, in, vectorPairs, vol_l, vol_r);
+		obuf += vectorPairs * 2;
+		in += vectorPairs * (stereo ? 2 : 1);
+		pairs -= vectorPairs;
+	}
+#endif
+	mixBlockScalar<stereo, reverseStereo>(obuf, in, pairs, vol_l, vol_r);
+}
+
+
+#pragma mark -
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -70,6 +232,9 @@ protected:
 	const st_sample_t *inPtr;
 	int inLen;
 
+	/** resampled output, waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
 	/** position of how far output is ahead of input */
 	/** Holds what would have been opos-ipos */
 	long opos;
@@ -119,48 +284,184 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
+		const st_size_t blockPairs = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / (stereo ? 2 : 1));
+		st_sample_t *outPtr = outBuf;
+
+		for (st_size_t pairs = 0; pairs < blockPairs; ++pairs) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						mixBlock<stereo, reverseStereo>(obuf, outBuf, pairs, vol_l, vol_r);
+						return (obuf - ostart) / 2 + pairs;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			*outPtr++ = *inPtr++;
+			if (stereo)
+				*outPtr++ = *inPtr++;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
+			// Increment output position
+			opos += opos_inc;
+		}
 
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
+		mixBlock<stereo, reverseStereo>(obuf, outBuf, blockPairs, vol_l, vol_r);
+		obuf += blockPairs * 2;
+	}
+	return (obuf - ostart) / 2;
+}
 
-		// Increment output position
-		opos += opos_inc;
+/**
+ * Linearly interpolate a block of output frames from the input frames in
+ * @p in. Output frame k lies at the fractional input frame position
+ * pos + k * inc, and is interpolated between the input frame at the integer
+ * part of that position and the next one.
+ */
+template<bool stereo>
+static inline void interpolateBlockScalar(st_sample_t *out, const st_sample_t *in, frac_t pos, frac_t inc, st_size_t pairs) {
+	for (; pairs > 0; --pairs) {
+		const st_sample_t *frame = in + (pos >> FRAC_BITS_LOW) * (stereo ? 2 : 1);
+		const int frac = pos & (FRAC_ONE_LOW - 1);
 
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+		*out++ = (st_sample_t)(frame[0] + (((frame[stereo ? 2 : 1] - frame[0]) * frac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+		if (stereo)
+			*out++ = (st_sample_t)(frame[1] + (((frame[3] - frame[1]) * frac + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		pos += inc;
+	}
+}
 
-		obuf += 2;
+#ifdef USE_SSE2_RATE_MIXER
+
+/**
+ * SSE2 version of interpolateBlockScalar, processing four frames at a time.
+ * The frame count must be a multiple of four.
+ */
+template<bool stereo>
+static void interpolateBlockVector(st_sample_t *out, const st_sample_t *in, frac_t pos, frac_t inc, st_size_t pairs) {
+	const __m128i fracMask = _mm_set1_epi32(FRAC_ONE_LOW - 1);
+	const __m128i lowMask = _mm_set1_epi32(0xFFFF);
+	const __m128i half = _mm_set1_epi32(FRAC_HALF_LOW);
+	const __m128i posStep = _mm_set1_epi32(inc * 4);
+	__m128i posVector = _mm_set_epi32(pos + inc * 3, pos + inc * 2, pos + inc, pos);
+
+	for (; pairs > 0; pairs -= 4) {
+		// Each 32-bit lane holds the weight of the last input sample, -frac,
+		// in its lower half and that of the current one, frac, in its upper
+		// half, matching the samples they are multiplied with below
+		const __m128i frac = _mm_and_si128(posVector, fracMask);
+		const __m128i weights = _mm_or_si128(_mm_slli_epi32(frac, 16), _mm_and_si128(_mm_sub_epi32(_mm_setzero_si128(), frac), lowMask));
+		posVector = _mm_add_epi32(posVector, posStep);
+
+		const st_sample_t *frame[4];
+		for (int i = 0; i < 4; i++) {
+			frame[i] = in + (pos >> FRAC_BITS_LOW) * (stereo ? 2 : 1);
+			pos += inc;
+		}
+
+		if (stereo) {
+			// Reorder the left last, right last, left current, right current
+			// samples of each frame to pair them up by channel
+			__m128i s0 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)frame[0]), _mm_loadl_epi64((const __m128i *)frame[1]));
+			__m128i s1 = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)frame[2]), _mm_loadl_epi64((const __m128i *)frame[3]));
+			s0 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s0, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+			s1 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s1, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+
+			__m128i r0 = _mm_madd_epi16(s0, _mm_unpacklo_epi32(weights, weights));
+			__m128i r1 = _mm_madd_epi16(s1, _mm_unpackhi_epi32(weights, weights));
+			r0 = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(r0, half), FRAC_BITS_LOW), _mm_srai_epi32(_mm_slli_epi32(s0, 16), 16));
+			r1 = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(r1, half), FRAC_BITS_LOW), _mm_srai_epi32(_mm_slli_epi32(s1, 16), 16));
+
+			_mm_storeu_si128((__m128i *)out, _mm_packs_epi32(r0, r1));
+			out += 8;
+		} else {
+			const __m128i s = _mm_set_epi32(READ_UINT32(frame[3]), READ_UINT32(frame[2]), READ_UINT32(frame[1]), READ_UINT32(frame[0]));
+
+			__m128i r = _mm_madd_epi16(s, weights);
+			r = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(r, half), FRAC_BITS_LOW), _mm_srai_epi32(_mm_slli_epi32(s, 16), 16));
+
+			_mm_storel_epi64((__m128i *)out, _mm_packs_epi32(r, r));
+			out += 4;
+		}
 	}
-	return (obuf - ostart) / 2;
+}
+
+#endif // USE_SSE2_RATE_MIXER
+
+#ifdef USE_NEON_RATE_MIXER
+
+/**
+ * NEON version of interpolateBlockScalar, processing four frames at a time.
+ * The frame count must be a multiple of four.
+ */
+template<bool stereo>
+static void interpolateBlockVector(st_sample_t *out, const st_sample_t *in, frac_t pos, frac_t inc, st_size_t pairs) {
+	const int channels = stereo ? 2 : 1;
+
+	for (; pairs > 0; pairs -= 4) {
+		int16 last[8], cur[8], frac[8];
+		for (int i = 0; i < 4 * channels; i += channels) {
+			const st_sample_t *frame = in + (pos >> FRAC_BITS_LOW) * channels;
+			for (int c = 0; c < channels; c++) {
+				last[i + c] = frame[c];
+				cur[i + c] = frame[channels + c];
+				frac[i + c] = (int16)(pos & (FRAC_ONE_LOW - 1));
+			}
+			pos += inc;
+		}
+
+		for (int i = 0; i < 4 * channels; i += 4) {
+			const int16x4_t l = vld1_s16(last + i);
+			const int16x4_t f = vld1_s16(frac + i);
+
+			// The rounding shift adds FRAC_HALF_LOW before shifting
+			int32x4_t r = vmlsl_s16(vmull_s16(vld1_s16(cur + i), f), l, f);
+			r = vaddw_s16(vrshrq_n_s32(r, FRAC_BITS_LOW), l);
+
+			vst1_s16(out + i, vmovn_s32(r));
+		}
+		out += 4 * channels;
+	}
+}
+
+#endif // USE_NEON_RATE_MIXER
+
+/**
+ * Interpolate a block of output frames, using the vector code where
+ * available and the scalar code for the remainder.
+ */
+template<bool stereo>
+static inline void interpolateBlock(st_sample_t *out, const st_sample_t *in, frac_t pos, frac_t inc, st_size_t pairs) {
+#if defined(USE_SSE2_RATE_MIXER) || defined(USE_NEON_RATE_MIXER)
+	const st_size_t vectorPairs = pairs & ~3;
+	interpolateBlockVector<stereo>(out, in, pos, inc, vectorPairs);
+	out += vectorPairs * (stereo ? 2 : 1);
+	pos += vectorPairs * inc;
+	pairs -= vectorPairs;
+#endif
+	interpolateBlockScalar<stereo>(out, in, pos, inc, pairs);
 }
 
 /**
  * Audio rate converter based on simple linear Interpolation.
  *
- * The use of fractional increment allows us to use no buffer. It
- * avoid the problems at the end of the buffer we had with the old
- * method which stored a possibly big buffer of size
- * lcm(in_rate,out_rate).
+ * The use of fractional increment avoids the problems at the end of
+ * the buffer we had with the old method which stored a possibly big
+ * buffer of size lcm(in_rate,out_rate).
+ *
+ * The input is read into a buffer which keeps the last frame of the
+ * previous read in front, so that the input frames of each output frame
+ * follow from its position alone and whole blocks can be interpolated at
+ * once.
  *
  * Limited to sampling frequency <= 65535 Hz.
  */
@@ -168,21 +469,19 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 template<bool stereo, bool reverseStereo>
 class LinearRateConverter : public RateConverter {
 protected:
-	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
-	const st_sample_t *inPtr;
-	int inLen;
+	/** input frames, starting with the last frame of the previous read */
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE + 2];
+	int inFrames;
 
-	/** fractional position of the output stream in input stream unit */
+	/** interpolated output, waiting to be mixed into the output buffer */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** fractional position of the output stream in inBuf, in input frames */
 	frac_t opos;
 
 	/** fractional position increment in the output stream */
 	frac_t opos_inc;
 
-	/** last sample(s) in the input stream (left/right channel) */
-	st_sample_t ilast0, ilast1;
-	/** current sample(s) in the input stream (left/right channel) */
-	st_sample_t icur0, icur1;
-
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -201,7 +500,8 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 		error("rate effect can only handle rates < 131072");
 	}
 
-	opos = FRAC_ONE_LOW;
+	// The first output frame is interpolated from silence
+	opos = 0;
 
 	// Compute the linear interpolation increment.
 	// This will overflow if inrate >= 2^17, and underflow if outrate >= 2^17.
@@ -210,10 +510,8 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 	// versa, I think we can live with that limitation ;-).
 	opos_inc = (inrate << FRAC_BITS_LOW) / outrate;
 
-	ilast0 = ilast1 = 0;
-	icur0 = icur1 = 0;
-
-	inLen = 0;
+	inBuf[0] = inBuf[1] = 0;
+	inFrames = 1;
 }
 
 /*
@@ -222,53 +520,44 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  */
 template<bool stereo, bool reverseStereo>
 int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	const int channels = stereo ? 2 : 1;
 	st_sample_t *ostart, *oend;
 
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+		const st_size_t blockPairs = MIN<st_size_t>((oend - obuf) / 2, ARRAYSIZE(outBuf) / channels);
+		st_size_t pairs = 0;
+
+		while (pairs < blockPairs) {
+			// read enough input frames to interpolate the next output frame
+			while ((opos >> FRAC_BITS_LOW) + 1 >= inFrames) {
+				// Keep the last frame, the next output frame may need it
+				for (int c = 0; c < channels; c++)
+					inBuf[c] = inBuf[(inFrames - 1) * channels + c];
+				opos -= (frac_t)(inFrames - 1) << FRAC_BITS_LOW;
+
+				const int inLen = input.readBuffer(inBuf + channels, INTERMEDIATE_BUFFER_SIZE);
+				if (inLen <= 0) {
+					inFrames = 1;
+					mixBlock<stereo, reverseStereo>(obuf, outBuf, pairs, vol_l, vol_r);
+					return (obuf - ostart) / 2 + pairs;
+				}
+				inFrames = 1 + inLen / channels;
 			}
-			opos -= FRAC_ONE_LOW;
-		}
-
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-
-			// Increment output position
-			opos += opos_inc;
+			// Interpolate as many output frames as the buffered input and
+			// the space in the block allow
+			const frac_t inEnd = (frac_t)(inFrames - 1) << FRAC_BITS_LOW;
+			const st_size_t count = MIN<st_size_t>(blockPairs - pairs, (inEnd - opos + opos_inc - 1) / opos_inc);
+			interpolateBlock<stereo>(outBuf + pairs * channels, inBuf, opos, opos_inc, count);
+			opos += count * opos_inc;
+			pairs += count;
 		}
+
+		mixBlock<stereo, reverseStereo>(obuf, outBuf, blockPairs, vol_l, vol_r);
+		obuf += blockPairs * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -293,11 +582,6 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
-		st_size_t len;
-
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -312,24 +596,14 @@ public:
 			error("[CopyRateConverter::flow] Cannot allocate memory for temp buffer");
 
 		// Read up to 'osamp' samples into our temporary buffer
-		len = input.readBuffer(_buffer, osamp);
+		int len = input.readBuffer(_buffer, osamp);
+		if (len <= 0)
+			return 0;
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+		const st_size_t pairs = len / (stereo ? 2 : 1);
+		mixBlock<stereo, reverseStereo>(obuf, _buffer, pairs, vol_l, vol_r);
+		return pairs;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -173,6 +173,19 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size and the last modification time of the file referred
+	 * by this path, without opening it.
+	 *
+	 * Backends which cannot do this cheaply do not need to implement it.
+	 *
+	 * @param size the size of the file in bytes
+	 * @param modificationTime the last modification time in seconds; only
+	 *        meaningful for comparing with a previous value
+	 * @return bool true if both values were retrieved, false otherwise.
+	 */
+	virtual bool getFileStats(uint32 &size, uint32 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
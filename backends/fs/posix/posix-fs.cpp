@@ -34,6 +34,7 @@
 
 #include "backends/fs/posix/posix-fs.h"
 #include "backends/fs/posix/posix-iostream.h"
+#include "backends/fs/posix/posix-mmapstream.h"
 #include "common/algorithm.h"
 
 #include <sys/param.h>
@@ -71,6 +72,16 @@ bool POSIXFilesystemNode::isWritable() const {
 	return access(_path.c_str(), W_OK) == 0;
 }
 
+bool POSIXFilesystemNode::getFileStats(uint32 &size, uint32 &modificationTime) const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+		return false;
+
+	size = (uint32)st.st_size;
+	modificationTime = (uint32)st.st_mtime;
+	return true;
+}
+
 void POSIXFilesystemNode::setFlags() {
 	struct stat st;
 
@@ -286,7 +297,21 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const {
 	return makeNode(Common::String(start, end));
 }
 
+bool POSIXFilesystemNode::_memoryMapping = false;
+
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
+#ifdef HAS_POSIX_MMAP
+	// Large files, such as game archives, may be mapped into memory instead.
+	// This is opt-in, since accessing a mapped file which was truncated in
+	// the meantime crashes with SIGBUS, and mapping whole archives uses up
+	// the address space on 32-bit systems.
+	if (_memoryMapping) {
+		Common::SeekableReadStream *stream = PosixMmapStream::makeFromPath(getPath());
+		if (stream)
+			return stream;
+	}
+#endif
+
 	return PosixIoStream::makeFromPath(getPath(), false);
 }
 
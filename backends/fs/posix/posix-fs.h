@@ -61,6 +61,7 @@ public:
 	virtual bool isDirectory() const { return _isDirectory; }
 	virtual bool isReadable() const;
 	virtual bool isWritable() const;
+	virtual bool getFileStats(uint32 &size, uint32 &modificationTime) const;
 
 	virtual AbstractFSNode *getChild(const Common::String &n) const;
 	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const;
@@ -70,7 +71,17 @@ public:
 	virtual Common::WriteStream *createWriteStream();
 	virtual bool createDirectory();
 
+	/**
+	 * Sets whether createReadStream() maps large files into memory, as set
+	 * by the "mmap_files" config option. Streams may be created on worker
+	 * threads, so this is to be called once by the backend, when it is
+	 * initialized.
+	 */
+	static void setMemoryMapping(bool enable) { _memoryMapping = enable; }
+
 protected:
+	static bool _memoryMapping;
+
 	/**
 	 * Tests and sets the _isValid and _isDirectory flags, using the stat() function.
 	 */
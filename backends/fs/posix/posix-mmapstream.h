@@ -0,0 +1,61 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_POSIXMMAPSTREAM_H
+#define BACKENDS_FS_POSIX_POSIXMMAPSTREAM_H
+
+#include "common/memstream.h"
+#include "common/str.h"
+
+/**
+ * A read stream on a file mapped into memory, so that its contents can be
+ * accessed through getRawData() without copying them, and are only read
+ * from disk once they are accessed.
+ */
+class PosixMmapStream : public Common::MemoryReadStream {
+public:
+	enum {
+		/**
+		 * Smaller files are read through stdio, since they are usually
+		 * read completely right away and mapping them would only add
+		 * overhead.
+		 */
+		kMinMappedSize = 256 * 1024
+	};
+
+	/**
+	 * Map the file at the given path into memory. Return nullptr if the file
+	 * cannot be mapped, or is not a regular file of at least kMinMappedSize
+	 * bytes.
+	 */
+	static PosixMmapStream *makeFromPath(const Common::String &path);
+
+	~PosixMmapStream() override;
+
+private:
+	PosixMmapStream(void *mapping, uint32 size);
+
+	void *_mapping;
+	uint32 _mappingSize;
+};
+
+#endif
@@ -55,6 +55,22 @@ bool WindowsFilesystemNode::isWritable() const {
 	return _access(_path.c_str(), W_OK) == 0;
 }
 
+bool WindowsFilesystemNode::getFileStats(uint32 &size, uint32 &modificationTime) const {
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesEx(toUnicode(_path.c_str()), GetFileExInfoStandard, &data))
+		return false;
+
+	if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		return false;
+
+	size = data.nFileSizeLow;
+
+	// Convert from 100 ns units since 1601 to seconds since 1970
+	const uint64 time = ((uint64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	modificationTime = (uint32)((time - 116444736000000000ULL) / 10000000);
+	return true;
+}
+
 void WindowsFilesystemNode::addFile(AbstractFSList &list, ListMode mode, const char *base, bool hidden, WIN32_FIND_DATA* find_data) {
 	WindowsFilesystemNode entry;
 	char *asciiName = toAscii(find_data->cFileName);
@@ -26,6 +26,8 @@
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/jobs.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -100,6 +102,32 @@ static ScalerProc *scalersMagn[3] = {
 #endif
 };
 
+/**
+ * Scales the rows of a dirty rect in horizontal bands, which may run in
+ * parallel. The scalers read the source rows around each band as well, but
+ * the source surface is complete and not modified while scaling, so there
+ * is no need to overlap the bands. Bands have an even height, so that the
+ * pattern of the DotMatrix scaler stays the same.
+ */
+struct ScalerBands {
+	enum {
+		kBandHeight = 32
+	};
+
+	ScalerProc *scalerProc;
+	const uint8 *srcPtr;
+	uint32 srcPitch;
+	uint8 *dstPtr;
+	uint32 dstPitch;
+	int width;
+	int scaleFactor;
+
+	void operator()(uint begin, uint end) const {
+		scalerProc(srcPtr + begin * srcPitch, srcPitch,
+			dstPtr + begin * scaleFactor * dstPitch, dstPitch, width, end - begin);
+	}
+};
+
 static const int s_gfxModeSwitchTable[][4] = {
 		{ GFX_NORMAL, GFX_DOUBLESIZE, GFX_TRIPLESIZE, -1 },
 		{ GFX_NORMAL, GFX_ADVMAME2X, GFX_ADVMAME3X, -1 },
@@ -174,6 +202,11 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 
 	_mouseBackup.x = _mouseBackup.y = _mouseBackup.w = _mouseBackup.h = 0;
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	memset(_scalerTimeHistogram, 0, sizeof(_scalerTimeHistogram));
+	_scalerTimeFrames = 0;
+#endif
+
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	if (ConfMan.hasKey("use_sdl_debug_focusrect"))
 		_enableFocusRectDebugCode = ConfMan.getBool("use_sdl_debug_focusrect");
@@ -1250,6 +1283,19 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwScreen->pitch;
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		const Uint64 scaleStart = SDL_GetPerformanceCounter();
+#endif
+
+		// Large rects are split into bands which are scaled in parallel
+		Common::JobSystem *jobSystem = g_system->getJobSystem();
+		uint bandHeight = ScalerBands::kBandHeight;
+#if defined(USE_NASM) && defined(USE_HQ_SCALERS)
+		// The assembly versions of the HQ scalers keep their state in globals
+		if (scalerProc == HQ2x || scalerProc == HQ3x)
+			bandHeight = height;
+#endif
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
 			int dst_x = r->x + _currentShakeXOffset;
 			int dst_y = r->y + _currentShakeYOffset;
@@ -1278,8 +1324,13 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch, dstPitch, dst_w, dst_h);
+				ScalerBands bands = {
+					scalerProc,
+					(const uint8 *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
+					(uint8 *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch, dstPitch,
+					dst_w, scale1
+				};
+				jobSystem->parallelFor(0, dst_h, bandHeight, bands);
 			}
 
 			r->x = dst_x;
@@ -1295,6 +1346,10 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		SDL_UnlockSurface(srcSurf);
 		SDL_UnlockSurface(_hwScreen);
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		recordScalerTime(SDL_GetPerformanceCounter() - scaleStart);
+#endif
+
 		// Readjust the dirty rect list in case we are doing a full update.
 		// This is necessary if shaking is active.
 		if (_forceRedraw) {
@@ -1398,6 +1453,34 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	_cursorNeedsRedraw = false;
 }
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+void SurfaceSdlGraphicsManager::recordScalerTime(Uint64 ticks) {
+	// Bucket i counts the frames which took less than 2^i microseconds
+	const Uint64 micros = ticks * 1000000 / SDL_GetPerformanceFrequency();
+	int bucket = 0;
+	while (bucket < kScalerTimeBuckets - 1 && micros >= ((Uint64)1 << bucket))
+		bucket++;
+	_scalerTimeHistogram[bucket]++;
+
+	if (++_scalerTimeFrames < kScalerTimeFrames)
+		return;
+
+	Common::String histogram;
+	for (int i = 0; i < kScalerTimeBuckets; i++) {
+		if (_scalerTimeHistogram[i] == 0)
+			continue;
+		if (i == kScalerTimeBuckets - 1)
+			histogram += Common::String::format(" >=%u:%u", 1U << (i - 1), _scalerTimeHistogram[i]);
+		else
+			histogram += Common::String::format(" <%u:%u", 1U << i, _scalerTimeHistogram[i]);
+	}
+	debug(2, "Scaler time of the last %u frames in microseconds:%s", _scalerTimeFrames, histogram.c_str());
+
+	memset(_scalerTimeHistogram, 0, sizeof(_scalerTimeHistogram));
+	_scalerTimeFrames = 0;
+}
+#endif
+
 bool SurfaceSdlGraphicsManager::saveScreenshot(const Common::String &filename) const {
 	assert(_hwScreen != NULL);
 
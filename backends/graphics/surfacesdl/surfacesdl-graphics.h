@@ -343,6 +343,22 @@ protected:
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	enum {
+		kScalerTimeBuckets = 16,
+		kScalerTimeFrames = 1000
+	};
+
+	/**
+	 * Histogram of the time spent scaling the dirty rects in each frame,
+	 * printed at debug level 2 every kScalerTimeFrames frames.
+	 */
+	uint32 _scalerTimeHistogram[kScalerTimeBuckets];
+	uint32 _scalerTimeFrames;
+
+	void recordScalerTime(Uint64 ticks);
+#endif
+
 	struct MousePos {
 		// The size and hotspot of the original cursor image.
 		int16 w, h;
@@ -0,0 +1,126 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+
+#include "common/scummsys.h"
+
+#if defined(POSIX)
+
+#include "backends/jobs/pthread/pthread-jobsystem.h"
+#include "common/textconsole.h"
+
+#include <sched.h>
+#include <unistd.h>
+
+PthreadJobSystem::PthreadJobSystem() : _numThreads(0), _numWaiting(0) {
+	pthread_key_create(&_threadIndexKey, nullptr);
+	pthread_mutex_init(&_mutex, nullptr);
+	pthread_cond_init(&_cond, nullptr);
+
+	long cpuCount = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+	cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	const uint numWorkers = getConfiguredWorkerCount(cpuCount > 0 ? cpuCount : 1);
+	setWorkerCount(numWorkers);
+
+	for (uint i = 0; i < numWorkers; ++i) {
+		Worker &worker = _workers[_numThreads];
+		worker.jobSystem = this;
+		worker.index = i + 1;
+		if (pthread_create(&worker.thread, nullptr, workerMain, &worker) != 0) {
+			warning("pthread_create() failed, running jobs on %d threads only", _numThreads + 1);
+			break;
+		}
+		_numThreads++;
+	}
+
+	// Queued jobs are also run by the waiting thread, so a partial set of
+	// workers is fine, but there must be at least one for jobs to be queued
+	if (_numThreads == 0)
+		setWorkerCount(0);
+
+	// Background jobs are never run by the waiting thread, so the number
+	// of background threads is only set once they are running
+	uint numBackground = 0;
+	for (uint i = 0; i < kBackgroundThreads; ++i) {
+		Worker &worker = _workers[_numThreads];
+		worker.jobSystem = this;
+		worker.index = 0;
+		if (pthread_create(&worker.thread, nullptr, workerMain, &worker) != 0) {
+			warning("pthread_create() failed, running %d background threads only", numBackground);
+			break;
+		}
+		_numThreads++;
+		numBackground++;
+	}
+	setBackgroundThreadCount(numBackground);
+}
+
+PthreadJobSystem::~PthreadJobSystem() {
+	stopWorkers();
+	for (uint i = 0; i < _numThreads; ++i)
+		pthread_join(_workers[i].thread, nullptr);
+
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+	pthread_key_delete(_threadIndexKey);
+}
+
+void *PthreadJobSystem::workerMain(void *arg) {
+	Worker *worker = (Worker *)arg;
+	pthread_setspecific(worker->jobSystem->_threadIndexKey, worker);
+	if (worker->index)
+		worker->jobSystem->runWorker(worker->index);
+	else
+		worker->jobSystem->runBackgroundWorker();
+	return nullptr;
+}
+
+uint PthreadJobSystem::getCurrentThreadIndex() const {
+	const Worker *worker = (const Worker *)pthread_getspecific(_threadIndexKey);
+	return worker ? worker->index : 0;
+}
+
+void PthreadJobSystem::waitForWork(const Common::JobGroup *group, bool background) {
+	pthread_mutex_lock(&_mutex);
+	_numWaiting++;
+	while (!hasWorkForWorkers(group, background))
+		pthread_cond_wait(&_cond, &_mutex);
+	_numWaiting--;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void PthreadJobSystem::notifyWorkers() {
+	pthread_mutex_lock(&_mutex);
+	if (_numWaiting > 0)
+		pthread_cond_broadcast(&_cond);
+	pthread_mutex_unlock(&_mutex);
+}
+
+void PthreadJobSystem::yieldThread() {
+	sched_yield();
+}
+
+#endif
@@ -0,0 +1,63 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_JOBS_PTHREAD_H
+#define BACKENDS_JOBS_PTHREAD_H
+
+#include "common/jobs.h"
+
+#include <pthread.h>
+
+/**
+ * Job system running its worker threads with pthreads.
+ */
+class PthreadJobSystem : public Common::JobSystem {
+public:
+	PthreadJobSystem();
+	virtual ~PthreadJobSystem();
+
+protected:
+	virtual uint getCurrentThreadIndex() const override;
+	virtual void waitForWork(const Common::JobGroup *group, bool background) override;
+	virtual void notifyWorkers() override;
+	virtual void yieldThread() override;
+
+private:
+	/** A worker or background thread, the latter with index 0. */
+	struct Worker {
+		PthreadJobSystem *jobSystem;
+		uint index;
+		pthread_t thread;
+	};
+
+	static void *workerMain(void *arg);
+
+	Worker _workers[kMaxWorkers + kBackgroundThreads];
+	uint _numThreads;
+
+	pthread_key_t _threadIndexKey;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	uint _numWaiting;
+};
+
+#endif
@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/jobs/sdl/sdl-jobsystem.h"
+#include "backends/platform/sdl/sdl-sys.h"
+#include "common/textconsole.h"
+
+SdlJobSystem::SdlJobSystem() : _numThreads(0), _threadIndexKey(0), _mutex(nullptr), _cond(nullptr), _numWaiting(0) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	_threadIndexKey = SDL_TLSCreate();
+	_mutex = SDL_CreateMutex();
+	_cond = SDL_CreateCond();
+	if (!_threadIndexKey || !_mutex || !_cond) {
+		warning("Could not create the job system synchronization objects: %s", SDL_GetError());
+		return;
+	}
+
+	const uint numWorkers = getConfiguredWorkerCount(SDL_GetCPUCount());
+	setWorkerCount(numWorkers);
+
+	for (uint i = 0; i < numWorkers; ++i) {
+		Worker &worker = _workers[_numThreads];
+		worker.jobSystem = this;
+		worker.index = i + 1;
+		worker.thread = SDL_CreateThread(workerMain, "ScummVM jobs", &worker);
+		if (!worker.thread) {
+			warning("SDL_CreateThread() failed, running jobs on %d threads only: %s", _numThreads + 1, SDL_GetError());
+			break;
+		}
+		_numThreads++;
+	}
+
+	// Queued jobs are also run by the waiting thread, so a partial set of
+	// workers is fine, but there must be at least one for jobs to be queued
+	if (_numThreads == 0)
+		setWorkerCount(0);
+
+	// Background jobs are never run by the waiting thread, so the number
+	// of background threads is only set once they are running
+	uint numBackground = 0;
+	for (uint i = 0; i < kBackgroundThreads; ++i) {
+		Worker &worker = _workers[_numThreads];
+		worker.jobSystem = this;
+		worker.index = 0;
+		worker.thread = SDL_CreateThread(workerMain, "ScummVM background jobs", &worker);
+		if (!worker.thread) {
+			warning("SDL_CreateThread() failed, running %d background threads only: %s", numBackground, SDL_GetError());
+			break;
+		}
+		_numThreads++;
+		numBackground++;
+	}
+	setBackgroundThreadCount(numBackground);
+#endif
+}
+
+SdlJobSystem::~SdlJobSystem() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	stopWorkers();
+	for (uint i = 0; i < _numThreads; ++i)
+		SDL_WaitThread(_workers[i].thread, nullptr);
+
+	if (_cond)
+		SDL_DestroyCond(_cond);
+	if (_mutex)
+		SDL_DestroyMutex(_mutex);
+#endif
+}
+
+int SdlJobSystem::workerMain(void *arg) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	Worker *worker = (Worker *)arg;
+	SDL_TLSSet(worker->jobSystem->_threadIndexKey, worker, nullptr);
+	if (worker->index)
+		worker->jobSystem->runWorker(worker->index);
+	else
+		worker->jobSystem->runBackgroundWorker();
+#endif
+	return 0;
+}
+
+uint SdlJobSystem::getCurrentThreadIndex() const {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	const Worker *worker = (const Worker *)SDL_TLSGet(_threadIndexKey);
+	return worker ? worker->index : 0;
+#else
+	return 0;
+#endif
+}
+
+void SdlJobSystem::waitForWork(const Common::JobGroup *group, bool background) {
+	SDL_LockMutex(_mutex);
+	_numWaiting++;
+	while (!hasWorkForWorkers(group, background))
+		SDL_CondWait(_cond, _mutex);
+	_numWaiting--;
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlJobSystem::notifyWorkers() {
+	SDL_LockMutex(_mutex);
+	if (_numWaiting > 0)
+		SDL_CondBroadcast(_cond);
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlJobSystem::yieldThread() {
+	SDL_Delay(0);
+}
+
+#endif
@@ -0,0 +1,68 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_JOBS_SDL_H
+#define BACKENDS_JOBS_SDL_H
+
+#include "common/jobs.h"
+
+struct SDL_Thread;
+struct SDL_mutex;
+struct SDL_cond;
+
+/**
+ * Job system running its worker threads with SDL.
+ *
+ * Thread local storage is only available with SDL 2, so there are no
+ * worker threads with SDL 1.2.
+ */
+class SdlJobSystem : public Common::JobSystem {
+public:
+	SdlJobSystem();
+	virtual ~SdlJobSystem();
+
+protected:
+	virtual uint getCurrentThreadIndex() const override;
+	virtual void waitForWork(const Common::JobGroup *group, bool background) override;
+	virtual void notifyWorkers() override;
+	virtual void yieldThread() override;
+
+private:
+	/** A worker or background thread, the latter with index 0. */
+	struct Worker {
+		SdlJobSystem *jobSystem;
+		uint index;
+		SDL_Thread *thread;
+	};
+
+	static int workerMain(void *arg);
+
+	Worker _workers[kMaxWorkers + kBackgroundThreads];
+	uint _numThreads;
+
+	uint _threadIndexKey;
+	SDL_mutex *_mutex;
+	SDL_cond *_cond;
+	uint _numWaiting;
+};
+
+#endif
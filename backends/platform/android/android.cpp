@@ -57,6 +57,7 @@
 
 #include "backends/audiocd/default/default-audiocd.h"
 #include "backends/events/default/default-events.h"
+#include "backends/jobs/pthread/pthread-jobsystem.h"
 #include "backends/mutex/pthread/pthread-mutex.h"
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
@@ -414,6 +415,7 @@ void OSystem_Android::initBackend() {
 
 	_mutexManager = new PthreadMutexManager();
 	_timerManager = new DefaultTimerManager();
+	_jobSystem = new PthreadJobSystem();
 
 	_event_queue_lock = new Common::Mutex();
 
@@ -44,6 +44,7 @@
 #include "backends/audiocd/linux/linux-audiocd.h"
 #endif
 
+#include "common/config-manager.h"
 #include "common/textconsole.h"
 
 #include <stdlib.h>
@@ -92,6 +93,9 @@ void OSystem_POSIX::initBackend() {
 	// Invoke parent implementation of this method
 	OSystem_SDL::initBackend();
 
+	// The config file has been read by now
+	POSIXFilesystemNode::setMemoryMapping(ConfMan.getBool("mmap_files"));
+
 #if defined(USE_TASKBAR) && defined(USE_UNITY)
 	// Register the taskbar manager as an event source (this is necessary for the glib event loop to be run)
 	_eventManager->getEventDispatcher()->registerSource((UnityTaskbarManager *)_taskbarManager, false);
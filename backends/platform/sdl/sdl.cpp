@@ -44,6 +44,7 @@
 #include "backends/events/default/default-events.h"
 #include "backends/events/sdl/legacy-sdl-events.h"
 #include "backends/keymapper/hardware-input.h"
+#include "backends/jobs/sdl/sdl-jobsystem.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
 #include "backends/timer/sdl/sdl-timer.h"
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
@@ -101,6 +102,8 @@ OSystem_SDL::~OSystem_SDL() {
 	// destructors would also take care of this for us. However, various
 	// of our managers must be deleted *before* we call SDL_Quit().
 	// Hence, we perform the destruction on our own.
+	delete _jobSystem;
+	_jobSystem = 0;
 	delete _savefileManager;
 	_savefileManager = 0;
 	if (_graphicsManager) {
@@ -282,6 +285,10 @@ void OSystem_SDL::initBackend() {
 
 	_audiocdManager = createAudioCDManager();
 
+	// The worker count depends on the config, so this is not done in init()
+	if (_jobSystem == 0)
+		_jobSystem = new SdlJobSystem();
+
 	// Setup a custom program icon.
 	_window->setupIcon();
 
@@ -27,13 +27,16 @@
 
 #include <limits.h>
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
 #include "base/plugins.h"
 #include "base/version.h"
 
 #include "common/config-manager.h"
+#include "common/flat-hashmap.h"
 #include "common/fs.h"
+#include "common/jobs.h"
 #include "common/rendermode.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -41,10 +44,16 @@
 
 #include "gui/ThemeEngine.h"
 
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
 #include "audio/musicplugin.h"
+#include "audio/rate.h"
 
 #include "graphics/renderer.h"
 
+#include "video/video_decoder.h"
+#include "video/video_factory.h"
+
 #define DETECTOR_TESTING_HACK
 #define UPGRADE_ALL_TARGETS_HACK
 
@@ -84,6 +93,14 @@ static const char HELP_STRING[] =
 	"  --auto-detect            Display a list of games from current or specified directory\n"
 	"                           and start the first one. Use --path=PATH to specify a directory.\n"
 	"  --recursive              In combination with --add or --detect recurse down all subdirectories\n"
+	"  --rebuild-detection-cache\n"
+	"                           Discard the file checksums cached by game detection\n"
+	"  --benchmark-video=FILE   Decode all the frames of a video file without displaying\n"
+	"                           them, print the decoding speed and exit\n"
+	"  --benchmark-hashmap      Compare the speed of HashMap and FlatHashMap with file\n"
+	"                           name keys and exit\n"
+	"  --benchmark-rate         Time the audio rate converters mixing many channels\n"
+	"                           and exit\n"
 #if defined(WIN32) && !defined(__SYMBIAN32__)
 	"  --console                Enable the console window (default:enabled)\n"
 #endif
@@ -302,6 +319,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("joystick_num", 0);
 	ConfMan.registerDefault("confirm_exit", false);
 	ConfMan.registerDefault("disable_sdl_parachute", false);
+	ConfMan.registerDefault("mmap_files", false);
 
 	ConfMan.registerDefault("disable_display", false);
 	ConfMan.registerDefault("record_mode", "none");
@@ -564,6 +582,12 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_COMMAND("list-saves")
 			END_COMMAND
 
+			DO_LONG_COMMAND("benchmark-hashmap")
+			END_COMMAND
+
+			DO_LONG_COMMAND("benchmark-rate")
+			END_COMMAND
+
 			DO_OPTION('c', "config")
 			END_OPTION
 
@@ -752,6 +776,12 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_BOOL("recursive")
 			END_OPTION
 
+			DO_LONG_OPTION_BOOL("rebuild-detection-cache")
+			END_OPTION
+
+			DO_LONG_OPTION("benchmark-video")
+			END_OPTION
+
 			DO_LONG_OPTION("themepath")
 				Common::FSNode path(option);
 				if (!path.exists()) {
@@ -1017,6 +1047,124 @@ static void listAudioDevices() {
 	}
 }
 
+/**
+ * Time filling a map of type @p Map with @p keys, then looking up each key
+ * and as many missing ones, @p rounds times.
+ */
+template<class Map>
+static void benchmarkHashMapType(const char *name, const Common::Array<Common::String> &keys,
+                                 const Common::Array<Common::String> &missingKeys, uint rounds) {
+	const uint32 startTime = g_system->getMillis();
+	Map map;
+	for (uint i = 0; i < keys.size(); i++)
+		map[keys[i]] = i;
+	const uint32 insertTime = g_system->getMillis() - startTime;
+
+	// Look the keys up in a scattered order, as file lookups are, and count
+	// the hits so that the lookups cannot be optimized away
+	uint hits = 0;
+	const uint32 lookupStartTime = g_system->getMillis();
+	for (uint round = 0; round < rounds; round++) {
+		for (uint i = 0; i < keys.size(); i++) {
+			const uint index = (i * 7919) % keys.size();
+			hits += map.contains(keys[index]);
+			hits += map.contains(missingKeys[index]);
+		}
+	}
+	const uint32 lookupTime = g_system->getMillis() - lookupStartTime;
+
+	printf("%-12s %6u ms to insert %u keys, %6u ms for %u lookups (%u hits)\n", name, insertTime, keys.size(),
+	       lookupTime, rounds * keys.size() * 2, hits);
+}
+
+/** Compare HashMap and FlatHashMap with case insensitive file name keys */
+static void benchmarkHashMap() {
+	typedef Common::HashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> NodeMap;
+	typedef Common::FlatHashMap<Common::String, uint, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FlatMap;
+
+	const uint kKeys = 50000;
+	const uint kRounds = 20;
+
+	Common::Array<Common::String> keys, missingKeys;
+	for (uint i = 0; i < kKeys; i++) {
+		keys.push_back(Common::String::format("resource.%03u/Room%05u.dat", i % 100, i));
+		missingKeys.push_back(Common::String::format("patches/Room%05u.dat", i));
+	}
+
+	benchmarkHashMapType<NodeMap>("HashMap", keys, missingKeys, kRounds);
+	benchmarkHashMapType<FlatMap>("FlatHashMap", keys, missingKeys, kRounds);
+}
+
+/** Endless sawtooth wave, so that the rate benchmark never runs out of input */
+class BenchmarkAudioStream : public Audio::AudioStream {
+public:
+	BenchmarkAudioStream(int rate, bool stereo) : _rate(rate), _stereo(stereo), _sample(0) {}
+
+	virtual int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; i++) {
+			buffer[i] = (int16)_sample;
+			_sample += 97;
+		}
+		return numSamples;
+	}
+
+	virtual bool isStereo() const { return _stereo; }
+	virtual int getRate() const { return _rate; }
+	virtual bool endOfData() const { return false; }
+
+private:
+	const int _rate;
+	const bool _stereo;
+	uint16 _sample;
+};
+
+/**
+ * Time mixing @p channels streams at @p inRate into an @p outRate output
+ * buffer, the way the mixer does it.
+ */
+static void benchmarkRateConversion(uint inRate, uint outRate, bool stereo, uint channels) {
+	const uint kOutputPairs = 1024;
+	const uint kSeconds = 60;
+
+	Common::Array<BenchmarkAudioStream *> streams;
+	Common::Array<Audio::RateConverter *> converters;
+	for (uint i = 0; i < channels; i++) {
+		streams.push_back(new BenchmarkAudioStream(inRate, stereo));
+		converters.push_back(Audio::makeRateConverter(inRate, outRate, stereo));
+	}
+
+	int16 *buffer = new int16[kOutputPairs * 2];
+	const uint rounds = kSeconds * outRate / kOutputPairs;
+	const uint32 startTime = g_system->getMillis();
+	for (uint round = 0; round < rounds; round++) {
+		memset(buffer, 0, kOutputPairs * 2 * sizeof(int16));
+		for (uint i = 0; i < channels; i++)
+			converters[i]->flow(*streams[i], buffer, kOutputPairs, Audio::Mixer::kMaxMixerVolume / 4, Audio::Mixer::kMaxMixerVolume / 2);
+	}
+	const uint32 time = g_system->getMillis() - startTime;
+
+	printf("%6u Hz -> %6u Hz %-6s %6u ms for %u seconds of %u channels\n", inRate, outRate,
+	       stereo ? "stereo" : "mono", time, kSeconds, channels);
+
+	delete[] buffer;
+	for (uint i = 0; i < channels; i++) {
+		delete converters[i];
+		delete streams[i];
+	}
+}
+
+/** Time the copy, simple and linear rate converters */
+static void benchmarkRate() {
+	const uint kChannels = 24;
+
+	benchmarkRateConversion(44100, 44100, true, kChannels);
+	benchmarkRateConversion(88200, 44100, true, kChannels);
+	benchmarkRateConversion(22050, 44100, false, kChannels);
+	benchmarkRateConversion(22050, 48000, true, kChannels);
+	benchmarkRateConversion(11025, 44100, false, kChannels);
+	benchmarkRateConversion(48000, 44100, true, kChannels);
+}
+
 /** Display all games in the given directory, or current directory if empty */
 static DetectedGames getGameList(const Common::FSNode &dir) {
 	Common::FSList files;
@@ -1353,6 +1501,11 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 		}
 	}
 
+	// Start over with an empty detection cache, before any command below
+	// may run the detectors.
+	if (settings.contains("rebuild-detection-cache") && settings["rebuild-detection-cache"] == "true")
+		DetectionCacheMan.clear();
+
 	// Handle commands passed via the command line (like --list-targets and
 	// --list-games). This must be done after the config file and the plugins
 	// have been loaded.
@@ -1374,6 +1527,12 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 	} else if (command == "list-audio-devices") {
 		listAudioDevices();
 		return true;
+	} else if (command == "benchmark-hashmap") {
+		benchmarkHashMap();
+		return true;
+	} else if (command == "benchmark-rate") {
+		benchmarkRate();
+		return true;
 	} else if (command == "version") {
 		printf("%s\n", gScummVMFullVersion);
 		printf("Features compiled in: %s\n", gScummVMFeatures);
@@ -1460,4 +1619,71 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 	return false;
 }
 
+/**
+ * Decode all the frames of a video file once, keeping up to
+ * @p decodeAhead frames decoded in advance, and print the decoding speed.
+ */
+static Common::Error benchmarkVideoRun(const Common::String &path, uint decodeAhead) {
+	Video::VideoDecoder *decoder = Video::createDecoderForFile(path);
+	if (!decoder) {
+		printf("Unsupported video format: '%s'\n", path.c_str());
+		return Common::kUnknownError;
+	}
+
+	Common::FSNode node(path);
+	Common::SeekableReadStream *stream = node.createReadStream();
+	if (!stream) {
+		printf("Could not open '%s'\n", path.c_str());
+		delete decoder;
+		return Common::kReadingFailed;
+	}
+
+	// Convert YUV based videos to a 32-bit format, as games usually do
+	decoder->setDefaultHighColorFormat(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+	if (!decoder->loadStream(stream)) {
+		printf("Could not load '%s'\n", path.c_str());
+		delete decoder;
+		return Common::kReadingFailed;
+	}
+
+	const bool ahead = decodeAhead && decoder->setDecodeAhead(decodeAhead);
+
+	// Playing lets the mixer consume the decoded audio instead of queueing
+	// all of it, but there is no need to hear it
+	decoder->setVolume(0);
+	decoder->start();
+
+	const uint32 frames = decoder->getFrameCount();
+
+	const uint32 startTime = g_system->getMillis();
+	uint32 decoded = 0;
+	for (uint32 i = 0; i < frames; i++) {
+		if (decoder->decodeNextFrame())
+			decoded++;
+	}
+	const uint32 elapsed = MAX<uint32>(g_system->getMillis() - startTime, 1);
+
+	Common::String mode = "serial";
+	if (ahead)
+		mode = Common::String::format("%u frames ahead", decodeAhead);
+	else if (decodeAhead)
+		mode = "decoding ahead is not supported";
+
+	printf("Decoded %u of %u frames of %dx%d in %u ms (%.2f fps) using %u threads (%s)\n", decoded, frames,
+	       decoder->getWidth(), decoder->getHeight(), elapsed, decoded * 1000.0 / elapsed,
+	       g_system->getJobSystem()->getThreadCount(), mode.c_str());
+
+	decoder->stop();
+	delete decoder;
+	return Common::kNoError;
+}
+
+Common::Error benchmarkVideo(const Common::String &path) {
+	// Measure plain decoding first, then decoding ahead
+	Common::Error err = benchmarkVideoRun(path, 0);
+	if (err.getCode() == Common::kNoError)
+		err = benchmarkVideoRun(path, 4);
+	return err;
+}
+
 } // End of namespace Base
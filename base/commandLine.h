@@ -55,6 +55,18 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
  */
 bool processSettings(Common::String &command, Common::StringMap &settings, Common::Error &err);
 
+/**
+ * Decode all the frames of a video file as fast as possible, without
+ * displaying them, and print the decoding speed. The video is decoded
+ * twice, the second time with frames decoded ahead when the decoder
+ * supports it. This is used for the --benchmark-video option, and needs
+ * an initialized backend and mixer.
+ *
+ * @param path	the path of the video file
+ * @return the error which prevented decoding the video, if any
+ */
+Common::Error benchmarkVideo(const Common::String &path);
+
 } // End of namespace Base
 
 #endif
@@ -537,9 +537,16 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	CloudMan.syncSaves();
 #endif
 
-	// Unless a game was specified, show the launcher dialog
-	if (0 == ConfMan.getActiveDomain())
+	if (settings.contains("benchmark-video")) {
+		// Run the video benchmark instead of any game, then quit
+		Common::Error benchmarkResult = Base::benchmarkVideo(settings["benchmark-video"]);
+		if (benchmarkResult.getCode() != Common::kNoError)
+			warning("%s", benchmarkResult.getDesc().c_str());
+		ConfMan.setActiveDomain("");
+	} else if (0 == ConfMan.getActiveDomain()) {
+		// Unless a game was specified, show the launcher dialog
 		launcherDialog();
+	}
 
 	// FIXME: We're now looping the launcher. This, of course, doesn't
 	// work as well as it should. In theory everything should be destroyed
@@ -617,6 +617,7 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 // Engine plugins
 
 #include "engines/metaengine.h"
+#include "engines/detectioncache.h"
 
 namespace Common {
 DECLARE_SINGLETON(EngineManager);
@@ -688,19 +689,29 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist) const
 	// Iterate over all known games and for each check if it might be
 	// the game in the presented directory.
 	for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
-		const MetaEngineDetection &metaEngine = (*iter)->get<MetaEngineDetection>();
-		DetectedGames engineCandidates = metaEngine.detectGames(fslist);
-
-		for (uint i = 0; i < engineCandidates.size(); i++) {
-			engineCandidates[i].path = fslist.begin()->getParent().getPath();
-			engineCandidates[i].shortPath = fslist.begin()->getParent().getDisplayName();
+		DetectedGames engineCandidates = detectGames(*iter, fslist);
+		for (uint i = 0; i < engineCandidates.size(); i++)
 			candidates.push_back(engineCandidates[i]);
-		}
 	}
 
+	// Save the file checksums computed by the detectors for the next scan
+	DetectionCacheMan.flush();
+
 	return DetectionResults(candidates);
 }
 
+DetectedGames EngineManager::detectGames(const Plugin *plugin, const Common::FSList &fslist) const {
+	const MetaEngineDetection &metaEngine = plugin->get<MetaEngineDetection>();
+	DetectedGames candidates = metaEngine.detectGames(fslist);
+
+	for (uint i = 0; i < candidates.size(); i++) {
+		candidates[i].path = fslist.begin()->getParent().getPath();
+		candidates[i].shortPath = fslist.begin()->getParent().getDisplayName();
+	}
+
+	return candidates;
+}
+
 const PluginList &EngineManager::getPlugins(const PluginType fetchPluginType) const {
 	return PluginManager::instance().getPlugins(fetchPluginType);
 }
@@ -22,6 +22,7 @@
 
 #include "common/archive.h"
 #include "common/fs.h"
+#include "common/memstream.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
@@ -40,6 +41,92 @@ SeekableReadStream *GenericArchiveMember::createReadStream() const {
 }
 
 
+ArchivePrefetch::ArchivePrefetch() : _jobSystem(g_system->getJobSystem()) {
+}
+
+ArchivePrefetch::~ArchivePrefetch() {
+	for (uint i = 0; i < _entries.size(); ++i) {
+		_jobSystem->wait(_entries[i]->job);
+		free(_entries[i]->data);
+		delete _entries[i];
+	}
+}
+
+void ArchivePrefetch::add(const String &name, const ArchiveMemberPtr &member) {
+	if (!member || !member->isThreadSafe() || !_jobSystem->hasBackgroundThreads())
+		return;
+
+	Entry *entry = new Entry();
+	entry->name = name;
+	entry->member = member;
+	entry->data = nullptr;
+	entry->size = 0;
+	entry->failed = false;
+	_entries.push_back(entry);
+
+	_jobSystem->runInBackground(entry->job, &readMemberProc, entry);
+}
+
+void ArchivePrefetch::readMemberProc(void *refCon) {
+	Entry *entry = (Entry *)refCon;
+
+	SeekableReadStream *stream = entry->member->createReadStream();
+	if (stream) {
+		entry->size = stream->size();
+		entry->data = (byte *)malloc(entry->size);
+		entry->failed = entry->size && (!entry->data || stream->read(entry->data, entry->size) != entry->size);
+		delete stream;
+	} else {
+		entry->failed = true;
+	}
+}
+
+bool ArchivePrefetch::isDone() const {
+	for (uint i = 0; i < _entries.size(); ++i) {
+		if (!_entries[i]->job.isDone())
+			return false;
+	}
+
+	return true;
+}
+
+bool ArchivePrefetch::isMemberReady(const String &name) const {
+	for (uint i = 0; i < _entries.size(); ++i) {
+		if (_entries[i]->name.equalsIgnoreCase(name))
+			return _entries[i]->job.isDone();
+	}
+
+	return true;
+}
+
+void ArchivePrefetch::wait() {
+	for (uint i = 0; i < _entries.size(); ++i)
+		_jobSystem->wait(_entries[i]->job);
+}
+
+SeekableReadStream *ArchivePrefetch::createReadStreamForMember(const String &name) {
+	for (uint i = 0; i < _entries.size(); ++i) {
+		Entry *entry = _entries[i];
+		if (!entry->name.equalsIgnoreCase(name))
+			continue;
+
+		_jobSystem->wait(entry->job);
+		_entries.remove_at(i);
+
+		SeekableReadStream *stream = nullptr;
+		if (!entry->failed)
+			stream = new MemoryReadStream(entry->data, entry->size, DisposeAfterUse::YES);
+		else
+			free(entry->data);
+
+		delete entry;
+		return stream;
+	}
+
+	return nullptr;
+}
+
+
 int Archive::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
 	// Get all "names" (TODO: "files" ?)
 	ArchiveMemberList allNames;
@@ -60,6 +147,14 @@ int Archive::listMatchingMembers(ArchiveMemberList &list, const String &pattern)
 	return matches;
 }
 
+ArchivePrefetch *Archive::prefetch(const ArchiveMemberList &members) const {
+	ArchivePrefetch *result = new ArchivePrefetch();
+	for (ArchiveMemberList::const_iterator it = members.begin(); it != members.end(); ++it)
+		result->add((*it)->getName(), *it);
+
+	return result;
+}
+
 
 
 SearchSet::ArchiveNodeList::iterator SearchSet::find(const String &name) {
@@ -170,6 +265,8 @@ void SearchSet::addSubDirectoriesMatching(const FSNode &directory, String origPa
 void SearchSet::remove(const String &name) {
 	ArchiveNodeList::iterator it = find(name);
 	if (it != _list.end()) {
+		clearPrefetch();
+
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
@@ -181,6 +278,8 @@ bool SearchSet::hasArchive(const String &name) const {
 }
 
 void SearchSet::clear() {
+	clearPrefetch();
+
 	for (ArchiveNodeList::iterator i = _list.begin(); i != _list.end(); ++i) {
 		if (i->_autoFree)
 			delete i->_arc;
@@ -255,6 +354,12 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	if (name.empty())
 		return nullptr;
 
+	if (_prefetch) {
+		SeekableReadStream *stream = _prefetch->createReadStreamForMember(name);
+		if (stream)
+			return stream;
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
@@ -265,6 +370,23 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) con
 	return nullptr;
 }
 
+void SearchSet::prefetchMembers(const StringArray &names) {
+	clearPrefetch();
+
+	_prefetch = new ArchivePrefetch();
+	for (uint i = 0; i < names.size(); ++i)
+		_prefetch->add(names[i], getMember(names[i]));
+}
+
+bool SearchSet::isPrefetchDone() const {
+	return !_prefetch || _prefetch->isDone();
+}
+
+void SearchSet::clearPrefetch() {
+	delete _prefetch;
+	_prefetch = nullptr;
+}
+
 
 SearchManager::SearchManager() {
 	clear(); // Force a reset
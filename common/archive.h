@@ -24,7 +24,9 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/str-array.h"
 #include "common/list.h"
+#include "common/jobs.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
 
@@ -58,6 +60,13 @@ public:
 	virtual SeekableReadStream *createReadStream() const = 0; /*!< Create a read stream. */
 	virtual String getName() const = 0; /*!< Get the name of the archive member. */
 	virtual String getDisplayName() const { return getName(); } /*!< Get the display name of the archive member. */
+
+	/**
+	 * Return true if createReadStream() may be called from another thread
+	 * while the archive is in use, which allows reading the member in the
+	 * background. See ArchivePrefetch.
+	 */
+	virtual bool isThreadSafe() const { return false; }
 };
 
 typedef SharedPtr<ArchiveMember> ArchiveMemberPtr; /*!< Shared pointer to an archive member. */
@@ -74,6 +83,69 @@ struct ArchiveMemberListComparator {
 
 class Archive;
 
+/**
+ * The contents of a set of archive members, read on the background threads
+ * of the job system. This allows starting to read the files needed next,
+ * such as the resources of the next room, while the engine is still busy
+ * with something else. The reads never run on the threads waiting for
+ * other jobs, so they do not delay them.
+ *
+ * Only members which are thread safe are read; the other ones are ignored
+ * and have to be read normally. Without background threads, nothing is
+ * prefetched.
+ */
+class ArchivePrefetch : NonCopyable {
+public:
+	ArchivePrefetch();
+
+	/** Wait for the members still being read, and free the unused contents. */
+	~ArchivePrefetch();
+
+	/**
+	 * Start reading a member in the background. Its contents are looked up
+	 * by @p name, which is usually the name of the member.
+	 */
+	void add(const String &name, const ArchiveMemberPtr &member);
+
+	/** Return true once all the members have been read. */
+	bool isDone() const;
+
+	/**
+	 * Return true if createReadStreamForMember() would not have to wait
+	 * for the member with the given name, because it has been read or is
+	 * not being prefetched.
+	 */
+	bool isMemberReady(const String &name) const;
+
+	/** Wait until all the members have been read. */
+	void wait();
+
+	/**
+	 * Create a stream on the prefetched contents of the member with the
+	 * given name, waiting for them to be read if necessary. The contents are
+	 * handed over to the stream, so this succeeds only once per member.
+	 *
+	 * @return The newly created stream, or nullptr if the member was not
+	 *         prefetched, could not be read, or was already returned.
+	 */
+	SeekableReadStream *createReadStreamForMember(const String &name);
+
+private:
+	struct Entry {
+		String name;
+		ArchiveMemberPtr member;
+		byte *data;
+		uint32 size;
+		bool failed;
+		JobGroup job;
+	};
+
+	Array<Entry *> _entries;
+	JobSystem *_jobSystem;
+
+	static void readMemberProc(void *refCon);
+};
+
 /**
  * Simple ArchiveMember implementation which allows
  * creation of ArchiveMember compatible objects via
@@ -137,6 +209,13 @@ public:
 	 * @return The newly created input stream.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const = 0;
+
+	/**
+	 * Start reading the given members of the archive in the background.
+	 *
+	 * @return The prefetched contents, to be deleted by the caller.
+	 */
+	ArchivePrefetch *prefetch(const ArchiveMemberList &members) const;
 };
 
 
@@ -168,8 +247,10 @@ class SearchSet : public Archive {
 
 	bool _ignoreClashes;
 
+	ArchivePrefetch *_prefetch;
+
 public:
-	SearchSet() : _ignoreClashes(false) { }
+	SearchSet() : _ignoreClashes(false), _prefetch(nullptr) { }
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -260,9 +341,27 @@ public:
 	/**
 	 * Implement createReadStreamForMember from the Archive base class. The current policy is
 	 * opening the first file encountered that matches the name.
+	 * Files prefetched with prefetchMembers() are returned from memory.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
 
+	/**
+	 * Start reading the files with the given names in the background, so
+	 * that opening them later does not wait for the disk. Each prefetched
+	 * file is kept in memory until it is opened once. Files from a previous
+	 * call which have not been opened yet are dropped.
+	 */
+	void prefetchMembers(const StringArray &names);
+
+	/**
+	 * Return true once all the files passed to prefetchMembers() have been
+	 * read, so that opening any of them does not wait.
+	 */
+	bool isPrefetchDone() const;
+
+	/** Drop the files prefetched with prefetchMembers() which have not been opened. */
+	void clearPrefetch();
+
 	/**
 	 * Ignore clashes when adding directories. For more details, see the corresponding parameter
 	 * in @ref FSDirectory documentation.
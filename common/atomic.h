@@ -0,0 +1,168 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+#include "common/mutex.h"
+
+#if !defined(__GNUC__) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @defgroup common_atomic Atomic values
+ * @ingroup common
+ *
+ * @brief API for lock-free access to values shared between threads.
+ * @{
+ */
+
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define COMMON_ATOMIC_IS_NATIVE true
+#else
+#define COMMON_ATOMIC_IS_NATIVE false
+#endif
+
+/**
+ * A 32-bit value which can be read and modified by several threads
+ * without taking a mutex.
+ *
+ * Loads have acquire semantics and stores have release semantics, so a
+ * thread which observes a value written by another thread also observes
+ * everything that thread wrote before it. The read-modify-write operations
+ * are full barriers.
+ *
+ * The compiler intrinsics are used for 32-bit integer types on GCC, Clang
+ * and MSVC. Other types and compilers fall back to an implementation which
+ * takes a mutex, as wider atomics may need libatomic on some ports.
+ */
+template<typename T, bool native = COMMON_ATOMIC_IS_NATIVE && sizeof(T) == 4>
+class Atomic {
+	T _value;
+	Mutex _mutex;
+
+	// Prevent copying instances by accident
+	Atomic(const Atomic &);
+	Atomic &operator=(const Atomic &);
+
+public:
+	explicit Atomic(T value = T()) : _value(value) {}
+
+	T load() const {
+		StackLock lock(_mutex);
+		return _value;
+	}
+
+	void store(T value) {
+		StackLock lock(_mutex);
+		_value = value;
+	}
+
+	/** Add @p delta to the value and return the previous value. */
+	T fetchAdd(T delta) {
+		StackLock lock(_mutex);
+		const T previous = _value;
+		_value += delta;
+		return previous;
+	}
+
+	/** Replace the value and return the previous value. */
+	T exchange(T value) {
+		StackLock lock(_mutex);
+		const T previous = _value;
+		_value = value;
+		return previous;
+	}
+
+	/**
+	 * Replace the value with @p desired if it equals @p expected.
+	 *
+	 * @return true if the value was replaced. Otherwise @p expected is
+	 *         updated to the current value.
+	 */
+	bool compareExchange(T &expected, T desired) {
+		StackLock lock(_mutex);
+		if (_value == expected) {
+			_value = desired;
+			return true;
+		}
+		expected = _value;
+		return false;
+	}
+};
+
+#if COMMON_ATOMIC_IS_NATIVE
+template<typename T>
+class Atomic<T, true> {
+#if defined(__GNUC__)
+	T _value;
+#else
+	volatile long _value;
+#endif
+
+	// Prevent copying instances by accident
+	Atomic(const Atomic &);
+	Atomic &operator=(const Atomic &);
+
+public:
+	explicit Atomic(T value = T()) : _value(value) {}
+
+#if defined(__GNUC__)
+	T load() const { return __atomic_load_n(&_value, __ATOMIC_ACQUIRE); }
+	void store(T value) { __atomic_store_n(&_value, value, __ATOMIC_RELEASE); }
+	T fetchAdd(T delta) { return __atomic_fetch_add(&_value, delta, __ATOMIC_SEQ_CST); }
+	T exchange(T value) { return __atomic_exchange_n(&_value, value, __ATOMIC_SEQ_CST); }
+
+	bool compareExchange(T &expected, T desired) {
+		return __atomic_compare_exchange_n(&_value, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	}
+#else
+	T load() const { return (T)_InterlockedOr(const_cast<volatile long *>(&_value), 0); }
+
+	void store(T value) {
+		_InterlockedExchange(&_value, (long)value);
+	}
+
+	T fetchAdd(T delta) { return (T)_InterlockedExchangeAdd(&_value, (long)delta); }
+
+	T exchange(T value) { return (T)_InterlockedExchange(&_value, (long)value); }
+
+	bool compareExchange(T &expected, T desired) {
+		const T previous = (T)_InterlockedCompareExchange(&_value, (long)desired, (long)expected);
+		if (previous == expected)
+			return true;
+		expected = previous;
+		return false;
+	}
+#endif
+};
+#endif
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
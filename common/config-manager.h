@@ -24,6 +24,7 @@
 #define COMMON_CONFIG_MANAGER_H
 
 #include "common/array.h"
+#include "common/flat-hashmap.h"
 #include "common/hashmap.h"
 #include "common/singleton.h"
 #include "common/str.h"
@@ -58,12 +59,18 @@ public:
 
 	class Domain {
 	private:
-		StringMap _entries;
+		/**
+		 * Looked up on every ConfMan access. References to values are
+		 * invalidated when a key is added to the domain.
+		 */
+		typedef FlatHashMap<String, String, IgnoreCase_Hash, IgnoreCase_EqualTo> EntryMap;
+
+		EntryMap  _entries;
 		StringMap _keyValueComments;
 		String    _domainComment;
 
 	public:
-		typedef StringMap::const_iterator const_iterator;
+		typedef EntryMap::const_iterator const_iterator;
 		const_iterator begin() const { return _entries.begin(); } /*!< Return the beginning position of configuration entries. */
 		const_iterator end()   const { return _entries.end(); }   /*!< Return the ending position of configuration entries. */
 
@@ -31,6 +31,14 @@
 #include "common/util.h"
 #include "common/textconsole.h"
 
+#if defined(__SSE2__)
+#define USE_SSE2_FFT
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define USE_NEON_FFT
+#include <arm_neon.h>
+#endif
+
 namespace Common {
 
 FFT::FFT(int bits, int inverse) : _bits(bits), _inverse(inverse) {
@@ -155,6 +163,121 @@ int FFT::splitRadixPermutation(int i, int n, int inverse) {
 	BUTTERFLIES(a0, a1, a2, a3) \
 }
 
+#if defined(USE_SSE2_FFT) || defined(USE_NEON_FFT)
+
+#ifdef USE_SSE2_FFT
+
+typedef __m128 FFTVector;
+
+static inline FFTVector addFFT(FFTVector a, FFTVector b) { return _mm_add_ps(a, b); }
+static inline FFTVector subFFT(FFTVector a, FFTVector b) { return _mm_sub_ps(a, b); }
+static inline FFTVector mulFFT(FFTVector a, FFTVector b) { return _mm_mul_ps(a, b); }
+
+static inline FFTVector loadFFT(const float *w) {
+	return _mm_loadu_ps(w);
+}
+
+/** Load w[0], w[-1], w[-2] and w[-3]. */
+static inline FFTVector loadReversedFFT(const float *w) {
+	const __m128 v = _mm_loadu_ps(w - 3);
+	return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+static inline void loadComplexFFT(const Complex *z, FFTVector &re, FFTVector &im) {
+	const __m128 lo = _mm_loadu_ps(&z[0].re);
+	const __m128 hi = _mm_loadu_ps(&z[2].re);
+	re = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+	im = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static inline void storeComplexFFT(Complex *z, FFTVector re, FFTVector im) {
+	_mm_storeu_ps(&z[0].re, _mm_unpacklo_ps(re, im));
+	_mm_storeu_ps(&z[2].re, _mm_unpackhi_ps(re, im));
+}
+
+#else
+
+typedef float32x4_t FFTVector;
+
+static inline FFTVector addFFT(FFTVector a, FFTVector b) { return vaddq_f32(a, b); }
+static inline FFTVector subFFT(FFTVector a, FFTVector b) { return vsubq_f32(a, b); }
+static inline FFTVector mulFFT(FFTVector a, FFTVector b) { return vmulq_f32(a, b); }
+
+static inline FFTVector loadFFT(const float *w) {
+	return vld1q_f32(w);
+}
+
+/** Load w[0], w[-1], w[-2] and w[-3]. */
+static inline FFTVector loadReversedFFT(const float *w) {
+	const float32x4_t v = vrev64q_f32(vld1q_f32(w - 3));
+	return vcombine_f32(vget_high_f32(v), vget_low_f32(v));
+}
+
+static inline void loadComplexFFT(const Complex *z, FFTVector &re, FFTVector &im) {
+	const float32x4x2_t v = vld2q_f32(&z[0].re);
+	re = v.val[0];
+	im = v.val[1];
+}
+
+static inline void storeComplexFFT(Complex *z, FFTVector re, FFTVector im) {
+	float32x4x2_t v;
+	v.val[0] = re;
+	v.val[1] = im;
+	vst2q_f32(&z[0].re, v);
+}
+
+#endif
+
+/**
+ * TRANSFORM() on four consecutive elements of each quarter. The operations
+ * are the same as in the scalar macros, so that the results do not depend
+ * on which path was taken.
+ */
+static inline void transformFFT(Complex *z, const float *wre, const float *wim, int o1, int o2, int o3) {
+	FFTVector r0, i0, r1, i1, r2, i2, r3, i3;
+	loadComplexFFT(z, r0, i0);
+	loadComplexFFT(z + o1, r1, i1);
+	loadComplexFFT(z + o2, r2, i2);
+	loadComplexFFT(z + o3, r3, i3);
+
+	const FFTVector vre = loadFFT(wre);
+	const FFTVector vim = loadReversedFFT(wim);
+
+	const FFTVector t1 = addFFT(mulFFT(r2, vre), mulFFT(i2, vim));
+	const FFTVector t2 = subFFT(mulFFT(i2, vre), mulFFT(r2, vim));
+	const FFTVector t5 = subFFT(mulFFT(r3, vre), mulFFT(i3, vim));
+	const FFTVector t6 = addFFT(mulFFT(i3, vre), mulFFT(r3, vim));
+
+	const FFTVector t3 = subFFT(t5, t1);
+	const FFTVector t5s = addFFT(t5, t1);
+	const FFTVector t4 = subFFT(t2, t6);
+	const FFTVector t6s = addFFT(t2, t6);
+
+	storeComplexFFT(z + o2, subFFT(r0, t5s), subFFT(i0, t6s));
+	storeComplexFFT(z, addFFT(r0, t5s), addFFT(i0, t6s));
+	storeComplexFFT(z + o3, subFFT(r1, t4), subFFT(i1, t3));
+	storeComplexFFT(z + o1, addFFT(r1, t4), addFFT(i1, t3));
+}
+
+/* z[0...8n-1], w[1...2n-1], n >= 2 */
+#define PASS(name) \
+static void name(Complex *z, const float *wre, unsigned int n) { \
+	float t1, t2, t3, t4, t5, t6; \
+	int o1 = 2 * n; \
+	int o2 = 4 * n; \
+	int o3 = 6 * n; \
+	const float *wim = wre + o1; \
+	\
+	TRANSFORM_ZERO(z[0], z[o1], z[o2], z[o3]); \
+	TRANSFORM(z[1], z[o1 + 1], z[o2 + 1], z[o3 + 1], wre[1], wim[-1]); \
+	TRANSFORM(z[2], z[o1 + 2], z[o2 + 2], z[o3 + 2], wre[2], wim[-2]); \
+	TRANSFORM(z[3], z[o1 + 3], z[o2 + 3], z[o3 + 3], wre[3], wim[-3]); \
+	for (int k = 4; k < o1; k += 4) \
+		transformFFT(z + k, wre + k, wim - k, o1, o2, o3); \
+}
+
+#else
+
 /* z[0...8n-1], w[1...2n-1] */
 #define PASS(name) \
 static void name(Complex *z, const float *wre, unsigned int n) { \
@@ -176,6 +299,8 @@ static void name(Complex *z, const float *wre, unsigned int n) { \
 	} while(--n);\
 }
 
+#endif
+
 PASS(pass)
 #undef BUTTERFLIES
 #define BUTTERFLIES BUTTERFLIES_BIG
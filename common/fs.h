@@ -25,6 +25,7 @@
 
 #include "common/array.h"
 #include "common/archive.h"
+#include "common/flat-hashmap.h"
 #include "common/hash-str.h"
 #include "common/hashmap.h"
 #include "common/ptr.h"
@@ -222,6 +223,18 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Get the size and the last modification time of the file referred by
+	 * this node, without opening it.
+	 *
+	 * The modification time is only meant to be compared with a value
+	 * retrieved earlier, to find out whether the file has changed.
+	 *
+	 * @return True if both values were retrieved. False if the node does not
+	 *         refer to an existing file, or if the backend does not support this.
+	 */
+	bool getFileStats(uint32 &size, uint32 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -231,6 +244,12 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Files can be opened from any thread, since every stream has its own
+	 * file handle.
+	 */
+	virtual bool isThreadSafe() const { return true; }
+
 	/**
 	 * Create a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -304,8 +323,9 @@ class FSDirectory : public Archive {
 	void setPrefix(const String &prefix);
 
 	// Caches are case insensitive, clashes are dealt with when creating
-	// Key is stored in lowercase.
-	typedef HashMap<String, FSNode, IgnoreCase_Hash, IgnoreCase_EqualTo> NodeCache;
+	// Key is stored in lowercase. They are only filled once, so pointers to
+	// their nodes stay valid.
+	typedef FlatHashMap<String, FSNode, IgnoreCase_Hash, IgnoreCase_EqualTo> NodeCache;
 	mutable NodeCache	_fileCache, _subDirCache;
 	mutable bool _cached;
 
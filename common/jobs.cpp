@@ -0,0 +1,243 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/jobs.h"
+#include "common/config-manager.h"
+
+namespace Common {
+
+JobSystem::JobSystem() : _numWorkers(0), _queues(nullptr), _queuedJobs(0), _stopping(0),
+	_numBackgroundThreads(0), _queuedBackgroundJobs(0) {
+}
+
+JobSystem::~JobSystem() {
+	delete[] _queues;
+}
+
+void JobSystem::setWorkerCount(uint numWorkers) {
+	assert(numWorkers <= kMaxWorkers);
+
+	delete[] _queues;
+	_queues = nullptr;
+	_numWorkers = numWorkers;
+
+	// Queue 0 is shared by all threads which are not worker threads
+	if (numWorkers > 0)
+		_queues = new JobQueue[numWorkers + 1];
+}
+
+void JobSystem::setBackgroundThreadCount(uint numThreads) {
+	assert(numThreads <= kBackgroundThreads);
+	_numBackgroundThreads = numThreads;
+}
+
+uint JobSystem::getConfiguredWorkerCount(uint cpuCount) {
+	int threads = cpuCount;
+	if (ConfMan.hasKey("job_threads") && ConfMan.getInt("job_threads") > 0)
+		threads = ConfMan.getInt("job_threads");
+
+	return CLIP<int>(threads - 1, 0, kMaxWorkers);
+}
+
+void JobSystem::lockQueue(JobQueue &queue) {
+	for (uint tries = 1;; ++tries) {
+		int32 expected = 0;
+		if (queue.lock.compareExchange(expected, 1))
+			return;
+
+		// The lock is only held for a few instructions, so if it is still
+		// taken after a while, its owner is most likely not running
+		if (tries % kSpinCount == 0)
+			yieldThread();
+	}
+}
+
+void JobSystem::run(JobGroup &group, JobProc proc, void *refCon) {
+	if (_numWorkers == 0) {
+		proc(refCon);
+		return;
+	}
+
+	group._pending.fetchAdd(1);
+
+	JobQueue &queue = _queues[getCurrentThreadIndex()];
+	lockQueue(queue);
+	if (queue.back - queue.front == kQueueSize) {
+		unlockQueue(queue);
+		const Job job = { proc, refCon, &group };
+		finishJob(job);
+		return;
+	}
+
+	Job &job = queue.jobs[queue.back % kQueueSize];
+	job.proc = proc;
+	job.refCon = refCon;
+	job.group = &group;
+	queue.back++;
+	_queuedJobs.fetchAdd(1);
+	unlockQueue(queue);
+
+	notifyWorkers();
+}
+
+void JobSystem::runInBackground(JobGroup &group, JobProc proc, void *refCon) {
+	if (_numBackgroundThreads == 0) {
+		proc(refCon);
+		return;
+	}
+
+	group._pending.fetchAdd(1);
+
+	lockQueue(_backgroundQueue);
+	if (_backgroundQueue.back - _backgroundQueue.front == kQueueSize) {
+		unlockQueue(_backgroundQueue);
+		const Job job = { proc, refCon, &group };
+		finishJob(job);
+		return;
+	}
+
+	Job &job = _backgroundQueue.jobs[_backgroundQueue.back % kQueueSize];
+	job.proc = proc;
+	job.refCon = refCon;
+	job.group = &group;
+	_backgroundQueue.back++;
+	_queuedBackgroundJobs.fetchAdd(1);
+	unlockQueue(_backgroundQueue);
+
+	notifyWorkers();
+}
+
+void JobSystem::wait(JobGroup &group) {
+	if (_numWorkers == 0 && _numBackgroundThreads == 0)
+		return;
+
+	const uint index = getCurrentThreadIndex();
+	uint idleTries = 0;
+	while (!group.isDone()) {
+		if (runQueuedJob(index)) {
+			idleTries = 0;
+		} else if (++idleTries == kSpinCount) {
+			// The remaining jobs of the group are running on other
+			// threads, so sleep until they are done or more jobs are queued
+			waitForWork(&group, false);
+			idleTries = 0;
+		}
+	}
+}
+
+bool JobSystem::runQueuedJob(uint index) {
+	if (_queuedJobs.load() <= 0)
+		return false;
+
+	Job job;
+
+	// Take the most recent job from our own queue, as its data is most
+	// likely still in the cache
+	JobQueue &ownQueue = _queues[index];
+	lockQueue(ownQueue);
+	if (ownQueue.back != ownQueue.front) {
+		ownQueue.back--;
+		job = ownQueue.jobs[ownQueue.back % kQueueSize];
+		_queuedJobs.fetchAdd(-1);
+		unlockQueue(ownQueue);
+		finishJob(job);
+		return true;
+	}
+	unlockQueue(ownQueue);
+
+	// Otherwise steal the oldest job from another queue
+	for (uint i = 1; i <= _numWorkers; ++i) {
+		JobQueue &queue = _queues[(index + i) % (_numWorkers + 1)];
+		lockQueue(queue);
+		if (queue.back != queue.front) {
+			job = queue.jobs[queue.front % kQueueSize];
+			queue.front++;
+			_queuedJobs.fetchAdd(-1);
+			unlockQueue(queue);
+			finishJob(job);
+			return true;
+		}
+		unlockQueue(queue);
+	}
+
+	return false;
+}
+
+bool JobSystem::runBackgroundJob() {
+	if (_queuedBackgroundJobs.load() <= 0)
+		return false;
+
+	lockQueue(_backgroundQueue);
+	if (_backgroundQueue.back == _backgroundQueue.front) {
+		unlockQueue(_backgroundQueue);
+		return false;
+	}
+
+	const Job job = _backgroundQueue.jobs[_backgroundQueue.front % kQueueSize];
+	_backgroundQueue.front++;
+	_queuedBackgroundJobs.fetchAdd(-1);
+	unlockQueue(_backgroundQueue);
+
+	finishJob(job);
+	return true;
+}
+
+void JobSystem::finishJob(const Job &job) {
+	job.proc(job.refCon);
+
+	// The group may be destroyed as soon as it is done, so it must not be
+	// accessed after this
+	if (job.group->_pending.fetchAdd(-1) == 1)
+		notifyWorkers();
+}
+
+void JobSystem::runWorker(uint index) {
+	uint idleTries = 0;
+	while (!_stopping.load()) {
+		if (runQueuedJob(index)) {
+			idleTries = 0;
+		} else if (++idleTries == kSpinCount) {
+			waitForWork(nullptr, false);
+			idleTries = 0;
+		}
+	}
+}
+
+void JobSystem::runBackgroundWorker() {
+	// Background jobs block on I/O anyway, so there is no point in spinning
+	// for more of them. They are all run before returning, since their
+	// groups may still be waited for.
+	for (;;) {
+		if (runBackgroundJob())
+			continue;
+		if (_stopping.load())
+			break;
+		waitForWork(nullptr, true);
+	}
+}
+
+void JobSystem::stopWorkers() {
+	_stopping.store(1);
+	notifyWorkers();
+}
+
+} // End of namespace Common
@@ -0,0 +1,333 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_JOBS_H
+#define COMMON_JOBS_H
+
+#include "common/atomic.h"
+#include "common/noncopyable.h"
+#include "common/util.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_jobs Job system
+ * @ingroup common
+ *
+ * @brief API for splitting work over several threads.
+ * @{
+ */
+
+class JobSystem;
+
+/** A job, called with the pointer passed to JobSystem::run(). */
+typedef void (*JobProc)(void *refCon);
+
+/**
+ * A set of jobs which are waited for together.
+ *
+ * Jobs are added to a group by JobSystem::run(), and JobSystem::wait()
+ * returns once all of them have finished. A group must not be destroyed
+ * while it still has unfinished jobs.
+ */
+class JobGroup : NonCopyable {
+	friend class JobSystem;
+
+	Atomic<int32> _pending;
+
+public:
+	JobGroup() : _pending(0) {}
+	~JobGroup() { assert(_pending.load() == 0); }
+
+	/** Return true if all jobs added to the group have finished. */
+	bool isDone() const { return _pending.load() == 0; }
+};
+
+/**
+ * Runs jobs on a pool of worker threads.
+ *
+ * Each thread has its own queue of jobs. Jobs queued by a worker thread go
+ * to the queue of that thread, which runs them last in, first out; idle
+ * threads steal jobs from the other end of the queues of the busy ones.
+ * Jobs queued by any other thread, such as the main thread, go to a shared
+ * queue. Threads waiting for a group of jobs run queued jobs in the
+ * meantime, so jobs may queue more jobs and wait for them. Threads with
+ * nothing to do only spin briefly before going to sleep until more jobs are
+ * queued or the group they wait for is done.
+ *
+ * This class on its own has no worker threads: every job then runs right
+ * away on the thread queueing it, in order. This is also what happens on
+ * backends without thread support, and when the user sets the job_threads
+ * config option to 1, which gives a deterministic order for debugging.
+ * Backends with thread support derive from this class; see
+ * OSystem::getJobSystem().
+ *
+ * Jobs may run in parallel with each other, so they must only share data
+ * which is either read-only or protected appropriately. Jobs should not
+ * call into OSystem, nor block waiting for something else than jobs.
+ * Jobs which block on I/O or take long, such as reading files or decoding
+ * video frames in advance, are queued with runInBackground() instead.
+ * They run on separate background threads, so they never delay the
+ * threads waiting for other jobs.
+ */
+class JobSystem : NonCopyable {
+public:
+	JobSystem();
+	virtual ~JobSystem();
+
+	/**
+	 * Return the number of threads which run jobs, including the thread
+	 * waiting for them. This is 1 if there are no worker threads.
+	 */
+	uint getThreadCount() const { return _numWorkers + 1; }
+
+	/**
+	 * Return true if jobs queued with runInBackground() run on background
+	 * threads, false if they run right away.
+	 */
+	bool hasBackgroundThreads() const { return _numBackgroundThreads > 0; }
+
+	/**
+	 * Queue a job as part of a group.
+	 *
+	 * Without worker threads, or if the queue is full, the job is run
+	 * right away instead.
+	 */
+	void run(JobGroup &group, JobProc proc, void *refCon);
+
+	/**
+	 * Queue a job which blocks or takes long as part of a group.
+	 *
+	 * The job runs on a background thread. Background jobs are started in
+	 * the order they were queued. They are never run by the threads
+	 * waiting in wait(),
+	 * so waiting for other jobs is never delayed by it. It may queue jobs
+	 * with run() and wait for them.
+	 *
+	 * Without background threads, or if the queue is full, the job is run
+	 * right away instead.
+	 */
+	void runInBackground(JobGroup &group, JobProc proc, void *refCon);
+
+	/**
+	 * Wait until all jobs of a group have finished, running queued jobs
+	 * in the meantime.
+	 */
+	void wait(JobGroup &group);
+
+	/**
+	 * Call @p func for consecutive subranges of [begin, end), in parallel.
+	 *
+	 * @p func is called with the bounds of each subrange, as in
+	 * func(uint rangeBegin, uint rangeEnd). All subranges have @p grainSize
+	 * elements, except for the last one. The function returns once all
+	 * subranges have been processed. Without worker threads, the subranges
+	 * are processed in order on the calling thread.
+	 */
+	template<class T>
+	void parallelFor(uint begin, uint end, uint grainSize, T &func);
+
+protected:
+	enum {
+		/** The maximum number of jobs in each queue. */
+		kQueueSize = 256,
+		/** The maximum number of worker threads. */
+		kMaxWorkers = 31,
+		/**
+		 * The number of background threads, so that a background job
+		 * blocking on I/O does not hold up all others.
+		 */
+		kBackgroundThreads = 2,
+		/**
+		 * How many times a thread retries before it yields its time slice
+		 * when a queue is locked, or goes to sleep when there is no job
+		 * to run.
+		 */
+		kSpinCount = 64
+	};
+
+	/**
+	 * Set up the queues for @p numWorkers worker threads. This must be
+	 * called by subclasses before starting the threads.
+	 */
+	void setWorkerCount(uint numWorkers);
+
+	/**
+	 * Set the number of background threads. This must be called by
+	 * subclasses before starting the threads.
+	 */
+	void setBackgroundThreadCount(uint numThreads);
+
+	/**
+	 * Return the number of worker threads to use on a machine with
+	 * @p cpuCount logical CPUs, taking the job_threads config option into
+	 * account.
+	 */
+	static uint getConfiguredWorkerCount(uint cpuCount);
+
+	/**
+	 * The body of the worker threads, where @p index is between 1 and the
+	 * number of worker threads. It returns once stopWorkers() is called.
+	 */
+	void runWorker(uint index);
+
+	/**
+	 * The body of the background threads. It returns once stopWorkers() is
+	 * called and all background jobs have run. Background threads are not
+	 * worker threads, so getCurrentThreadIndex() returns 0 for them.
+	 */
+	void runBackgroundWorker();
+
+	/** Make runWorker() and runBackgroundWorker() return in all threads. */
+	void stopWorkers();
+
+	/**
+	 * Return true if there are queued jobs or stopWorkers() was called, or
+	 * if @p group is not null and all its jobs have finished. If
+	 * @p background is true, only jobs queued with runInBackground() are
+	 * taken into account, otherwise only the other ones.
+	 */
+	bool hasWorkForWorkers(const JobGroup *group, bool background) const {
+		if (background)
+			return _queuedBackgroundJobs.load() > 0 || _stopping.load();
+		return _queuedJobs.load() > 0 || _stopping.load() || (group && group->isDone());
+	}
+
+	/**
+	 * Return the index of the calling thread, as passed to runWorker(), or
+	 * 0 if it is not a worker thread.
+	 */
+	virtual uint getCurrentThreadIndex() const { return 0; }
+
+	/**
+	 * Block the calling thread until hasWorkForWorkers(group, background)
+	 * may return true. Implementations must check it under the same lock
+	 * as used by notifyWorkers(), to not miss any wake up.
+	 */
+	virtual void waitForWork(const JobGroup *group, bool background) {}
+
+	/**
+	 * Wake up the threads blocked in waitForWork(). This is called when
+	 * jobs are queued and when the last job of a group has finished.
+	 */
+	virtual void notifyWorkers() {}
+
+	/** Give up the rest of the time slice of the calling thread. */
+	virtual void yieldThread() {}
+
+private:
+	struct Job {
+		JobProc proc;
+		void *refCon;
+		JobGroup *group;
+	};
+
+	/**
+	 * A queue of jobs, protected by a spin lock since it is only held for
+	 * a few instructions at a time. Threads which fail to take the lock
+	 * kSpinCount times in a row yield their time slice before retrying, in
+	 * case the owner of the lock was preempted. The owning thread takes
+	 * jobs from the back, other threads steal them from the front.
+	 */
+	struct JobQueue {
+		Atomic<int32> lock;
+		uint32 front;
+		uint32 back;
+		Job jobs[kQueueSize];
+
+		JobQueue() : lock(0), front(0), back(0) {}
+	};
+
+	void lockQueue(JobQueue &queue);
+	static void unlockQueue(JobQueue &queue) { queue.lock.store(0); }
+
+	bool runQueuedJob(uint index);
+	bool runBackgroundJob();
+	void finishJob(const Job &job);
+
+	template<class T>
+	struct ParallelForRange {
+		T &func;
+		const uint begin;
+		const uint end;
+		const uint grainSize;
+		const int32 numRanges;
+		Atomic<int32> nextRange;
+
+		ParallelForRange(T &f, uint b, uint e, uint g)
+			: func(f), begin(b), end(e), grainSize(g), numRanges((e - b + g - 1) / g), nextRange(0) {}
+
+		static void process(void *refCon) {
+			ParallelForRange *range = (ParallelForRange *)refCon;
+			for (;;) {
+				const int32 i = range->nextRange.fetchAdd(1);
+				if (i >= range->numRanges)
+					break;
+
+				const uint rangeBegin = range->begin + i * range->grainSize;
+				range->func(rangeBegin, MIN(rangeBegin + range->grainSize, range->end));
+			}
+		}
+	};
+
+	uint _numWorkers;
+	JobQueue *_queues;
+	Atomic<int32> _queuedJobs;
+	Atomic<int32> _stopping;
+
+	/** Jobs queued with runInBackground(), taken from the front only. */
+	uint _numBackgroundThreads;
+	JobQueue _backgroundQueue;
+	Atomic<int32> _queuedBackgroundJobs;
+};
+
+template<class T>
+void JobSystem::parallelFor(uint begin, uint end, uint grainSize, T &func) {
+	if (begin >= end)
+		return;
+	if (grainSize == 0)
+		grainSize = 1;
+
+	if (_numWorkers == 0 || end - begin <= grainSize) {
+		for (uint i = begin; i < end; i += grainSize)
+			func(i, MIN(i + grainSize, end));
+		return;
+	}
+
+	// Each job keeps taking the next subrange until none are left, so
+	// that the threads which are not busy with other jobs share the work.
+	ParallelForRange<T> range(func, begin, end, grainSize);
+	const uint helpers = MIN<uint>(_numWorkers, range.numRanges - 1);
+
+	JobGroup group;
+	for (uint i = 0; i < helpers; ++i)
+		run(group, &ParallelForRange<T>::process, &range);
+
+	ParallelForRange<T>::process(&range);
+	wait(group);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
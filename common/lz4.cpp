@@ -0,0 +1,188 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/lz4.h"
+#include "common/endian.h"
+#include "common/util.h"
+
+namespace Common {
+
+enum {
+	kLZ4MinMatch = 4,
+	/** The last bytes of a block are always literals. */
+	kLZ4LastLiterals = 5,
+	/** The last match has to start this many bytes before the end of a block. */
+	kLZ4MatchFindLimit = 12,
+	kLZ4MaxOffset = 65535,
+	kLZ4HashBits = 12
+};
+
+static inline uint32 hashLZ4(const byte *p) {
+	return (READ_UINT32(p) * 2654435761U) >> (32 - kLZ4HashBits);
+}
+
+static inline byte *writeLZ4Length(byte *dst, uint32 length) {
+	while (length >= 255) {
+		*dst++ = 255;
+		length -= 255;
+	}
+	*dst++ = length;
+	return dst;
+}
+
+static byte *writeLZ4Literals(byte *dst, byte *token, const byte *literals, uint32 length) {
+	*token = MIN<uint32>(length, 15) << 4;
+	if (length >= 15)
+		dst = writeLZ4Length(dst, length - 15);
+
+	memcpy(dst, literals, length);
+	return dst + length;
+}
+
+uint32 compressLZ4(const byte *src, uint32 srcSize, byte *dst, uint32 dstCapacity) {
+	if (dstCapacity < getLZ4CompressBound(srcSize))
+		return 0;
+
+	const byte *ip = src;
+	const byte *anchor = src;
+	const byte *end = src + srcSize;
+	byte *op = dst;
+
+	if (srcSize > kLZ4MatchFindLimit) {
+		// Positions of the last occurrence of each hashed sequence of four
+		// bytes. Unused entries point to the start of the data, candidates
+		// are always checked anyway.
+		uint32 table[1 << kLZ4HashBits];
+		memset(table, 0, sizeof(table));
+
+		const byte *matchLimit = end - kLZ4LastLiterals;
+		const byte *ipLimit = end - kLZ4MatchFindLimit;
+
+		while (ip <= ipLimit) {
+			const uint32 hash = hashLZ4(ip);
+			const byte *ref = src + table[hash];
+			table[hash] = ip - src;
+
+			if (ref >= ip || ip - ref > kLZ4MaxOffset || READ_UINT32(ref) != READ_UINT32(ip)) {
+				// Skip ahead faster in data which does not compress
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			const uint32 offset = ip - ref;
+			const byte *matchEnd = ip + kLZ4MinMatch;
+			ref += kLZ4MinMatch;
+			while (matchEnd < matchLimit && *matchEnd == *ref) {
+				matchEnd++;
+				ref++;
+			}
+
+			byte *token = op++;
+			op = writeLZ4Literals(op, token, anchor, ip - anchor);
+
+			WRITE_LE_UINT16(op, offset);
+			op += 2;
+
+			const uint32 matchLength = matchEnd - ip - kLZ4MinMatch;
+			*token |= MIN<uint32>(matchLength, 15);
+			if (matchLength >= 15)
+				op = writeLZ4Length(op, matchLength - 15);
+
+			ip = anchor = matchEnd;
+		}
+	}
+
+	// The block ends with a sequence without a match
+	byte *token = op++;
+	op = writeLZ4Literals(op, token, anchor, end - anchor);
+
+	return op - dst;
+}
+
+static inline bool readLZ4Length(const byte *&src, const byte *srcEnd, uint32 &length) {
+	byte value;
+	do {
+		if (src >= srcEnd)
+			return false;
+		value = *src++;
+		length += value;
+	} while (value == 255);
+
+	return true;
+}
+
+bool decompressLZ4(const byte *src, uint32 srcSize, byte *dst, uint32 dstSize) {
+	const byte *ip = src;
+	const byte *ipEnd = src + srcSize;
+	byte *op = dst;
+	byte *opEnd = dst + dstSize;
+
+	while (ip < ipEnd) {
+		const byte token = *ip++;
+
+		uint32 literalLength = token >> 4;
+		if (literalLength == 15 && !readLZ4Length(ip, ipEnd, literalLength))
+			return false;
+
+		if (literalLength > (uint32)(ipEnd - ip) || literalLength > (uint32)(opEnd - op))
+			return false;
+
+		memcpy(op, ip, literalLength);
+		ip += literalLength;
+		op += literalLength;
+
+		// The last sequence has no match
+		if (ip == ipEnd)
+			break;
+
+		if (ipEnd - ip < 2)
+			return false;
+
+		const uint32 offset = READ_LE_UINT16(ip);
+		ip += 2;
+
+		if (offset == 0 || offset > (uint32)(op - dst))
+			return false;
+
+		uint32 matchLength = token & 15;
+		if (matchLength == 15 && !readLZ4Length(ip, ipEnd, matchLength))
+			return false;
+		matchLength += kLZ4MinMatch;
+
+		if (matchLength > (uint32)(opEnd - op))
+			return false;
+
+		// Matches may overlap with the data they produce
+		const byte *ref = op - offset;
+		if (offset >= matchLength) {
+			memcpy(op, ref, matchLength);
+			op += matchLength;
+		} else {
+			while (matchLength--)
+				*op++ = *ref++;
+		}
+	}
+
+	return op == opEnd;
+}
+
+} // End of namespace Common
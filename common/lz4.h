@@ -0,0 +1,81 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_LZ4_H
+#define COMMON_LZ4_H
+
+#include "common/scummsys.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_lz4 LZ4 compression
+ * @ingroup common
+ *
+ * @brief  Compression and decompression of LZ4 blocks.
+ *
+ * @details LZ4 trades compression ratio for speed, which makes it suitable for
+ *          keeping data compressed in memory. Only the block format is
+ *          supported, without the frame format headers.
+ *          Used in engines:
+ *          - SCI
+ * @{
+ */
+
+/**
+ * Return the size of the buffer which compressLZ4() needs to be able to
+ * compress @p size bytes, even if the data cannot be compressed.
+ */
+inline uint32 getLZ4CompressBound(uint32 size) {
+	return size + size / 255 + 16;
+}
+
+/**
+ * Compress a block of data into the LZ4 block format.
+ *
+ * @param src          The data to compress.
+ * @param srcSize      The size of the data to compress.
+ * @param dst          The buffer receiving the compressed data.
+ * @param dstCapacity  The size of @p dst, at least getLZ4CompressBound(srcSize).
+ *
+ * @return The size of the compressed data, or 0 if @p dst is too small.
+ */
+uint32 compressLZ4(const byte *src, uint32 srcSize, byte *dst, uint32 dstCapacity);
+
+/**
+ * Decompress a block in the LZ4 block format. Invalid data is detected, and
+ * never causes reads or writes outside of the buffers.
+ *
+ * @param src      The compressed data.
+ * @param srcSize  The size of the compressed data.
+ * @param dst      The buffer receiving the decompressed data.
+ * @param dstSize  The exact size of the decompressed data.
+ *
+ * @return True if the data was decompressed successfully.
+ */
+bool decompressLZ4(const byte *src, uint32 srcSize, byte *dst, uint32 dstSize);
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
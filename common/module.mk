@@ -17,9 +17,11 @@ MODULE_OBJS := \
 	iff_container.o \
 	ini-file.o \
 	installshield_cab.o \
+	jobs.o \
 	json.o \
 	language.o \
 	localization.o \
+	lz4.o \
 	macresman.o \
 	memorypool.o \
 	md5.o \
@@ -261,6 +261,15 @@ bool SeekableSubReadStream::seek(int32 offset, int whence) {
 	return ret;
 }
 
+const byte *SeekableSubReadStream::getRawData() const {
+	// The range may extend beyond the end of the parent stream
+	const byte *data = _parentStream->getRawData();
+	if (!data || _end > (uint32)_parentStream->size())
+		return nullptr;
+
+	return data + _begin;
+}
+
 uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	// Make sure the parent stream is at the right position
 	seek(0, SEEK_CUR);
@@ -711,6 +711,20 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Return a pointer to the whole contents of the stream, if they are
+	 * directly accessible in memory, for example because the stream wraps
+	 * a memory buffer or a memory-mapped file.
+	 *
+	 * This allows reading the data without copying it. The pointer remains
+	 * valid for as long as the stream exists, and is not affected by seeking
+	 * or reading.
+	 *
+	 * @return Pointer to size() bytes, or nullptr if the contents are not
+	 *         available in memory.
+	 */
+	virtual const byte *getRawData() const { return nullptr; }
+
 	/**
 	 * Read at most one less than the number of characters specified
 	 * by @p bufSize from the stream and store them in the string buffer.
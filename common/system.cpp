@@ -25,6 +25,7 @@
 #include "common/system.h"
 #include "common/events.h"
 #include "common/fs.h"
+#include "common/jobs.h"
 #include "common/savefile.h"
 #include "common/str.h"
 #include "common/taskbar.h"
@@ -44,6 +45,7 @@ OSystem::OSystem() {
 	_eventManager = nullptr;
 	_timerManager = nullptr;
 	_savefileManager = nullptr;
+	_jobSystem = nullptr;
 #if defined(USE_TASKBAR)
 	_taskbarManager = nullptr;
 #endif
@@ -61,6 +63,10 @@ OSystem::OSystem() {
 }
 
 OSystem::~OSystem() {
+	// Stop the worker threads first, as they may still be running jobs
+	delete _jobSystem;
+	_jobSystem = nullptr;
+
 	delete _audiocdManager;
 	_audiocdManager = nullptr;
 
@@ -118,6 +124,9 @@ void OSystem::initBackend() {
 // 	if (!_fsFactory)
 // 		error("Backend failed to instantiate fs factory");
 
+	if (!_jobSystem)
+		_jobSystem = new Common::JobSystem();
+
 	_backendInitialized = true;
 }
 
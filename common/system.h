@@ -67,6 +67,7 @@ class TimerManager;
 class SeekableReadStream;
 class WriteStream;
 class HardwareInputSet;
+class JobSystem;
 class Keymap;
 class KeymapperDefaultBindings;
 class Encoding;
@@ -199,6 +200,15 @@ protected:
 	 */
 	Common::SaveFileManager *_savefileManager;
 
+	/**
+	 * No default value is provided for _jobSystem by OSystem.
+	 * However, OSystem::initBackend() sets a job system without worker
+	 * threads if none has been set before.
+	 *
+	 * @note _jobSystem is deleted by the OSystem destructor.
+	 */
+	Common::JobSystem *_jobSystem;
+
 #if defined(USE_TASKBAR)
 	/**
 	 * No default value is provided for _taskbarManager by OSystem.
@@ -1316,6 +1326,15 @@ public:
 	 */
 	virtual Common::TimerManager *getTimerManager();
 
+	/**
+	 * Return the job system singleton, used to run work on several threads.
+	 *
+	 * For more information, see @ref common_jobs.
+	 */
+	inline Common::JobSystem *getJobSystem() {
+		return _jobSystem;
+	}
+
 	/**
 	 * Return the event manager singleton.
 	 *
@@ -105,9 +105,10 @@ typedef struct {
 
 #include "common/fs.h"
 #include "common/unzip.h"
-#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
 
-#include "common/hashmap.h"
+#include "common/flat-hashmap.h"
 #include "common/hash-str.h"
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
@@ -375,13 +376,15 @@ typedef struct {
 	unz_file_info_internal cur_file_info_internal;	/* private info about it*/
 } cached_file_in_zip;
 
-typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
+typedef Common::FlatHashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
 	Common::IgnoreCase_EqualTo> ZipHash;
 
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamRef;	/* owns _stream, shared with
+																the member streams */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -544,6 +547,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamRef = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -595,7 +599,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -644,7 +647,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != nullptr)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -1034,6 +1036,28 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s* s, uInt* piSizeVar,
 	return err;
 }
 
+/*
+  Get the position of the data of the current file in the zipfile, after
+    checking its local header.
+  return UNZ_OK if there is no problem.
+*/
+static int unzlocal_GetCurrentFileDataOffset(unz_s* s, uLong *poffset) {
+	uInt iSizeVar;
+	uLong offset_local_extrafield;
+	uInt  size_local_extrafield;
+
+	if (!s->current_file_ok)
+		return UNZ_PARAMERROR;
+
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s,&iSizeVar,
+				&offset_local_extrafield,&size_local_extrafield)!=UNZ_OK)
+		return UNZ_BADZIPFILE;
+
+	*poffset = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER +
+				iSizeVar + s->byte_before_the_zipfile;
+	return UNZ_OK;
+}
+
 /*
   Open for reading data the current file in the zipfile.
   If there is no error and the file is opened, the return value is UNZ_OK.
@@ -1485,36 +1509,333 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 	return ArchiveMemberPtr(new GenericArchiveMember(name, this));
 }
 
+/**
+ * A stream for a stored member of a ZIP archive, which also keeps the
+ * archive stream alive.
+ */
+class ZipSubReadStream : public SafeSeekableSubReadStream {
+public:
+	ZipSubReadStream(const SharedPtr<SeekableReadStream> &parentStream, uint32 begin, uint32 end)
+		: SafeSeekableSubReadStream(parentStream.get(), begin, end, DisposeAfterUse::NO),
+		  _parentRef(parentStream) {
+	}
+
+private:
+	SharedPtr<SeekableReadStream> _parentRef;
+};
+
+#ifdef USE_ZLIB
+
+/**
+ * A stream which inflates a deflated member of a ZIP archive on demand.
+ *
+ * Only the data actually requested is decompressed. While going forward
+ * through the member, restart points are recorded at deflate block
+ * boundaries roughly every kRestartInterval bytes, each one holding the
+ * bit position in the compressed data and the last 32 KB of output. Seeking
+ * resumes inflating from the closest restart point before the target, so
+ * random access costs at most kRestartInterval bytes of decompression once
+ * the member has been read through.
+ */
+class ZipInflateStream : public SeekableReadStream {
+public:
+	ZipInflateStream(const SharedPtr<SeekableReadStream> &parentStream, uint32 dataStart,
+	                 uint32 compressedSize, uint32 uncompressedSize, uint32 crc);
+	~ZipInflateStream();
+
+	bool init();
+
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _eos = false; }
+	virtual bool eos() const { return _eos; }
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize);
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	enum {
+		kInputBufferSize = 4096,
+		kWindowSize = 32768,			///< Maximum deflate back-reference distance
+		kRestartInterval = 1024 * 1024
+	};
+
+	struct RestartPoint {
+		uint32 outPos;		///< Position in the uncompressed data
+		uint32 inPos;		///< Offset of the first byte not fully consumed yet
+		int bits;			///< Number of bits of the byte before inPos still to be used
+		byte *window;		///< The kWindowSize bytes of output before outPos
+	};
+
+	bool restart(const RestartPoint *point);
+	void addRestartPoint();
+	uint32 inflateTo(byte *dst, uint32 len);
+
+	SharedPtr<SeekableReadStream> _parentStream;
+	const uint32 _dataStart;
+	const uint32 _compressedSize;
+	const uint32 _size;
+	const uint32 _crc;
+
+	z_stream _zStream;
+	bool _zStreamInitialized;
+	byte _inBuffer[kInputBufferSize];
+	uint32 _inPos;			///< Bytes of compressed data read into _inBuffer so far
+	byte *_window;			///< Ring buffer with the most recent output
+	uint32 _windowPos;
+	uint32 _outPos;			///< Bytes of uncompressed data produced so far
+
+	uint32 _crcData;
+	bool _crcValid;			///< Whether _crcData covers all the output from the start
+
+	Array<RestartPoint> _restartPoints;
+
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+};
+
+ZipInflateStream::ZipInflateStream(const SharedPtr<SeekableReadStream> &parentStream, uint32 dataStart,
+                                   uint32 compressedSize, uint32 uncompressedSize, uint32 crc)
+	: _parentStream(parentStream), _dataStart(dataStart), _compressedSize(compressedSize),
+	  _size(uncompressedSize), _crc(crc), _zStream(), _zStreamInitialized(false), _inPos(0),
+	  _window(nullptr), _windowPos(0), _outPos(0), _crcData(0), _crcValid(true),
+	  _pos(0), _eos(false), _err(false) {
+}
+
+ZipInflateStream::~ZipInflateStream() {
+	if (_zStreamInitialized)
+		inflateEnd(&_zStream);
+
+	for (uint i = 0; i < _restartPoints.size(); ++i)
+		free(_restartPoints[i].window);
+	free(_window);
+}
+
+bool ZipInflateStream::init() {
+	_window = (byte *)malloc(kWindowSize);
+	if (!_window)
+		return false;
+
+	// windowBits is passed < 0 to tell that there is no zlib header.
+	if (inflateInit2(&_zStream, -MAX_WBITS) != Z_OK)
+		return false;
+
+	_zStreamInitialized = true;
+	return true;
+}
+
+bool ZipInflateStream::restart(const RestartPoint *point) {
+	if (inflateReset(&_zStream) != Z_OK)
+		return false;
+
+	_zStream.avail_in = 0;
+	_windowPos = 0;
+
+	if (!point) {
+		_inPos = 0;
+		_outPos = 0;
+		_crcData = 0;
+		_crcValid = true;
+		return true;
+	}
+
+	_inPos = point->inPos;
+	_outPos = point->outPos;
+	_crcValid = false;
+
+	if (point->bits) {
+		_parentStream->seek(_dataStart + _inPos - 1, SEEK_SET);
+		const byte partial = _parentStream->readByte();
+		if (_parentStream->err() || _parentStream->eos())
+			return false;
+		inflatePrime(&_zStream, point->bits, partial >> (8 - point->bits));
+	}
+
+	// The window is stored oldest byte first, so with _windowPos at 0 it
+	// continues where it left off.
+	memcpy(_window, point->window, kWindowSize);
+	return inflateSetDictionary(&_zStream, _window, kWindowSize) == Z_OK;
+}
+
+void ZipInflateStream::addRestartPoint() {
+	RestartPoint point;
+	point.outPos = _outPos;
+	point.inPos = _inPos - _zStream.avail_in;
+	point.bits = _zStream.data_type & 7;
+	point.window = (byte *)malloc(kWindowSize);
+	if (!point.window)
+		return;
+
+	memcpy(point.window, _window + _windowPos, kWindowSize - _windowPos);
+	memcpy(point.window + kWindowSize - _windowPos, _window, _windowPos);
+	_restartPoints.push_back(point);
+}
+
+uint32 ZipInflateStream::inflateTo(byte *dst, uint32 len) {
+	uint32 produced = 0;
+
+	while (produced < len && !_err) {
+		if (_zStream.avail_in == 0) {
+			const uint32 readThis = MIN<uint32>(kInputBufferSize, _compressedSize - _inPos);
+			if (readThis == 0) {
+				// The compressed data ended before the expected amount of output.
+				_err = true;
+				break;
+			}
+
+			_parentStream->seek(_dataStart + _inPos, SEEK_SET);
+			if (_parentStream->read(_inBuffer, readThis) != readThis) {
+				_err = true;
+				break;
+			}
+
+			_inPos += readThis;
+			_zStream.next_in = _inBuffer;
+			_zStream.avail_in = readThis;
+		}
+
+		const uint32 chunk = MIN<uint32>(len - produced, kWindowSize - _windowPos);
+		_zStream.next_out = _window + _windowPos;
+		_zStream.avail_out = chunk;
+
+		// Z_BLOCK makes inflate() stop at the end of each deflate block, the
+		// only places where it can later be restarted.
+		const int ret = inflate(&_zStream, Z_BLOCK);
+		const uint32 out = chunk - _zStream.avail_out;
+
+		if (dst)
+			memcpy(dst + produced, _window + _windowPos, out);
+		if (_crcValid)
+			_crcData = crc32(_crcData, _window + _windowPos, out);
+
+		_windowPos = (_windowPos + out) & (kWindowSize - 1);
+		_outPos += out;
+		produced += out;
+
+		if (ret == Z_STREAM_END)
+			break;
+		if (ret != Z_OK && ret != Z_BUF_ERROR) {
+			_err = true;
+			break;
+		}
+
+		// Bit 7 of data_type is set at the end of a block, bit 6 if it was
+		// the last block.
+		if ((_zStream.data_type & 128) && !(_zStream.data_type & 64) && _outPos < _size) {
+			const uint32 lastPoint = _restartPoints.empty() ? 0 : _restartPoints.back().outPos;
+			if (_outPos >= lastPoint + kRestartInterval)
+				addRestartPoint();
+		}
+	}
+
+	if (_outPos == _size && _crcValid && _crcData != _crc) {
+		warning("ZipInflateStream: CRC mismatch");
+		_err = true;
+	}
+
+	return produced;
+}
+
+uint32 ZipInflateStream::read(void *dataPtr, uint32 dataSize) {
+	if (_err)
+		return 0;
+
+	if (_pos >= _size) {
+		_eos = true;
+		return 0;
+	}
+
+	// Go back to an earlier position, or jump ahead, using the closest
+	// restart point before the requested position.
+	const RestartPoint *point = nullptr;
+	for (uint i = 0; i < _restartPoints.size() && _restartPoints[i].outPos <= _pos; ++i)
+		point = &_restartPoints[i];
+
+	if (_pos < _outPos || (point && point->outPos > _outPos)) {
+		if (!restart(point)) {
+			_err = true;
+			return 0;
+		}
+	}
+
+	if (_pos > _outPos)
+		inflateTo(nullptr, _pos - _outPos);
+
+	if (_pos != _outPos)
+		return 0;
+
+	const uint32 toRead = MIN<uint32>(dataSize, _size - _pos);
+	const uint32 done = inflateTo((byte *)dataPtr, toRead);
+	_pos += done;
+
+	if (done < dataSize)
+		_eos = true;
+
+	return done;
+}
+
+bool ZipInflateStream::seek(int32 offset, int whence) {
+	int32 newPos = 0;
+	switch (whence) {
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	case SEEK_SET:
+	default:
+		newPos = offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	}
+
+	if (newPos < 0 || (uint32)newPos > _size)
+		return false;
+
+	// The data is only inflated once it is actually read.
+	_pos = newPos;
+	_eos = false;
+	return true;
+}
+
+#endif // USE_ZLIB
+
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return nullptr;
 
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
-		return nullptr;
+	unz_s *const archive = (unz_s *)_zipFile;
+	const unz_file_info &fileInfo = archive->cur_file_info;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
+	uLong dataStart;
+	if (unzlocal_GetCurrentFileDataOffset(archive, &dataStart) != UNZ_OK)
 		return nullptr;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
-
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
-		return nullptr;
+	// The member streams read straight from the archive stream, seeking it
+	// before every read, so that several members can be used independently.
+	// They keep a reference to it, so they may also outlive the archive.
+	if (fileInfo.compression_method == 0) {
+		return new ZipSubReadStream(archive->_streamRef, dataStart,
+			dataStart + fileInfo.uncompressed_size);
 	}
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
-		free(buffer);
-		return nullptr;
+#ifdef USE_ZLIB
+	if (fileInfo.compression_method == Z_DEFLATED) {
+		ZipInflateStream *stream = new ZipInflateStream(archive->_streamRef, dataStart,
+			fileInfo.compressed_size, fileInfo.uncompressed_size, fileInfo.crc);
+		if (!stream->init()) {
+			delete stream;
+			return nullptr;
+		}
+		return stream;
 	}
+#endif
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	// Unsupported compression method, or deflate without zlib.
+	return nullptr;
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -342,6 +342,14 @@ public:
 	 */
 	DetectedGames detectGames(const Common::FSList &fslist) const override;
 
+	/**
+	 * The generic detection is thread-safe. Engines whose fallbackDetect()
+	 * uses global state must override this and return false.
+	 */
+	bool isDetectionThreadSafe() const override {
+		return true;
+	}
+
 	/**
 	 * A generic createInstance.
 	 *
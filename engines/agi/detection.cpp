@@ -152,6 +152,11 @@ public:
 		return "Sierra AGI Engine (C) Sierra On-Line Software";
 	}
 
+	// The fallback detector writes g_fallbackDesc and logs through g_system
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override;
 };
 
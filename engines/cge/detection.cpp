@@ -123,6 +123,11 @@ public:
 		return "Soltys (C) 1994-1996 L.K. Avalon";
 	}
 
+	// The fallback detector uses SearchMan
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override;
 };
 
@@ -115,6 +115,11 @@ public:
 		return "Sfinx (C) 1994-1997 Janusz B. Wisniewski and L.K. Avalon";
 	}
 
+	// The fallback detector uses SearchMan
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override;
 };
 
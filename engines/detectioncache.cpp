@@ -0,0 +1,170 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectioncache.h"
+#include "engines/game.h"
+
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+static const char *const kCacheFileName = "detection.cache";
+static const char *const kCacheHeader = "SCUMMVM_DETECTION_CACHE 1";
+
+DetectionCache::DetectionCache() : _loaded(false), _dirty(false) {
+}
+
+Common::String DetectionCache::makeKey(const Common::FSNode &node, uint md5Bytes) {
+	return Common::String::format("%u %s", md5Bytes, node.getPath().c_str());
+}
+
+void DetectionCache::load() {
+	_loaded = true;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	Common::InSaveFile *file = saveFileMan->openForLoading(kCacheFileName);
+	if (!file)
+		return;
+
+	if (file->readLine() != kCacheHeader) {
+		debug(2, "DetectionCache: Ignoring cache with unknown format");
+		delete file;
+		return;
+	}
+
+	// Each line holds: size modificationTime md5Bytes md5 path
+	while (!file->eos() && !file->err()) {
+		Common::String line = file->readLine();
+		if (line.empty())
+			continue;
+
+		uint size, modificationTime, md5Bytes;
+		char md5[33];
+		int pathOffset = 0;
+		if (sscanf(line.c_str(), "%u %u %u %32s %n", &size, &modificationTime, &md5Bytes, md5, &pathOffset) != 4 || !pathOffset) {
+			debug(2, "DetectionCache: Skipping malformed line '%s'", line.c_str());
+			continue;
+		}
+
+		Entry entry;
+		entry.size = size;
+		entry.modificationTime = modificationTime;
+		entry.md5 = md5;
+		_entries[Common::String::format("%u %s", md5Bytes, line.c_str() + pathOffset)] = entry;
+	}
+
+	delete file;
+	debug(2, "DetectionCache: Loaded %u entries", _entries.size());
+}
+
+bool DetectionCache::getFileProperties(const Common::FSNode &node, uint md5Bytes, FileProperties &fileProps) {
+	Common::StackLock lock(_mutex);
+	if (!_loaded)
+		load();
+
+	EntryMap::const_iterator i = _entries.find(makeKey(node, md5Bytes));
+	if (i == _entries.end())
+		return false;
+
+	uint32 size, modificationTime;
+	if (!node.getFileStats(size, modificationTime))
+		return false;
+
+	if (i->_value.size != size || i->_value.modificationTime != modificationTime)
+		return false;
+
+	fileProps.size = size;
+	fileProps.md5 = Common::String(i->_value.md5.c_str());
+	return true;
+}
+
+void DetectionCache::setFileProperties(const Common::FSNode &node, uint md5Bytes, const FileProperties &fileProps) {
+	Common::StackLock lock(_mutex);
+	if (!_loaded)
+		load();
+
+	Entry entry;
+	if (!node.getFileStats(entry.size, entry.modificationTime))
+		return;
+
+	// The file changed while it was being hashed
+	if ((int32)entry.size != fileProps.size)
+		return;
+
+	entry.md5 = Common::String(fileProps.md5.c_str());
+	_entries[makeKey(node, md5Bytes)] = entry;
+	_dirty = true;
+}
+
+void DetectionCache::clear() {
+	Common::StackLock lock(_mutex);
+	_entries.clear();
+	_loaded = true;
+	_dirty = false;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (saveFileMan)
+		saveFileMan->removeSavefile(kCacheFileName);
+}
+
+void DetectionCache::flush() {
+	Common::StackLock lock(_mutex);
+	if (!_dirty)
+		return;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	if (!saveFileMan)
+		return;
+
+	Common::OutSaveFile *file = saveFileMan->openForSaving(kCacheFileName, false);
+	if (!file) {
+		warning("DetectionCache: Could not write '%s'", kCacheFileName);
+		return;
+	}
+
+	file->writeString(kCacheHeader);
+	file->writeByte('\n');
+
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		// The key is "md5Bytes path"
+		const char *key = i->_key.c_str();
+		const char *path = strchr(key, ' ') + 1;
+		file->writeString(Common::String::format("%u %u %u %s %s\n", i->_value.size, i->_value.modificationTime,
+		                                         (uint)atoi(key), i->_value.md5.c_str(), path));
+	}
+
+	file->finalize();
+	if (file->err())
+		warning("DetectionCache: Could not write '%s'", kCacheFileName);
+	else
+		_dirty = false;
+
+	delete file;
+}
@@ -0,0 +1,102 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+class FSNode;
+}
+
+struct FileProperties;
+
+/**
+ * A persistent cache of the file sizes and MD5 checksums computed while
+ * detecting games.
+ *
+ * The entries are keyed by the path of the file and the number of bytes
+ * hashed. An entry is only used as long as the size and the modification
+ * time of the file are unchanged; files whose modification time is not
+ * known to the backend are never cached.
+ *
+ * The cache is kept in the savefile directory. It can be rebuilt from
+ * scratch with the --rebuild-detection-cache command line option.
+ *
+ * The cache may be used by detectors running on several threads at once.
+ * The strings stored in it are not shared with the callers, since the
+ * reference counts of shared strings are not thread safe.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	/**
+	 * Look up the properties of a file.
+	 *
+	 * @return True if @p fileProps was filled from a valid cache entry.
+	 */
+	bool getFileProperties(const Common::FSNode &node, uint md5Bytes, FileProperties &fileProps);
+
+	/**
+	 * Store the freshly computed properties of a file.
+	 */
+	void setFileProperties(const Common::FSNode &node, uint md5Bytes, const FileProperties &fileProps);
+
+	/**
+	 * Discard all entries, including the ones on disk.
+	 */
+	void clear();
+
+	/**
+	 * Write the cache to disk if it has been modified.
+	 */
+	void flush();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+
+	struct Entry {
+		uint32 size;
+		uint32 modificationTime;
+		Common::String md5;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	static Common::String makeKey(const Common::FSNode &node, uint md5Bytes);
+	void load();
+
+	Common::Mutex _mutex;
+	EntryMap _entries;
+	bool _loaded;
+	bool _dirty;
+};
+
+/** Shortcut for accessing the detection cache. */
+#define DetectionCacheMan DetectionCache::instance()
+
+#endif
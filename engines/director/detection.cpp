@@ -202,6 +202,11 @@ public:
 		return "Macromedia Director (C) 1990-1995 Macromedia";
 	}
 
+	// The fallback detector writes s_fallbackDesc and opens files with Common::File
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override;
 };
 
@@ -38,6 +38,11 @@ public:
 	const char *getName() const override;
 	const char *getOriginalCopyright() const override;
 
+	// The fallback detector uses SearchMan
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override;
 
 private:
@@ -21,9 +21,11 @@
  */
 
 #include "common/config-manager.h"
+#include "common/system.h"
 #include "graphics/renderer.h"
 
 #include "engines/grim/debugger.h"
+#include "engines/grim/gfx_base.h"
 #include "engines/grim/md5check.h"
 #include "engines/grim/grim.h"
 
@@ -38,6 +40,7 @@ Debugger::Debugger() :
 	registerCmd("set_renderer", WRAP_METHOD(Debugger, cmd_set_renderer));
 	registerCmd("save", WRAP_METHOD(Debugger, cmd_save));
 	registerCmd("load", WRAP_METHOD(Debugger, cmd_load));
+	registerCmd("benchmark", WRAP_METHOD(Debugger, cmd_benchmark));
 }
 
 Debugger::~Debugger() {
@@ -127,4 +130,28 @@ bool Debugger::cmd_load(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmd_benchmark(int argc, const char **argv) {
+	if (argc < 2) {
+		debugPrintf("Usage: benchmark <frames>\n");
+		debugPrintf("Renders the current scene <frames> times without advancing the game and prints the frame rate\n");
+		return true;
+	}
+
+	int frames = atoi(argv[1]);
+	if (frames <= 0) {
+		debugPrintf("Invalid frame count '%s'\n", argv[1]);
+		return true;
+	}
+
+	uint32 startTime = g_system->getMillis();
+	for (int i = 0; i < frames; i++) {
+		g_grim->updateDisplayScene();
+		g_grim->doFlip();
+	}
+	uint32 elapsed = MAX<uint32>(g_system->getMillis() - startTime, 1);
+
+	debugPrintf("Rendered %d frames with the %s in %u ms (%.2f fps)\n", frames, g_driver->getVideoDeviceName(), elapsed, frames * 1000.0 / elapsed);
+	return true;
+}
+
 }
@@ -52,6 +52,11 @@ public:
 		return "MADE Engine (C) Activision";
 	}
 
+	// The fallback detector writes g_fallbackDesc
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override;
 };
 
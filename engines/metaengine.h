@@ -145,6 +145,18 @@ public:
 	 */
 	virtual DetectedGames detectGames(const Common::FSList &fslist) const = 0;
 
+	/**
+	 * Return whether detectGames() may run on a worker thread, at the same
+	 * time as the detectors of other engines.
+	 *
+	 * Detectors which use global state, such as SearchMan, ConfMan or static
+	 * variables, must return false. They are then always run on the main
+	 * thread. This is the default, as custom detectors often do so.
+	 */
+	virtual bool isDetectionThreadSafe() const {
+		return false;
+	}
+
 	/**
 	 * Return a list of extra GUI options for the specified target.
 	 *
@@ -519,6 +531,15 @@ public:
 	 */
 	DetectionResults detectGames(const Common::FSList &fslist) const;
 
+	/**
+	 * Run the detector of a single engine plugin on a list of FSNodes in a
+	 * given directory.
+	 *
+	 * This allows spreading the detection of a directory over several steps.
+	 * Unlike detectGames(), this does not save the detection cache.
+	 */
+	DetectedGames detectGames(const Plugin *plugin, const Common::FSList &fslist) const;
+
 	/** Find a plugin by its engine ID. */
 	const Plugin *findPlugin(const Common::String &engineId) const;
 
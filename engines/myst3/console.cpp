@@ -25,10 +25,13 @@
 #include "engines/myst3/archive.h"
 #include "engines/myst3/database.h"
 #include "engines/myst3/effects.h"
+#include "engines/myst3/gfx.h"
 #include "engines/myst3/inventory.h"
 #include "engines/myst3/script.h"
 #include "engines/myst3/state.h"
 
+#include "video/bink_decoder.h"
+
 namespace Myst3 {
 
 Console::Console(Myst3Engine *vm) : GUI::Debugger(), _vm(vm) {
@@ -44,6 +47,7 @@ Console::Console(Myst3Engine *vm) : GUI::Debugger(), _vm(vm) {
 	registerCmd("fillInventory",			WRAP_METHOD(Console, Cmd_FillInventory));
 	registerCmd("dumpArchive",			WRAP_METHOD(Console, Cmd_DumpArchive));
 	registerCmd("dumpMasks",			WRAP_METHOD(Console, Cmd_DumpMasks));
+	registerCmd("benchmarkMovie",			WRAP_METHOD(Console, Cmd_BenchmarkMovie));
 }
 
 Console::~Console() {
@@ -327,6 +331,48 @@ bool Console::Cmd_FillInventory(int argc, const char **argv) {
 	return false;
 }
 
+bool Console::Cmd_BenchmarkMovie(int argc, const char **argv) {
+	if (argc != 2) {
+		debugPrintf("Decode all the frames of a movie without displaying them, and print the decoding speed\n");
+		debugPrintf("Usage :\n");
+		debugPrintf("benchmarkMovie [movie id]\n");
+		return true;
+	}
+
+	uint16 id = atoi(argv[1]);
+
+	// Same lookup order as when playing the movie
+	static const Archive::ResourceType types[] = {
+		Archive::kMultitrackMovie, Archive::kDialogMovie, Archive::kStillMovie, Archive::kMovie
+	};
+
+	ResourceDescription desc;
+	for (uint i = 0; i < ARRAYSIZE(types) && !desc.isValid(); i++)
+		desc = _vm->getFileDescription("", id, 0, types[i]);
+
+	if (!desc.isValid()) {
+		debugPrintf("Movie %d does not exist\n", id);
+		return true;
+	}
+
+	Video::BinkDecoder bink;
+	bink.setDefaultHighColorFormat(Texture::getRGBAPixelFormat());
+	if (!bink.loadStream(desc.getData())) {
+		debugPrintf("Unable to load movie %d\n", id);
+		return true;
+	}
+
+	int frames = bink.getFrameCount();
+
+	uint32 startTime = g_system->getMillis();
+	for (int i = 0; i < frames; i++)
+		bink.decodeNextFrame();
+	uint32 elapsed = MAX<uint32>(g_system->getMillis() - startTime, 1);
+
+	debugPrintf("Decoded %d frames of %dx%d in %u ms (%.2f fps)\n", frames, bink.getWidth(), bink.getHeight(), elapsed, frames * 1000.0 / elapsed);
+	return true;
+}
+
 class DumpingArchiveVisitor : public ArchiveVisitor {
 public:
 	DumpingArchiveVisitor() :
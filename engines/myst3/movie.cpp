@@ -78,6 +78,7 @@ Movie::Movie(Myst3Engine *vm, uint16 id) :
 	Common::SeekableReadStream *binkStream = binkDesc.getData();
 	_bink.setDefaultHighColorFormat(Texture::getRGBAPixelFormat());
 	_bink.setSoundType(Audio::Mixer::kSFXSoundType);
+	_bink.setDecodeAhead(3);
 	_bink.loadStream(binkStream);
 
 	if (binkDesc.getType() == Archive::kMultitrackMovie
@@ -117,6 +117,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	registerCmd("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
@@ -161,6 +162,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("segkill",			WRAP_METHOD(Console, cmdKillSegment));			// alias
 	// Garbage collection
 	registerCmd("gc",					WRAP_METHOD(Console, cmdGCInvoke));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	registerCmd("gc_objects",			WRAP_METHOD(Console, cmdGCObjects));
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
@@ -353,6 +355,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	debugPrintf(" resource_info - Shows info about a resource\n");
 	debugPrintf(" resource_types - Shows the valid resource types\n");
+	debugPrintf(" resource_cache - Shows the usage of the resource caches\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
@@ -392,6 +395,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("\n");
 	debugPrintf("Garbage collection:\n");
 	debugPrintf(" gc - Invokes the garbage collector\n");
+	debugPrintf(" gc_stats - Shows statistics of the garbage collector\n");
 	debugPrintf(" gc_objects - Lists all reachable objects, normalized\n");
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
@@ -1117,6 +1121,21 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager::CacheStats stats;
+	g_sci->getResMan()->getCacheStats(stats);
+
+	debugPrintf("LRU: %u resources, %u of %u bytes\n", stats.lruEntries, stats.lruMemory, stats.lruMaxMemory);
+	debugPrintf("Compressed cache: %u resources, %u of %u bytes (%u bytes uncompressed)\n",
+				stats.cacheEntries, stats.cacheMemory, stats.cacheMaxMemory, stats.cacheUncompressedMemory);
+
+	const uint32 loads = stats.cacheHits + stats.cacheMisses;
+	debugPrintf("Loads: %u from the compressed cache, %u from the resource files (%u%% hits)\n",
+				stats.cacheHits, stats.cacheMisses, loads ? stats.cacheHits * 100 / loads : 0);
+
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		debugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
@@ -2948,6 +2967,19 @@ bool Console::cmdGCInvoke(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	const GCStatistics &stats = _engine->_gamestate->gcStats;
+
+	debugPrintf("Collections: %u, last found %u reachable addresses\n", stats.collections, stats.lastReachable);
+	debugPrintf("Marking slices: %u, %s\n", stats.markSlices,
+				_engine->_gamestate->_segMan->getMarkingWorklist() ? "marking in progress" : "not marking");
+	debugPrintf("Marking at once: last %u ms, max %u ms, total marking %u ms\n", stats.lastMarkTime, stats.maxMarkTime, stats.totalMarkTime);
+	debugPrintf("Freeing slices: %u, last %u ms, max %u ms\n", stats.slices, stats.lastSliceTime, stats.maxSliceTime);
+	debugPrintf("Freed addresses: %u, %s\n", stats.freed,
+				_engine->_gamestate->_segMan->hasQueuedGarbage() ? "more queued" : "none queued");
+	return true;
+}
+
 bool Console::cmdGCObjects(int argc, const char **argv) {
 	AddrSet *use_map = findAllActiveReferences(_engine->_gamestate);
 
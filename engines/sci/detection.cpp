@@ -491,6 +491,11 @@ public:
 		return "Sierra's Creative Interpreter (C) Sierra Online";
 	}
 
+	// The fallback detector uses PluginMan, ConfMan and static variables
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override;
 	void registerDefaultSettings(const Common::String &target) const override;
 	GUI::OptionsContainerWidget *buildEngineOptionsWidgetStatic(GUI::GuiObject *boss, const Common::String &name, const Common::String &target) const override;
@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -68,6 +69,13 @@ void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
 		push(*it);
 }
 
+void WorklistManager::pushAllocated(reg_t reg) {
+	debugC(kDebugLevelGC, "[GC] Adding allocated %04x:%04x", PRINT_REG(reg));
+
+	_map.setVal(reg, true);
+	_worklist.push_back(reg);
+}
+
 static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_map) {
 	AddrSet *normal_map = new AddrSet();
 
@@ -99,10 +107,51 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
-	assert(!s->_executionStack.empty());
+/**
+ * Processes the worklist of an incremental marking pass. Unlike
+ * processWorkList(), this copes with references to objects which have been
+ * freed, or whose segment has been reused, since they were added.
+ * @param timeLimit	the time in milliseconds after which processing stops,
+ *					or 0 to empty the worklist
+ * @return true if the worklist is empty
+ */
+static bool processWorkListIncrementally(SegManager *segMan, WorklistManager &wm, uint32 timeLimit) {
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	const uint32 startTime = timeLimit ? g_system->getMillis() : 0;
 
-	WorklistManager wm;
+	for (uint checked = 1; !wm._worklist.empty(); checked++) {
+		// Reading the time is comparatively slow, so only do it every now and then
+		if (timeLimit && !(checked % 32) && g_system->getMillis() - startTime >= timeLimit)
+			return false;
+
+		const reg_t reg = wm._worklist.back();
+		wm._worklist.pop_back();
+
+		SegmentObj *mobj = reg.getSegment() < heap.size() ? heap[reg.getSegment()] : nullptr;
+		if (!mobj || mobj->getType() == SEG_TYPE_STACK || !mobj->isValidOffset(reg.getOffset()))
+			continue;
+
+		debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
+
+		if (mobj->getType() == SEG_TYPE_LOCALS && reg.getOffset()) {
+			// Locals are scanned as a whole, and scanned again by
+			// rescanMarkedContainers(), so they are only marked by their start
+			wm.push(make_reg(reg.getSegment(), 0));
+		} else {
+			wm.pushArray(mobj->listAllOutgoingReferences(reg));
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Adds the root set of the garbage collection to the worklist: the
+ * registers, the stacks, the explicitly loaded scripts and the references
+ * held by the engine.
+ */
+static void pushRoots(EngineState *s, WorklistManager &wm) {
+	assert(!s->_executionStack.empty());
 
 	// Initialize registers
 	wm.push(s->r_acc);
@@ -171,19 +220,55 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
 
-	processWorkList(s->_segMan, wm, heap);
-
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->processEngineHunkList(wm);
+}
 
-	return normalizeAddresses(s->_segMan, wm._map);
+/**
+ * Scans the marked locals, lists, nodes and arrays again at the end of an
+ * incremental marking pass. Unlike object variables, they are written
+ * without calling the write barrier.
+ */
+static void rescanMarkedContainers(SegManager *segMan, WorklistManager &wm) {
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+
+	for (uint seg = 1; seg < heap.size(); seg++) {
+		const SegmentObj *mobj = heap[seg];
+		if (!mobj)
+			continue;
+
+		Common::Array<reg_t> addrs;
+		switch (mobj->getType()) {
+		case SEG_TYPE_LOCALS:
+			addrs.push_back(make_reg(seg, 0));
+			break;
+		case SEG_TYPE_LISTS:
+		case SEG_TYPE_NODES:
+		case SEG_TYPE_ARRAY:
+			addrs = mobj->listAllDeallocatable(seg);
+			break;
+		default:
+			break;
+		}
+
+		for (Common::Array<reg_t>::const_iterator it = addrs.begin(); it != addrs.end(); ++it) {
+			if (wm._map.contains(*it))
+				wm.pushArray(mobj->listAllOutgoingReferences(*it));
+		}
+	}
 }
 
-void run_gc(EngineState *s) {
-	SegManager *segMan = s->_segMan;
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
 
+	pushRoots(s, wm);
+	processWorkList(s->_segMan, wm, s->_segMan->getSegments());
+
+	return normalizeAddresses(s->_segMan, wm._map);
+}
+
+static void queueUnreachable(SegManager *segMan, const AddrSet &activeRefs) {
 	// Some debug stuff
-	debugC(kDebugLevelGC, "[GC] Running...");
 #ifdef GC_DEBUG_CODE
 	const char *segnames[SEG_TYPE_MAX + 1];
 	int segcount[SEG_TYPE_MAX + 1];
@@ -191,12 +276,10 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
-
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
 	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+	Common::Array<reg_t> unreachable;
 	for (uint seg = 1; seg < heap.size(); seg++) {
 		SegmentObj *mobj = heap[seg];
 
@@ -207,14 +290,13 @@ void run_gc(EngineState *s) {
 #endif
 
 			// Get a list of all deallocatable objects in this segment,
-			// then free any which are not referenced from somewhere.
+			// then queue any which are not referenced from somewhere.
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.contains(addr)) {
 					// Not found -> we can free it
-					mobj->freeAtAddress(segMan, addr);
-					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					unreachable.push_back(addr);
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -224,7 +306,7 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
+	segMan->queueGarbage(unreachable);
 
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
@@ -235,4 +317,108 @@ void run_gc(EngineState *s) {
 #endif
 }
 
+static void addMarkStatistics(GCStatistics &stats, uint reachable, uint32 markTime) {
+	stats.collections++;
+	stats.lastReachable = reachable;
+	stats.lastMarkTime = markTime;
+	stats.maxMarkTime = MAX(stats.maxMarkTime, markTime);
+	stats.totalMarkTime += markTime;
+}
+
+void run_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	const uint32 startTime = g_system->getMillis();
+
+	debugC(kDebugLevelGC, "[GC] Running...");
+
+	// An incremental pass in progress is superseded by this one. Objects
+	// queued by an earlier pass would be found again, so they have to be
+	// gone before this one.
+	segMan->setMarkingWorklist(nullptr);
+	s->gcStats.freed += segMan->freeQueuedGarbage();
+
+	// Compute the set of all segments references currently in use.
+	AddrSet *activeRefs = findAllActiveReferences(s);
+	queueUnreachable(segMan, *activeRefs);
+	addMarkStatistics(s->gcStats, activeRefs->size(), g_system->getMillis() - startTime);
+	delete activeRefs;
+
+	s->gcStats.freed += segMan->freeQueuedGarbage();
+}
+
+void run_gc_incremental(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+
+	// Objects queued by the last pass would be found again, so a new one
+	// is only started once they are gone
+	if (!segMan->getMarkingWorklist() && !segMan->hasQueuedGarbage()) {
+		debugC(kDebugLevelGC, "[GC] Starting incremental marking...");
+		WorklistManager *wm = new WorklistManager();
+		pushRoots(s, *wm);
+		segMan->setMarkingWorklist(wm);
+	}
+
+	continue_gc(s);
+}
+
+/**
+ * Scans the roots and the marked containers again at the end of an
+ * incremental marking pass, and marks what is found.
+ * @return true if marking is complete
+ */
+static bool rescanRoots(EngineState *s, WorklistManager &wm) {
+	// The write barrier only covers the object variables, so everything
+	// else which may have been changed since it was scanned is scanned again
+	pushRoots(s, wm);
+	rescanMarkedContainers(s->_segMan, wm);
+	wm._rescans++;
+
+	// Nothing has run in between if the worklist is emptied right away, so
+	// there cannot be any unmarked reachable address left
+	const uint32 timeLimit = wm._rescans < kGCMaxRescans ? kGCSliceTime : 0;
+	return processWorkListIncrementally(s->_segMan, wm, timeLimit);
+}
+
+static void finishMarking(EngineState *s, WorklistManager &wm, uint32 startTime) {
+	SegManager *segMan = s->_segMan;
+
+	AddrSet *activeRefs = normalizeAddresses(segMan, wm._map);
+	queueUnreachable(segMan, *activeRefs);
+	addMarkStatistics(s->gcStats, activeRefs->size(), g_system->getMillis() - startTime);
+	delete activeRefs;
+}
+
+void continue_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+	WorklistManager *wm = segMan->getMarkingWorklist();
+	GCStatistics &stats = s->gcStats;
+
+	if (wm) {
+		const uint32 startTime = g_system->getMillis();
+		bool marked = false;
+		if (wm->_worklist.empty())
+			marked = rescanRoots(s, *wm);
+		else
+			processWorkListIncrementally(segMan, *wm, kGCSliceTime);
+
+		if (marked) {
+			finishMarking(s, *wm, startTime);
+			segMan->setMarkingWorklist(nullptr);
+		} else {
+			stats.totalMarkTime += g_system->getMillis() - startTime;
+		}
+		stats.markSlices++;
+		return;
+	}
+
+	if (!segMan->hasQueuedGarbage())
+		return;
+
+	const uint32 startTime = g_system->getMillis();
+	stats.freed += segMan->freeQueuedGarbage(kGCSliceTime);
+	stats.slices++;
+	stats.lastSliceTime = g_system->getMillis() - startTime;
+	stats.maxSliceTime = MAX(stats.maxSliceTime, stats.lastSliceTime);
+}
+
 } // End of namespace Sci
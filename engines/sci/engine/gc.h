@@ -50,17 +50,67 @@ typedef Common::HashMap<reg_t, bool, reg_t_Hash> AddrSet;
 AddrSet *findAllActiveReferences(EngineState *s);
 
 /**
- * Runs garbage collection on the current system state
+ * Runs garbage collection on the current system state, freeing all
+ * unreachable objects at once
  * @param s The state in which we should gc
  */
 void run_gc(EngineState *s);
 
+/**
+ * Starts an incremental garbage collection on the current system state,
+ * unless one is in progress already, and continues it by calling
+ * continue_gc(). A new collection is only started when all objects found
+ * unreachable by the last one have been freed.
+ *
+ * There is no separate collection of young objects, such as the hunks and
+ * lists created by kernel calls. It would need to know every reference from
+ * older objects to young ones, but the write barrier only covers object
+ * variables. Locals, lists, nodes, arrays and the stack would therefore
+ * have to be scanned for each young collection, which is most of the work
+ * of a full one.
+ * @param s The state in which we should gc
+ */
+void run_gc_incremental(EngineState *s);
+
+/**
+ * Continues the garbage collection started by run_gc_incremental(), for
+ * about kGCSliceTime milliseconds. First, the reachable addresses are
+ * marked in slices, while the write barrier of the SegManager keeps track
+ * of the references stored by the scripts in between. Once the worklist is
+ * empty, the roots, locals, lists, nodes and arrays are scanned again, and
+ * the addresses found by this are marked in a slice as well. Marking is
+ * complete when a slice gets through all of them, after which the
+ * unreachable addresses are queued. Then, these are freed in slices.
+ *
+ * Scanning the roots and containers again is not time limited, but it does
+ * not follow the references it finds. Marking the addresses found by the
+ * last of kGCMaxRescans scans is not time limited either, so that scripts
+ * which keep changing their containers cannot keep a pass from ending.
+ * @param s The state in which we should gc
+ */
+void continue_gc(EngineState *s);
+
+enum {
+	kGCSliceTime = 2, ///< Milliseconds spent marking or freeing per continue_gc() call
+	kGCMaxRescans = 8 ///< Scans of the roots and containers per incremental pass
+};
+
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
 	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
+	uint _rescans;	// number of times the roots were scanned again, see continue_gc()
+
+	WorklistManager() : _rescans(0) {}
 
 	void push(reg_t reg);
 	void pushArray(const Common::Array<reg_t> &tmp);
+
+	/**
+	 * Adds an object allocated during an incremental marking pass. It may be
+	 * marked already, by a stale reference to a freed entry which has been
+	 * reused for the new object, but it has to be scanned anyway.
+	 */
+	void pushAllocated(reg_t reg);
 };
 
 
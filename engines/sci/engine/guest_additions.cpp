@@ -187,6 +187,13 @@ void GuestAdditions::writeVarHook(const int type, const int index, const reg_t v
 		}
 
 		syncMessageTypeToScummVM(index, value);
+
+		// Scripts set the new room number before disposing of the current
+		// room, so its files can be read while that happens
+		if (index == kGlobalVarNewRoomNo && value.isNumber() &&
+			value != _state->variables[VAR_GLOBAL][kGlobalVarCurrentRoomNo]) {
+			g_sci->getResMan()->prefetchRoom(value.toUint16());
+		}
 	}
 }
 
@@ -33,6 +33,7 @@
 #include "sci/event.h"
 #include "sci/resource/resource.h"
 #include "sci/engine/features.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/guest_additions.h"
 #include "sci/engine/savegame.h"
 #include "sci/engine/state.h"
@@ -1338,6 +1339,10 @@ reg_t kAnimate(EngineState *s, int argc, reg_t *argv) {
 	if (g_sci->getGameId() == GID_ECOQUEST && s->currentRoomNumber() == 680)
 		g_sci->getEventManager()->getSciEvent(kSciEventPeek);
 
+	// Spread freeing the objects found by the last garbage collection over
+	// several game cycles
+	continue_gc(s);
+
 	return s->r_acc;
 }
 
@@ -117,23 +117,26 @@ struct Vertex {
 	// Previous vertex in shortest path
 	Vertex *path_prev;
 
+	// Order in which the vertex entered the A* open set, 0 if it didn't
+	uint32 openOrder;
+
+	// Set when the shortest path to the vertex is known
+	bool closed;
+
+	// Index in the cached visibility graph, -1 if not part of it
+	int graphIndex;
+
 public:
 	Vertex(const Common::Point &p) : v(p) {
 		costG = HUGE_DISTANCE;
 		path_prev = NULL;
+		openOrder = 0;
+		closed = false;
+		graphIndex = -1;
 	}
 };
 
-class VertexList: public Common::List<Vertex *> {
-public:
-	bool contains(Vertex *v) {
-		for (iterator it = begin(); it != end(); ++it) {
-			if (v == *it)
-				return true;
-		}
-		return false;
-	}
-};
+typedef Common::List<Vertex *> VertexList;
 
 /* Circular list definitions. */
 
@@ -242,6 +245,49 @@ public:
 
 typedef Common::List<Polygon *> PolygonList;
 
+/**
+ * Uniform grid over the polygon edges. Every cell lists the edges whose
+ * bounding box overlaps it, so that a line of sight only needs to be tested
+ * against the edges near it instead of against all of them.
+ */
+class EdgeGrid {
+public:
+	EdgeGrid() : _left(0), _top(0), _cellsX(0), _cellsY(0), _cellWidth(1), _cellHeight(1), _stamp(0) {}
+
+	/**
+	 * Builds the grid for the edges starting at the given vertices.
+	 */
+	void build(Vertex **vertices, int count);
+
+	/**
+	 * Determines whether an edge blocks the line of sight between two
+	 * vertices. Gives the same result as testing every edge in turn.
+	 */
+	bool blocks(const Vertex *from, const Vertex *to);
+
+private:
+	enum {
+		kMaxCells = 16 // Maximum number of cells in each direction
+	};
+
+	struct Edge {
+		Vertex *vertex; // Start of the edge
+		int16 minX, minY, maxX, maxY;
+	};
+
+	int cellX(int x) const { return CLIP<int>((x - _left) / _cellWidth, 0, _cellsX - 1); }
+	int cellY(int y) const { return CLIP<int>((y - _top) / _cellHeight, 0, _cellsY - 1); }
+
+	Common::Array<Edge> _edges;
+	Common::Array<uint> _cellStart; // Start of each cell in _cellEdges, plus the end
+	Common::Array<uint> _cellEdges;
+	Common::Array<uint32> _edgeStamp; // Last query that tested each edge
+	int _left, _top, _right, _bottom;
+	int _cellsX, _cellsY;
+	int _cellWidth, _cellHeight;
+	uint32 _stamp;
+};
+
 // Pathfinding state
 struct PathfindingState {
 	// List of all polygons
@@ -263,12 +309,19 @@ struct PathfindingState {
 	// Screen size
 	int _width, _height;
 
+	// Index of the polygon edges
+	EdgeGrid _edgeGrid;
+
+	// Visibility graph of the polygon set, NULL if it can't be used
+	AvoidPathCache *_visibility;
+
 	PathfindingState(int width, int height) : _width(width), _height(height) {
 		vertex_start = NULL;
 		vertex_end = NULL;
 		vertex_index = NULL;
 		_prependPoint = NULL;
 		_appendPoint = NULL;
+		_visibility = NULL;
 		vertices = 0;
 	}
 
@@ -699,6 +752,157 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 	return 0;
 }
 
+void EdgeGrid::build(Vertex **vertices, int count) {
+	_edges.clear();
+	_cellStart.clear();
+	_cellEdges.clear();
+	_edgeStamp.clear();
+	_cellsX = _cellsY = 0;
+	_stamp = 0;
+
+	for (int i = 0; i < count; i++) {
+		Vertex *vertex = vertices[i];
+
+		if (!VERTEX_HAS_EDGES(vertex))
+			continue;
+
+		const Common::Point &p = vertex->v;
+		const Common::Point &q = CLIST_NEXT(vertex)->v;
+
+		Edge edge;
+		edge.vertex = vertex;
+		edge.minX = MIN(p.x, q.x);
+		edge.minY = MIN(p.y, q.y);
+		edge.maxX = MAX(p.x, q.x);
+		edge.maxY = MAX(p.y, q.y);
+
+		if (_edges.empty()) {
+			_left = edge.minX;
+			_top = edge.minY;
+			_right = edge.maxX;
+			_bottom = edge.maxY;
+		} else {
+			_left = MIN<int>(_left, edge.minX);
+			_top = MIN<int>(_top, edge.minY);
+			_right = MAX<int>(_right, edge.maxX);
+			_bottom = MAX<int>(_bottom, edge.maxY);
+		}
+
+		_edges.push_back(edge);
+	}
+
+	if (_edges.empty())
+		return;
+
+	// Aim for about one edge per cell
+	_cellsX = _cellsY = CLIP<int>((int)sqrt((float)_edges.size()), 1, kMaxCells);
+	_cellWidth = (_right - _left) / _cellsX + 1;
+	_cellHeight = (_bottom - _top) / _cellsY + 1;
+
+	// Count the edges in every cell, then fill the cells
+	const uint cellCount = _cellsX * _cellsY;
+	_cellStart.resize(cellCount + 1);
+	for (uint i = 0; i <= cellCount; i++)
+		_cellStart[i] = 0;
+
+	for (uint i = 0; i < _edges.size(); i++) {
+		const Edge &edge = _edges[i];
+		for (int y = cellY(edge.minY); y <= cellY(edge.maxY); y++)
+			for (int x = cellX(edge.minX); x <= cellX(edge.maxX); x++)
+				_cellStart[y * _cellsX + x + 1]++;
+	}
+
+	for (uint i = 0; i < cellCount; i++)
+		_cellStart[i + 1] += _cellStart[i];
+
+	Common::Array<uint> fill(_cellStart.begin(), cellCount);
+	_cellEdges.resize(_cellStart[cellCount]);
+
+	for (uint i = 0; i < _edges.size(); i++) {
+		const Edge &edge = _edges[i];
+		for (int y = cellY(edge.minY); y <= cellY(edge.maxY); y++)
+			for (int x = cellX(edge.minX); x <= cellX(edge.maxX); x++)
+				_cellEdges[fill[y * _cellsX + x]++] = i;
+	}
+
+	_edgeStamp.resize(_edges.size());
+	for (uint i = 0; i < _edges.size(); i++)
+		_edgeStamp[i] = 0;
+}
+
+bool EdgeGrid::blocks(const Vertex *from, const Vertex *to) {
+	const Common::Point &a = from->v;
+	const Common::Point &b = to->v;
+
+	const int16 minX = MIN(a.x, b.x);
+	const int16 minY = MIN(a.y, b.y);
+	const int16 maxX = MAX(a.x, b.x);
+	const int16 maxY = MAX(a.y, b.y);
+
+	// An edge can only block the line of sight if its bounding box touches
+	// the one of the line: either one of its end points is on the line, or
+	// it properly intersects it
+	if (_edges.empty() || maxX < _left || minX > _right || maxY < _top || minY > _bottom)
+		return false;
+
+	if (++_stamp == 0) {
+		for (uint i = 0; i < _edgeStamp.size(); i++)
+			_edgeStamp[i] = 0;
+		_stamp = 1;
+	}
+
+	for (int y = cellY(minY); y <= cellY(maxY); y++) {
+		for (int x = cellX(minX); x <= cellX(maxX); x++) {
+			const int cell = y * _cellsX + x;
+
+			for (uint i = _cellStart[cell]; i < _cellStart[cell + 1]; i++) {
+				const uint index = _cellEdges[i];
+
+				// Edges spanning several cells are only tested once
+				if (_edgeStamp[index] == _stamp)
+					continue;
+				_edgeStamp[index] = _stamp;
+
+				const Edge &e = _edges[index];
+				if (e.maxX < minX || e.minX > maxX || e.maxY < minY || e.minY > maxY)
+					continue;
+
+				Vertex *edge = e.vertex;
+
+				if (between(a, b, edge->v)) {
+					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
+					if ((inside(a, edge)) || (inside(b, edge)))
+						return true;
+
+					// This edge won't properly intersect, so we continue
+					continue;
+				}
+
+				if (intersect_proper(a, b, edge->v, CLIST_NEXT(edge)->v))
+					return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Determines whether two vertices can see each other
+ * @param s				the pathfinding state
+ * @param vertex_cur	the first vertex
+ * @param vertex		the second vertex
+ * @return true if the line between the vertices doesn't cross a polygon
+ */
+static bool visible(PathfindingState *s, Vertex *vertex_cur, Vertex *vertex) {
+	// Make sure we don't intersect a polygon locally at the vertices
+	if ((inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		return false;
+
+	// Check for intersecting edges
+	return !s->_edgeGrid.blocks(vertex_cur, vertex);
+}
+
 /**
  * Returns a list of all vertices that are visible from a particular vertex.
  * @param s				the pathfinding state
@@ -708,36 +912,36 @@ static int inside(const Common::Point &p, Vertex *vertex) {
 static VertexList *visible_vertices(PathfindingState *s, Vertex *vertex_cur) {
 	VertexList *visVerts = new VertexList();
 
+	// Vertices of the polygon set are looked up in the visibility graph,
+	// which is filled in the first time the vertex is expanded. The start
+	// and end points are always tested.
+	AvoidPathCache *graph = (vertex_cur->graphIndex >= 0) ? s->_visibility : NULL;
+	const bool fillRow = graph && !graph->rowDone[vertex_cur->graphIndex];
+
 	for (int i = 0; i < s->vertices; i++) {
 		Vertex *vertex = s->vertex_index[i];
 
-		// Make sure we don't intersect a polygon locally at the vertices
-		if ((vertex == vertex_cur) || (inside(vertex->v, vertex_cur)) || (inside(vertex_cur->v, vertex)))
+		if (vertex == vertex_cur)
 			continue;
 
-		// Check for intersecting edges
-		int j;
-		for (j = 0; j < s->vertices; j++) {
-			Vertex *edge = s->vertex_index[j];
-			if (VERTEX_HAS_EDGES(edge)) {
-				if (between(vertex_cur->v, vertex->v, edge->v)) {
-					// If we hit a vertex, make sure we can pass through it without intersecting its polygon
-					if ((inside(vertex_cur->v, edge)) || (inside(vertex->v, edge)))
-						break;
+		bool isVisible;
 
-					// This edge won't properly intersect, so we continue
-					continue;
-				}
+		if (graph && !fillRow && vertex->graphIndex >= 0) {
+			isVisible = graph->isVisible(vertex_cur->graphIndex, vertex->graphIndex);
+		} else {
+			isVisible = visible(s, vertex_cur, vertex);
 
-				if (intersect_proper(vertex_cur->v, vertex->v, edge->v, CLIST_NEXT(edge)->v))
-					break;
-			}
+			if (fillRow && isVisible && vertex->graphIndex >= 0)
+				graph->setVisible(vertex_cur->graphIndex, vertex->graphIndex);
 		}
 
-		if (j == s->vertices)
+		if (isVisible)
 			visVerts->push_front(vertex);
 	}
 
+	if (fillRow)
+		graph->rowDone[vertex_cur->graphIndex] = true;
+
 	return visVerts;
 }
 
@@ -1322,6 +1526,29 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 		}
 	}
 
+	// Look up the visibility graph of this polygon set, before the start
+	// and end points are merged into it
+	AvoidPathCache *graph = &s->avoidPathCache;
+	Common::Array<int16> key;
+	count = 0;
+
+	for (PolygonList::iterator it = pf_s->polygons.begin(); it != pf_s->polygons.end(); ++it) {
+		polygon = *it;
+		Vertex *vertex;
+
+		key.push_back(polygon->vertices.size());
+		CLIST_FOREACH(vertex, &polygon->vertices) {
+			vertex->graphIndex = count++;
+			key.push_back(vertex->v.x);
+			key.push_back(vertex->v.y);
+		}
+	}
+
+	if (key != graph->polygons) {
+		graph->polygons = key;
+		graph->reset(count);
+	}
+
 	// Merge start and end points into polygon set
 	pf_s->vertex_start = merge_point(pf_s, *new_start);
 	pf_s->vertex_end = merge_point(pf_s, *new_end);
@@ -1329,6 +1556,16 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	delete new_start;
 	delete new_end;
 
+	// Points that split an edge change the lines of sight between the
+	// other vertices, so the graph can't be used for this request. Points
+	// added as single-vertex polygons don't.
+	if (pf_s->vertex_start->graphIndex < 0 && VERTEX_HAS_EDGES(pf_s->vertex_start))
+		graph = NULL;
+	if (pf_s->vertex_end->graphIndex < 0 && VERTEX_HAS_EDGES(pf_s->vertex_end))
+		graph = NULL;
+
+	pf_s->_visibility = graph;
+
 	// Allocate and build vertex index
 	pf_s->vertex_index = (Vertex**)malloc(sizeof(Vertex *) * (count + 2));
 
@@ -1344,10 +1581,89 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
 	}
 
 	pf_s->vertices = count;
+	pf_s->_edgeGrid.build(pf_s->vertex_index, count);
 
 	return pf_s;
 }
 
+/**
+ * Entry of the A* open set. Costs only ever go down, so instead of updating
+ * an entry a new one is added and the outdated one is skipped later on.
+ */
+struct OpenSetEntry {
+	uint32 costF;
+
+	// Order in which the vertex entered the open set
+	uint32 order;
+
+	Vertex *vertex;
+};
+
+/**
+ * Determines whether an open set entry has to be expanded before another.
+ * Of vertices with the same cost the one that entered the open set last goes
+ * first, which is the order the original list based open set used.
+ */
+static bool openSetBefore(const OpenSetEntry &a, const OpenSetEntry &b) {
+	if (a.costF != b.costF)
+		return a.costF < b.costF;
+
+	return a.order > b.order;
+}
+
+/**
+ * Adds an entry to the binary heap holding the open set
+ */
+static void pushOpenSet(Common::Array<OpenSetEntry> &heap, Vertex *vertex) {
+	OpenSetEntry entry;
+	entry.costF = vertex->costF;
+	entry.order = vertex->openOrder;
+	entry.vertex = vertex;
+
+	uint i = heap.size();
+	heap.push_back(entry);
+
+	while (i > 0) {
+		const uint parent = (i - 1) / 2;
+		if (!openSetBefore(entry, heap[parent]))
+			break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+
+	heap[i] = entry;
+}
+
+/**
+ * Removes the first entry from the binary heap holding the open set
+ */
+static OpenSetEntry popOpenSet(Common::Array<OpenSetEntry> &heap) {
+	const OpenSetEntry top = heap[0];
+	const OpenSetEntry last = heap.back();
+	heap.pop_back();
+
+	const uint size = heap.size();
+	uint i = 0;
+
+	if (size > 0) {
+		for (;;) {
+			uint child = 2 * i + 1;
+			if (child >= size)
+				break;
+			if (child + 1 < size && openSetBefore(heap[child + 1], heap[child]))
+				child++;
+			if (!openSetBefore(heap[child], last))
+				break;
+			heap[i] = heap[child];
+			i = child;
+		}
+
+		heap[i] = last;
+	}
+
+	return top;
+}
+
 /**
  * Computes a shortest path from vertex_start to vertex_end. The caller can
  * construct the resulting path by following the path_prev links from
@@ -1356,40 +1672,36 @@ static PathfindingState *convert_polygon_set(EngineState *s, reg_t poly_list, Co
  * Parameters: (PathfindingState *) s: The pathfinding state
  */
 static void AStar(PathfindingState *s) {
-	// Vertices of which the shortest path is known
-	VertexList closedSet;
+	// The remaining vertices, as a binary heap ordered on F cost. Vertices
+	// of which the shortest path is known are marked as closed.
+	Common::Array<OpenSetEntry> openSet;
+	uint32 openOrder = 0;
+	bool found = false;
 
-	// The remaining vertices
-	VertexList openSet;
-
-	openSet.push_front(s->vertex_start);
+	s->vertex_start->openOrder = ++openOrder;
 	s->vertex_start->costG = 0;
 	s->vertex_start->costF = (uint32)sqrt((float)s->vertex_start->v.sqrDist(s->vertex_end->v));
+	pushOpenSet(openSet, s->vertex_start);
 
 	while (!openSet.empty()) {
 		// Find vertex in open set with lowest F cost
-		VertexList::iterator vertex_min_it = openSet.end();
-		Vertex *vertex_min = 0;
-		uint32 min = HUGE_DISTANCE;
+		const OpenSetEntry entry = popOpenSet(openSet);
+		Vertex *vertex_min = entry.vertex;
 
-		for (VertexList::iterator it = openSet.begin(); it != openSet.end(); ++it) {
-			Vertex *vertex = *it;
-			if (vertex->costF < min) {
-				vertex_min_it = it;
-				vertex_min = *vertex_min_it;
-				min = vertex->costF;
-			}
-		}
+		// Skip entries of vertices that have been reached in a cheaper way
+		if (vertex_min->closed || entry.costF != vertex_min->costF)
+			continue;
 
-		assert(vertex_min != 0);	// the vertex cost should never be bigger than HUGE_DISTANCE
+		assert(vertex_min->costF < HUGE_DISTANCE);	// the vertex cost should never be bigger than HUGE_DISTANCE
 
 		// Check if we are done
-		if (vertex_min == s->vertex_end)
+		if (vertex_min == s->vertex_end) {
+			found = true;
 			break;
+		}
 
 		// Move vertex from set open to set closed
-		closedSet.push_front(vertex_min);
-		openSet.erase(vertex_min_it);
+		vertex_min->closed = true;
 
 		VertexList *visVerts = visible_vertices(s, vertex_min);
 
@@ -1397,11 +1709,11 @@ static void AStar(PathfindingState *s) {
 			uint32 new_dist;
 			Vertex *vertex = *it;
 
-			if (closedSet.contains(vertex))
+			if (vertex->closed)
 				continue;
 
-			if (!openSet.contains(vertex))
-				openSet.push_front(vertex);
+			if (!vertex->openOrder)
+				vertex->openOrder = ++openOrder;
 
 			new_dist = vertex_min->costG + (uint32)sqrt((float)vertex_min->v.sqrDist(vertex->v));
 
@@ -1439,13 +1751,14 @@ static void AStar(PathfindingState *s) {
 				vertex->costG = new_dist;
 				vertex->costF = vertex->costG + (uint32)sqrt((float)vertex->v.sqrDist(s->vertex_end->v));
 				vertex->path_prev = vertex_min;
+				pushOpenSet(openSet, vertex);
 			}
 		}
 
 		delete visVerts;
 	}
 
-	if (openSet.empty())
+	if (!found)
 		debugC(kDebugLevelAvoidPath, "AvoidPath: End point (%i, %i) is unreachable", s->vertex_end->v.x, s->vertex_end->v.y);
 }
 
@@ -20316,8 +20316,50 @@ int32 ScriptPatcher::findSignature(uint32 magicDWord, int magicOffset, const uin
 	return -1;
 }
 
-int32 ScriptPatcher::findSignature(const SciScriptPatcherEntry *patchEntry, const SciScriptPatcherRuntimeEntry *runtimeEntry, const SciSpan<const byte> &scriptData) {
-	return findSignature(runtimeEntry->magicDWord, runtimeEntry->magicOffset, patchEntry->signatureData, patchEntry->description, scriptData);
+void ScriptPatcher::findMagicDWords(const EntryIndexArray &entries, const SciSpan<const byte> &scriptData, MagicOffsetArray &magicOffsets) {
+	magicOffsets.clear();
+	magicOffsets.resize(entries.size());
+
+	if (scriptData.size() < 4) // we need to find a DWORD, so less than 4 bytes is not okay
+		return;
+
+	// Map each magic DWORD to the entries using it. The lower 16 bits of the
+	// magic DWORDs are also kept in a bit set, which rejects most offsets
+	// without a hash map lookup.
+	typedef Common::HashMap<uint32, EntryIndexArray> MagicDWordMap;
+	MagicDWordMap magicDWords;
+	uint32 filter[65536 / 32];
+	memset(filter, 0, sizeof(filter));
+
+	for (uint i = 0; i < entries.size(); i++) {
+		const SciScriptPatcherRuntimeEntry &runtimeEntry = _runtimeTable[entries[i]];
+		if (!runtimeEntry.active)
+			continue;
+
+		magicDWords[runtimeEntry.magicDWord].push_back(i);
+		const uint16 filterBits = runtimeEntry.magicDWord & 0xFFFF;
+		filter[filterBits >> 5] |= 1U << (filterBits & 31);
+	}
+
+	if (magicDWords.empty())
+		return;
+
+	// magicDWord is in platform-specific BE/LE form, so reading the script data the same way matches
+	const byte *data = scriptData.getUnsafeDataAt(0, scriptData.size());
+	const uint32 searchLimit = scriptData.size() - 3;
+	for (uint32 DWordOffset = 0; DWordOffset < searchLimit; DWordOffset++) {
+		const uint32 curDWord = READ_UINT32(data + DWordOffset);
+		const uint16 filterBits = curDWord & 0xFFFF;
+		if (!(filter[filterBits >> 5] & (1U << (filterBits & 31))))
+			continue;
+
+		MagicDWordMap::const_iterator magicEntries = magicDWords.find(curDWord);
+		if (magicEntries == magicDWords.end())
+			continue;
+
+		for (uint i = 0; i < magicEntries->_value.size(); i++)
+			magicOffsets[magicEntries->_value[i]].push_back(DWordOffset);
+	}
 }
 
 // Attention: Magic DWord is returned using platform specific byte order. This is done on purpose for performance.
@@ -20482,6 +20524,9 @@ void ScriptPatcher::initSignature(const SciScriptPatcherEntry *patchTable) {
 		// We verify the patch data
 		calculateMagicDWordAndVerify(curEntry->description, curEntry->patchData, false, curRuntimeEntry->magicDWord, curRuntimeEntry->magicOffset);
 
+		// Entries keep their table order within a script, as patches may depend on earlier ones
+		_scriptEntries[curEntry->scriptNr].push_back(curEntry - patchTable);
+
 		curEntry++; curRuntimeEntry++;
 	}
 }
@@ -20793,24 +20838,45 @@ void ScriptPatcher::processScript(uint16 scriptNr, SciSpan<byte> scriptData) {
 			}
 		}
 
-		curEntry = signatureTable;
-		curRuntimeEntry = _runtimeTable;
-
-		while (curEntry->signatureData) {
-			if ((scriptNr == curEntry->scriptNr) && (curRuntimeEntry->active)) {
-				int32 foundOffset = 0;
-				int16 applyCount = curEntry->applyCount;
-				do {
-					foundOffset = findSignature(curEntry, curRuntimeEntry, scriptData);
-					if (foundOffset != -1) {
-						// found, so apply the patch
-						debugC(kDebugLevelPatcher, "Script-Patcher: '%s' on script %d offset %d", curEntry->description, scriptNr, foundOffset);
-						applyPatch(curEntry, scriptData, foundOffset);
+		if (!_scriptEntries.contains(scriptNr))
+			return;
+
+		// Only the entries of this script are checked, and all of their magic
+		// DWORDs are searched for at once
+		const EntryIndexArray &entries = _scriptEntries[scriptNr];
+		MagicOffsetArray magicOffsets;
+		findMagicDWords(entries, scriptData, magicOffsets);
+
+		for (uint entryNr = 0; entryNr < entries.size(); entryNr++) {
+			curEntry = signatureTable + entries[entryNr];
+			curRuntimeEntry = _runtimeTable + entries[entryNr];
+			if (!curRuntimeEntry->active)
+				continue;
+
+			int32 foundOffset = 0;
+			int16 applyCount = curEntry->applyCount;
+			do {
+				foundOffset = -1;
+				const Common::Array<uint32> &offsets = magicOffsets[entryNr];
+				for (uint i = 0; i < offsets.size(); i++) {
+					// magic DWORD found, check if actual signature matches
+					const uint32 offset = offsets[i] + curRuntimeEntry->magicOffset;
+					if (verifySignature(offset, curEntry->signatureData, curEntry->description, scriptData)) {
+						foundOffset = offset;
+						break;
 					}
-					applyCount--;
-				} while ((foundOffset != -1) && (applyCount));
-			}
-			curEntry++; curRuntimeEntry++;
+				}
+
+				if (foundOffset != -1) {
+					// found, so apply the patch
+					debugC(kDebugLevelPatcher, "Script-Patcher: '%s' on script %d offset %d", curEntry->description, scriptNr, foundOffset);
+					applyPatch(curEntry, scriptData, foundOffset);
+
+					// The patch may have added or removed occurrences of magic DWORDs
+					findMagicDWords(entries, scriptData, magicOffsets);
+				}
+				applyCount--;
+			} while ((foundOffset != -1) && (applyCount));
 		}
 	}
 }
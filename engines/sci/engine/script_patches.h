@@ -23,6 +23,9 @@
 #ifndef SCI_ENGINE_SCRIPT_PATCHES_H
 #define SCI_ENGINE_SCRIPT_PATCHES_H
 
+#include "common/array.h"
+#include "common/hashmap.h"
+
 #include "sci/sci.h"
 
 namespace Sci {
@@ -113,15 +116,20 @@ private:
 	// Enables a patch inside the patch table (used for optional patches like CD+Text support for KQ6 & LB2)
 	void enablePatch(const SciScriptPatcherEntry *patchTable, const char *searchDescription);
 
-	// Searches for a given signature entry inside script data
-	// returns -1 in case it was not found or an offset to the matching data
-	int32 findSignature(const SciScriptPatcherEntry *patchEntry, const SciScriptPatcherRuntimeEntry *runtimeEntry, const SciSpan<const byte> &scriptData);
-
 	// Applies a patch to a given script + offset (overwrites parts)
 	void applyPatch(const SciScriptPatcherEntry *patchEntry, SciSpan<byte> scriptData, int32 signatureOffset);
 
+	typedef Common::Array<uint> EntryIndexArray;
+	typedef Common::Array<Common::Array<uint32> > MagicOffsetArray;
+
+	// Searches for the magic DWORDs of all active given entries in a single pass over the script data
+	// fills in the ascending offsets of the magic DWORD of each entry
+	void findMagicDWords(const EntryIndexArray &entries, const SciSpan<const byte> &scriptData, MagicOffsetArray &magicOffsets);
+
 	Selector *_selectorIdTable;
 	SciScriptPatcherRuntimeEntry *_runtimeTable;
+	// Indices of the entries of the patch table, grouped by script number
+	Common::HashMap<uint16, EntryIndexArray> _scriptEntries;
 	bool _isMacSci11;
 };
 
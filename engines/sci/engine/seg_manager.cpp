@@ -20,7 +20,10 @@
  *
  */
 
+#include "common/system.h"
+
 #include "sci/sci.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/seg_manager.h"
 #include "sci/engine/state.h"
 #include "sci/engine/script.h"
@@ -48,6 +51,8 @@ SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
 	_bitmapSegId = 0;
 #endif
 
+	_markingWorklist = nullptr;
+
 	createClassTable();
 }
 
@@ -56,6 +61,9 @@ SegManager::~SegManager() {
 }
 
 void SegManager::resetSegMan() {
+	_garbage.clear();
+	setMarkingWorklist(nullptr);
+
 	// Free memory
 	for (uint i = 0; i < _heap.size(); i++) {
 		if (_heap[i])
@@ -167,6 +175,7 @@ void SegManager::deallocate(SegmentId seg) {
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
+		_selectorLookupCache.clear();
 		if (scr->getLocalsSegment()) {
 			// Check if the locals segment has already been deallocated.
 			// If the locals block has been stored in a segment with an ID
@@ -180,10 +189,72 @@ void SegManager::deallocate(SegmentId seg) {
 		}
 	}
 
+	discardQueuedGarbage(actualSegment);
+
 	delete mobj;
 	_heap[actualSegment] = NULL;
 }
 
+void SegManager::queueGarbage(const Common::Array<reg_t> &addrs) {
+	_garbage.reserve(_garbage.size() + addrs.size());
+	for (uint i = 0; i < addrs.size(); i++) {
+		QueuedGarbage garbage;
+		garbage.addr = addrs[i];
+		garbage.generation = getSegmentObj(addrs[i].getSegment())->getGeneration(addrs[i].getOffset());
+		_garbage.push_back(garbage);
+	}
+}
+
+uint SegManager::freeQueuedGarbage(uint32 timeLimit) {
+	const uint32 startTime = timeLimit ? g_system->getMillis() : 0;
+	uint freed = 0;
+
+	for (uint checked = 1; !_garbage.empty(); checked++) {
+		// Reading the time is comparatively slow, so only do it every now and then
+		if (timeLimit && !(checked % 32) && g_system->getMillis() - startTime >= timeLimit)
+			break;
+
+		const QueuedGarbage garbage = _garbage.back();
+		const reg_t addr = garbage.addr;
+		_garbage.pop_back();
+
+		// Unreachable addresses cannot be freed by the scripts, but the
+		// engine may still have freed them in the meantime, and their
+		// entries may even have been reused for new objects
+		SegmentObj *mobj = getSegmentObj(addr.getSegment());
+		if (!mobj || !mobj->isValidOffset(addr.getOffset()) ||
+			mobj->getGeneration(addr.getOffset()) != garbage.generation)
+			continue;
+
+		mobj->freeAtAddress(this, addr);
+		debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+		freed++;
+	}
+
+	return freed;
+}
+
+void SegManager::discardQueuedGarbage(SegmentId seg) {
+	if (_garbage.empty())
+		return;
+
+	uint kept = 0;
+	for (uint i = 0; i < _garbage.size(); i++) {
+		if (getActualSegment(_garbage[i].addr.getSegment()) != seg)
+			_garbage[kept++] = _garbage[i];
+	}
+	_garbage.resize(kept);
+}
+
+void SegManager::setMarkingWorklist(WorklistManager *wm) {
+	delete _markingWorklist;
+	_markingWorklist = wm;
+}
+
+void SegManager::markReference(reg_t value) {
+	_markingWorklist->push(value);
+}
+
 bool SegManager::isHeapObject(reg_t pos) const {
 	const Object *obj = getObject(pos);
 	if (obj == NULL || (obj && obj->isFreed()))
@@ -440,6 +511,11 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_clonesSegId, offset);
+
+	// The clone is filled in by the caller, so it is scanned later on
+	if (_markingWorklist)
+		_markingWorklist->pushAllocated(*addr);
+
 	return &table->at(offset);
 }
 
@@ -1042,10 +1118,16 @@ int SegManager::instantiateScript(int scriptNum, bool applyScriptPatches) {
 		scr = allocateScript(scriptNum, &segmentId);
 	}
 
+	// The segment may be reused, and the new classes may be superclasses of
+	// already loaded objects
+	_selectorLookupCache.clear();
+	discardQueuedGarbage(segmentId);
+
 	scr->load(scriptNum, _resMan, _scriptPatcher, applyScriptPatches);
 	scr->initializeLocals(this);
 	scr->initializeClasses(this);
 	scr->initializeObjects(this, segmentId, applyScriptPatches);
+	_selectorLookupCache.clear();
 #ifdef ENABLE_SCI32
 	g_sci->_guestAdditions->instantiateScriptHook(*scr);
 #endif
@@ -1077,6 +1159,8 @@ void SegManager::uninstantiateScript(int script_nr) {
 		uninstantiateScriptSci0(script_nr);
 	// FIXME: Add proper script uninstantiation for SCI 1.1
 
+	_selectorLookupCache.clear();
+
 	if (!scr->getLockers()) {
 		// The actual script deletion seems to be done by SCI scripts themselves
 		scr->markDeleted();
@@ -29,6 +29,7 @@
 #include "sci/engine/vm.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/segment.h"
+#include "sci/engine/selector.h"
 #ifdef ENABLE_SCI32
 #include "sci/graphics/celobj32.h" // kLowResX, kLowResY
 #endif
@@ -45,6 +46,7 @@ enum ScriptLoadType {
 };
 
 class Script;
+struct WorklistManager;
 
 class SegManager : public Common::Serializable {
 	friend class Console;
@@ -458,6 +460,43 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
+	/**
+	 * Queues unreachable addresses found by the garbage collector, to be
+	 * freed by freeQueuedGarbage().
+	 */
+	void queueGarbage(const Common::Array<reg_t> &addrs);
+
+	/**
+	 * Frees the queued unreachable addresses.
+	 * @param timeLimit	the time in milliseconds after which freeing stops,
+	 *					or 0 to free all of them
+	 * @return the number of freed addresses
+	 */
+	uint freeQueuedGarbage(uint32 timeLimit = 0);
+
+	bool hasQueuedGarbage() const { return !_garbage.empty(); }
+
+	/**
+	 * Sets the worklist of the incremental marking pass of the garbage
+	 * collector, or nullptr when no pass is in progress. The worklist is
+	 * owned by the SegManager from then on.
+	 */
+	void setMarkingWorklist(WorklistManager *wm);
+	WorklistManager *getMarkingWorklist() const { return _markingWorklist; }
+
+	/**
+	 * Write barrier of the garbage collector, to be called whenever a value
+	 * is stored in an object variable. While an incremental marking pass is
+	 * in progress, the value is added to its worklist. Otherwise, an object
+	 * scanned already could hide the only reference to an unmarked one.
+	 */
+	void writeBarrier(reg_t value) {
+		if (_markingWorklist)
+			markReference(value);
+	}
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
@@ -466,6 +505,13 @@ private:
 
 	ResourceManager *_resMan;
 	ScriptPatcher *_scriptPatcher;
+	SelectorLookupCache _selectorLookupCache;
+	struct QueuedGarbage {
+		reg_t addr;
+		uint32 generation; ///< Generation of the entry, when it was queued
+	};
+	Common::Array<QueuedGarbage> _garbage; ///< Unreachable addresses, see queueGarbage()
+	WorklistManager *_markingWorklist; ///< See setMarkingWorklist()
 
 	SegmentId _clonesSegId; ///< ID of the (a) clones segment
 	SegmentId _listsSegId; ///< ID of the (a) list segment
@@ -488,6 +534,11 @@ private:
 	void deallocate(SegmentId seg);
 	void createClassTable();
 
+	/** Drops queued garbage of a segment, whose contents are replaced. */
+	void discardQueuedGarbage(SegmentId seg);
+
+	void markReference(reg_t value);
+
 	SegmentId findFreeSegment() const;
 
 	/**
@@ -143,6 +143,13 @@ public:
 	virtual Common::Array<reg_t> listAllOutgoingReferences(reg_t object) const {
 		return Common::Array<reg_t>();
 	}
+
+	/**
+	 * Returns a number, which changes whenever the object at the specified
+	 * offset is replaced by a newly allocated one.
+	 * Used by the garbage collector.
+	 */
+	virtual uint32 getGeneration(uint32 offset) const { return 0; }
 };
 
 struct LocalVariables : public SegmentObj {
@@ -232,6 +239,7 @@ struct SegmentObjTable : public SegmentObj {
 	struct Entry {
 		T *data;
 		int next_free; /* Only used for free entries */
+		uint32 generation; /* Incremented whenever the entry is reused */
 	};
 	enum { HEAPENTRY_INVALID = -1 };
 
@@ -267,6 +275,7 @@ public:
 			first_free = _table[oldff].next_free;
 
 			_table[oldff].next_free = oldff;
+			_table[oldff].generation++;
 			assert(_table[oldff].data == nullptr);
 			_table[oldff].data = new T;
 			return oldff;
@@ -306,6 +315,10 @@ public:
 		return tmp;
 	}
 
+	uint32 getGeneration(uint32 offset) const override {
+		return isValidEntry(offset) ? _table[offset].generation : 0;
+	}
+
 	uint size() const { return _table.size(); }
 
 	T &at(uint index) { return *_table[index].data; }
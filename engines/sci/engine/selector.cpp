@@ -285,6 +285,7 @@ void writeSelector(SegManager *segMan, reg_t object, Selector selectorId, reg_t
 	}
 
 	*address.getPointer(segMan) = value;
+	segMan->writeBarrier(value);
 #ifdef ENABLE_SCI32
 	updateInfoFlagViewVisible(segMan->getObject(object), address.varindex);
 #endif
@@ -325,9 +326,70 @@ void invokeSelector(EngineState *s, reg_t object, int selectorId,
 	run_vm(s); // Start a new vm
 }
 
+SelectorLookupCache::SelectorLookupCache() {
+	clear();
+}
+
+const SelectorLookupCache::Entry *SelectorLookupCache::find(reg_t objPos, Selector selectorId) {
+	const Key key = { objPos, selectorId };
+	DirectEntry &direct = _direct[KeyHash()(key) & (kDirectSize - 1)];
+	if (direct.key == key)
+		return &direct.entry;
+
+	Common::HashMap<Key, Entry, KeyHash>::const_iterator it = _lookups.find(key);
+	if (it == _lookups.end())
+		return nullptr;
+
+	direct.key = key;
+	direct.entry = it->_value;
+	return &direct.entry;
+}
+
+void SelectorLookupCache::add(reg_t objPos, Selector selectorId, const Entry &entry) {
+	const Key key = { objPos, selectorId };
+	_lookups[key] = entry;
+
+	DirectEntry &direct = _direct[KeyHash()(key) & (kDirectSize - 1)];
+	direct.key = key;
+	direct.entry = entry;
+}
+
+void SelectorLookupCache::clear() {
+	for (int i = 0; i < kDirectSize; i++) {
+		_direct[i].key.objPos = NULL_REG;
+		_direct[i].key.selectorId = -1;
+	}
+
+	_lookups.clear();
+}
+
+static void lookupSelectorUncached(SegManager *segMan, const Object *obj, Selector selectorId, SelectorLookupCache::Entry &entry) {
+	entry.varIndex = obj->locateVarSelector(segMan, selectorId);
+	entry.funcPos = NULL_REG;
+
+	if (entry.varIndex >= 0) {
+		// Found it as a variable
+		entry.type = kSelectorVariable;
+		return;
+	}
+
+	// Check if it's a method, with recursive lookup in superclasses
+	while (obj) {
+		const int index = obj->funcSelectorPosition(selectorId);
+		if (index >= 0) {
+			entry.type = kSelectorMethod;
+			entry.funcPos = obj->getFunction(index);
+			return;
+		}
+
+		obj = segMan->getObject(obj->getSuperClassSelector());
+	}
+
+	entry.type = kSelectorNone;
+}
+
 SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector selectorId, ObjVarRef *varp, reg_t *fptr) {
 	const Object *obj = segMan->getObject(obj_location);
-	int index;
 	bool oldScriptHeader = (getSciVersion() == SCI_VERSION_0_EARLY);
 
 	// Early SCI versions used the LSB in the selector ID as a read/write
@@ -340,34 +402,26 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 		error("lookupSelector: Attempt to send to non-object or invalid script. Address %04x:%04x, %s", PRINT_REG(obj_location), origin.toString().c_str());
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	const SelectorLookupCache::Entry *entry = cache.find(obj->getPos(), selectorId);
+	SelectorLookupCache::Entry newEntry;
+	if (!entry) {
+		lookupSelectorUncached(segMan, obj, selectorId, newEntry);
+		cache.add(obj->getPos(), selectorId, newEntry);
+		entry = &newEntry;
+	}
 
-	if (index >= 0) {
-		// Found it as a variable
+	if (entry->type == kSelectorVariable) {
 		if (varp) {
 			varp->obj = obj_location;
-			varp->varindex = index;
+			varp->varindex = entry->varIndex;
 		}
-		return kSelectorVariable;
-	} else {
-		// Check if it's a method, with recursive lookup in superclasses
-		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
-			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
-			} else {
-				obj = segMan->getObject(obj->getSuperClassSelector());
-			}
-		}
-
-		return kSelectorNone;
+	} else if (entry->type == kSelectorMethod) {
+		if (fptr)
+			*fptr = entry->funcPos;
 	}
 
-
-//	return _lookupSelector_function(segMan, obj, selectorId, fptr);
+	return entry->type;
 }
 
 } // End of namespace Sci
@@ -24,6 +24,7 @@
 #define SCI_ENGINE_SELECTOR_H
 
 #include "common/scummsys.h"
+#include "common/hashmap.h"
 
 #include "sci/engine/vm_types.h"	// for reg_t
 #include "sci/engine/vm.h"
@@ -200,6 +201,65 @@ struct SelectorCache {
 #endif
 };
 
+/**
+ * Caches the results of lookupSelector(), so that sending to an object does
+ * not need to scan the property and method tables of its class hierarchy.
+ *
+ * Lookups are keyed on the position of the object, which clones share with
+ * the object they were cloned from. The most recent lookups are kept in a
+ * small direct mapped table in front of the table holding all of them.
+ * The cache has to be cleared whenever scripts are loaded or unloaded, as
+ * that changes the class hierarchy.
+ */
+class SelectorLookupCache {
+public:
+	struct Entry {
+		SelectorType type;
+		int varIndex; ///< For variables, the index of the property
+		reg_t funcPos; ///< For methods, the address of the code
+	};
+
+	SelectorLookupCache();
+
+	/**
+	 * Returns the cached lookup of a selector for an object, or nullptr if
+	 * there is none.
+	 */
+	const Entry *find(reg_t objPos, Selector selectorId);
+
+	void add(reg_t objPos, Selector selectorId, const Entry &entry);
+
+	void clear();
+
+private:
+	struct Key {
+		reg_t objPos;
+		Selector selectorId;
+
+		bool operator==(const Key &other) const {
+			return objPos == other.objPos && selectorId == other.selectorId;
+		}
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const {
+			return (key.objPos.getSegment() << 20) ^ (key.objPos.getOffset() << 8) ^ key.selectorId;
+		}
+	};
+
+	struct DirectEntry {
+		Key key;
+		Entry entry;
+	};
+
+	enum {
+		kDirectSize = 1024
+	};
+
+	DirectEntry _direct[kDirectSize];
+	Common::HashMap<Key, Entry, KeyHash> _lookups;
+};
+
 /**
  * Map a selector name to a selector id. Shortcut for accessing the selector cache.
  */
@@ -98,6 +98,67 @@ struct SciCallOrigin {
 	}
 };
 
+/**
+ * Statistics of the garbage collector, for the debugger. Times are in
+ * milliseconds.
+ */
+struct GCStatistics {
+	GCStatistics() {
+		memset(this, 0, sizeof(*this));
+	}
+
+	uint32 collections; ///< Number of passes marking the reachable addresses
+	uint32 markSlices; ///< Number of time limited parts of incremental passes
+	uint32 lastMarkTime; ///< Time of the last full pass, or of the final slice of the last incremental one
+	uint32 maxMarkTime;
+	uint32 totalMarkTime; ///< Including the time limited parts
+	uint32 lastReachable; ///< Number of reachable addresses found by the last pass
+	uint32 slices; ///< Number of time limited passes freeing unreachable addresses
+	uint32 lastSliceTime;
+	uint32 maxSliceTime;
+	uint32 freed; ///< Total number of freed addresses
+};
+
+/**
+ * Visibility graph of the last polygon set passed to kAvoidPath. Actors are
+ * usually sent around the same set of obstacles over and over, so the lines
+ * of sight between the polygon vertices are kept until the polygons change.
+ * Rows are filled in lazily, when A* first expands the vertex.
+ */
+struct AvoidPathCache {
+	AvoidPathCache() : vertexCount(0), rowWords(0) {}
+
+	/**
+	 * Starts a new graph for a polygon set with the given number of vertices.
+	 */
+	void reset(uint count) {
+		vertexCount = count;
+		rowWords = (count + 31) / 32;
+		visibility.clear();
+		visibility.resize(count * rowWords);
+		rowDone.clear();
+		rowDone.resize(count);
+		for (uint i = 0; i < visibility.size(); ++i)
+			visibility[i] = 0;
+		for (uint i = 0; i < count; ++i)
+			rowDone[i] = false;
+	}
+
+	bool isVisible(uint from, uint to) const {
+		return (visibility[from * rowWords + to / 32] & (1U << (to % 32))) != 0;
+	}
+
+	void setVisible(uint from, uint to) {
+		visibility[from * rowWords + to / 32] |= 1U << (to % 32);
+	}
+
+	Common::Array<int16> polygons; ///< Vertex count and points of each polygon of the set
+	Common::Array<uint32> visibility; ///< One bit per vertex pair
+	Common::Array<bool> rowDone;
+	uint vertexCount;
+	uint rowWords;
+};
+
 struct EngineState : public Common::Serializable {
 public:
 	EngineState(SegManager *segMan);
@@ -194,6 +255,8 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GCStatistics gcStats;
+	AvoidPathCache avoidPathCache;
 
 	MessageState *_msgState;
 
@@ -189,6 +189,7 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 				if (lookupSelector(s->_segMan, stopGroopPos, SELECTOR(client), &varp, NULL) == kSelectorVariable) {
 					reg_t *clientVar = varp.getPointer(s->_segMan);
 					*clientVar = value;
+					s->_segMan->writeBarrier(value);
 				}
 			}
 		}
@@ -250,6 +251,7 @@ static void _exec_varselectors(EngineState *s) {
 			// varselector access?
 			if (xs.argc) { // write?
 				*var = xs.variables_argp[1];
+				s->_segMan->writeBarrier(*var);
 
 #ifdef ENABLE_SCI32
 				updateInfoFlagViewVisible(s->_segMan->getObject(xs.addr.varp.obj), xs.addr.varp.varindex);
@@ -909,7 +911,7 @@ void run_vm(EngineState *s) {
 			// Run the garbage collector, if needed
 			if (s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				run_gc_incremental(s);
 			}
 
 			// Call kernel function
@@ -991,6 +993,7 @@ void run_vm(EngineState *s) {
 					reg_t *var = old_xs->getVarPointer(s->_segMan);
 					if (old_xs->argc) { // write?
 						*var = old_xs->variables_argp[1];
+						s->_segMan->writeBarrier(*var);
 
 #ifdef ENABLE_SCI32
 						updateInfoFlagViewVisible(s->_segMan->getObject(old_xs->addr.varp.obj), old_xs->addr.varp.varindex);
@@ -1177,6 +1180,7 @@ void run_vm(EngineState *s) {
 			}
 
 			opProperty = s->r_acc;
+			s->_segMan->writeBarrier(opProperty);
 #ifdef ENABLE_SCI32
 			updateInfoFlagViewVisible(obj, opparams[0], true);
 #endif
@@ -1207,6 +1211,7 @@ void run_vm(EngineState *s) {
 				                    s->_segMan, BREAK_SELECTORWRITE);
 			}
 			opProperty = newValue;
+			s->_segMan->writeBarrier(opProperty);
 #ifdef ENABLE_SCI32
 			updateInfoFlagViewVisible(obj, opparams[0], true);
 #endif
@@ -1233,6 +1238,7 @@ void run_vm(EngineState *s) {
 				opProperty += 1;
 			else
 				opProperty -= 1;
+			s->_segMan->writeBarrier(opProperty);
 
 			if (g_sci->_debugState._activeBreakpointTypes & BREAK_SELECTORWRITE) {
 				debugPropertyAccess(obj, s->xs->objp, opparams[0], NULL_SELECTOR,
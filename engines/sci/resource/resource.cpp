@@ -24,6 +24,7 @@
 
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/lz4.h"
 #include "common/macresman.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -214,9 +215,14 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
+	_lruPrev = _lruNext = nullptr;
+	_cachePrev = _cacheNext = nullptr;
+	_cachedData = nullptr;
+	_cachedSize = 0;
 }
 
 Resource::~Resource() {
+	_resMan->removeFromCache(this);
 	delete[] _data;
 	delete[] _header;
 	if (_source && _source->getSourceType() == kSourcePatch)
@@ -423,6 +429,9 @@ void ResourceManager::disposeVolumeFileStream(Common::SeekableReadStream *fileSt
 }
 
 void ResourceManager::loadResource(Resource *res) {
+	if (loadFromCache(res))
+		return;
+
 	res->_source->loadResource(this, res);
 	if (_patcher) {
 		_patcher->applyPatch(*res);
@@ -629,6 +638,24 @@ Resource *ResourceManager::testResource(ResourceId id) {
 	return _resMap.getVal(id, NULL);
 }
 
+void ResourceManager::prefetchRoom(uint16 roomNumber) {
+	// The resources which share their number with the room
+	static const ResourceType types[] = {
+		kResourceTypeScript, kResourceTypeHeap, kResourceTypePic, kResourceTypeView,
+		kResourceTypePalette, kResourceTypeText, kResourceTypeMessage
+	};
+
+	Common::StringArray filenames;
+	for (int i = 0; i < ARRAYSIZE(types); i++) {
+		const Resource *res = testResource(ResourceId(types[i], roomNumber));
+		if (res && res->_status == kResStatusNoMalloc && res->_source->getSourceType() == kSourcePatch)
+			filenames.push_back(res->_source->getLocationName());
+	}
+
+	if (!filenames.empty())
+		SearchMan.prefetchMembers(filenames);
+}
+
 int ResourceManager::addAppropriateSources() {
 #ifdef ENABLE_SCI32
 	_multiDiscAudio = false;
@@ -990,9 +1017,17 @@ ResourceManager::ResourceManager(const bool detectionMode) :
 
 void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
+	_maxMemoryCache = 4 * _maxMemoryLRU; // Compressed, this holds several times the LRU
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	_lruHead = _lruTail = nullptr;
+	_entriesLRU = 0;
+	_cacheHead = _cacheTail = nullptr;
+	_memoryCache = 0;
+	_memoryCacheUncompressed = 0;
+	_entriesCache = 0;
+	_cacheHits = 0;
+	_cacheMisses = 0;
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 #ifdef ENABLE_SCI32
@@ -1064,6 +1099,7 @@ void ResourceManager::init() {
 	// and making the renderer very slow.
 	if (getSciVersion() >= SCI_VERSION_2) {
 		_maxMemoryLRU = 4096 * 1024; // 4MiB
+		_maxMemoryCache = 4 * _maxMemoryLRU;
 	}
 
 	switch (_viewType) {
@@ -1112,7 +1148,18 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		_lruHead = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		_lruTail = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = nullptr;
+
+	_entriesLRU--;
 	_memoryLRU -= res->size();
 	res->_status = kResStatusAllocated;
 }
@@ -1122,7 +1169,16 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+
+	res->_lruPrev = nullptr;
+	res->_lruNext = _lruHead;
+	if (_lruHead)
+		_lruHead->_lruPrev = res;
+	else
+		_lruTail = res;
+	_lruHead = res;
+
+	_entriesLRU++;
 	_memoryLRU += res->size();
 #if SCI_VERBOSE_RESMAN
 	debug(10, "Adding %s (%d bytes) to lru control: %d bytes total",
@@ -1135,15 +1191,11 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
 
-	while (it != _LRU.end()) {
-		res = *it;
+	for (Resource *res = _lruHead; res; res = res->_lruNext) {
 		debug(10, "\t%s: %u bytes", res->_id.toString().c_str(), res->size());
 		mem += res->size();
 		++entries;
-		++it;
 	}
 
 	debug(10, "Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
@@ -1151,9 +1203,10 @@ void ResourceManager::printLRU() {
 
 void ResourceManager::freeOldResources() {
 	while (_maxMemoryLRU < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = _LRU.back();
+		assert(_lruTail);
+		Resource *goner = _lruTail;
 		removeFromLRU(goner);
+		addToCache(goner);
 		goner->unalloc();
 #ifdef SCI_VERBOSE_RESMAN
 		debug(10, "resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
@@ -1161,6 +1214,107 @@ void ResourceManager::freeOldResources() {
 	}
 }
 
+void ResourceManager::addToCache(Resource *res) {
+	removeFromCache(res);
+
+	const uint32 size = res->size();
+	if (!res->_data || size == 0)
+		return;
+
+	const uint32 bound = Common::getLZ4CompressBound(size);
+	byte *buffer = (byte *)malloc(bound);
+	if (!buffer)
+		return;
+
+	const uint32 compressedSize = Common::compressLZ4(res->_data, size, buffer, bound);
+
+	// Data which hardly compresses, like digital audio, would only push the
+	// other resources out of the cache
+	if (compressedSize == 0 || compressedSize > size - size / 8 || compressedSize > _maxMemoryCache / 8) {
+		free(buffer);
+		return;
+	}
+
+	res->_cachedData = (byte *)realloc(buffer, compressedSize);
+	if (!res->_cachedData)
+		res->_cachedData = buffer;
+	res->_cachedSize = compressedSize;
+
+	res->_cachePrev = nullptr;
+	res->_cacheNext = _cacheHead;
+	if (_cacheHead)
+		_cacheHead->_cachePrev = res;
+	else
+		_cacheTail = res;
+	_cacheHead = res;
+
+	_entriesCache++;
+	_memoryCache += compressedSize;
+	_memoryCacheUncompressed += size;
+
+	while (_memoryCache > _maxMemoryCache)
+		removeFromCache(_cacheTail);
+}
+
+void ResourceManager::removeFromCache(Resource *res) {
+	if (!res->_cachedData)
+		return;
+
+	if (res->_cachePrev)
+		res->_cachePrev->_cacheNext = res->_cacheNext;
+	else
+		_cacheHead = res->_cacheNext;
+	if (res->_cacheNext)
+		res->_cacheNext->_cachePrev = res->_cachePrev;
+	else
+		_cacheTail = res->_cachePrev;
+	res->_cachePrev = res->_cacheNext = nullptr;
+
+	_entriesCache--;
+	_memoryCache -= res->_cachedSize;
+	_memoryCacheUncompressed -= res->size();
+
+	free(res->_cachedData);
+	res->_cachedData = nullptr;
+	res->_cachedSize = 0;
+}
+
+bool ResourceManager::loadFromCache(Resource *res) {
+	if (!res->_cachedData) {
+		_cacheMisses++;
+		return false;
+	}
+
+	// The cached data already had the resource patches applied
+	byte *data = new byte[res->size()];
+	const bool success = Common::decompressLZ4(res->_cachedData, res->_cachedSize, data, res->size());
+	removeFromCache(res);
+
+	if (!success) {
+		warning("resMan: Corrupted cached data of %s", res->_id.toString().c_str());
+		delete[] data;
+		_cacheMisses++;
+		return false;
+	}
+
+	res->_data = data;
+	res->_status = kResStatusAllocated;
+	_cacheHits++;
+	return true;
+}
+
+void ResourceManager::getCacheStats(CacheStats &stats) const {
+	stats.lruEntries = _entriesLRU;
+	stats.lruMemory = _memoryLRU;
+	stats.lruMaxMemory = _maxMemoryLRU;
+	stats.cacheEntries = _entriesCache;
+	stats.cacheMemory = _memoryCache;
+	stats.cacheUncompressedMemory = _memoryCacheUncompressed;
+	stats.cacheMaxMemory = _maxMemoryCache;
+	stats.cacheHits = _cacheHits;
+	stats.cacheMisses = _cacheMisses;
+}
+
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> resources;
 
@@ -2228,6 +2382,8 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 			_resMap.setVal(resId, res);
 		}
 
+		// The cached data of the resource no longer matches its source
+		removeFromCache(res);
 		res->_status = kResStatusNoMalloc;
 		res->_source = src;
 		res->_headerSize = 0;
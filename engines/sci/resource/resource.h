@@ -301,6 +301,13 @@ protected:
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
+	// Links of the LRU list and of the list of compressed resources, both
+	// managed by ResourceManager
+	Resource *_lruPrev, *_lruNext;
+	Resource *_cachePrev, *_cacheNext;
+	byte *_cachedData; /**< LZ4 compressed copy of the data after unloading */
+	uint32 _cachedSize; /**< Size of the compressed data */
+
 	bool loadPatch(Common::SeekableReadStream *file);
 	bool loadFromPatchFile();
 	bool loadFromWaveFile(Common::SeekableReadStream *file);
@@ -329,6 +336,7 @@ class ResourceManager {
 #ifdef ENABLE_SCI32
 	friend class ChunkResourceSource;
 #endif
+	friend class Resource; // for removeFromCache()
 
 public:
 	/**
@@ -383,6 +391,15 @@ public:
 	 */
 	Resource *testResource(ResourceId id);
 
+	/**
+	 * Starts reading the patch files of the resources of a room in the
+	 * background, so that they are already in memory once the room is
+	 * loaded. Resources in volume files are not affected.
+	 *
+	 * @param roomNumber	The number of the room about to be loaded
+	 */
+	void prefetchRoom(uint16 roomNumber);
+
 	/**
 	 * Returns a list of all resources of the specified type.
 	 * @param type		The resource type to look for
@@ -407,6 +424,21 @@ public:
 	const char *getVolVersionDesc() const { return versionDescription(_volVersion); }
 	ResVersion getVolVersion() const { return _volVersion; }
 
+	/** Usage of the resource caches, for the debugger. */
+	struct CacheStats {
+		uint lruEntries;
+		uint32 lruMemory;
+		uint32 lruMaxMemory;
+		uint cacheEntries;
+		uint32 cacheMemory;
+		uint32 cacheUncompressedMemory;
+		uint32 cacheMaxMemory;
+		uint32 cacheHits;
+		uint32 cacheMisses;
+	};
+
+	void getCacheStats(CacheStats &stats) const;
+
 	/**
 	 * Adds the appropriate GM patch from the Sierra MIDI utility as 4.pat, without
 	 * requiring the user to rename the file to 4.pat. Thus, the original Sierra
@@ -489,7 +521,21 @@ protected:
 	SourcesList _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	Resource *_lruHead; ///< Most recently used resource
+	Resource *_lruTail; ///< Least recently used resource
+	uint _entriesLRU; ///< Number of resources under LRU control
+
+	// Resources freed from the LRU keep a compressed copy of their data, so
+	// that using them again needs neither disk accesses nor decompression
+	// of the original resource compression.
+	Resource *_cacheHead; ///< Most recently compressed resource
+	Resource *_cacheTail; ///< Least recently compressed resource
+	uint32 _maxMemoryCache; ///< Maximum amount of compressed bytes kept
+	uint32 _memoryCache; ///< Amount of compressed bytes kept
+	uint32 _memoryCacheUncompressed; ///< Amount of bytes the compressed data expands to
+	uint _entriesCache; ///< Number of compressed resources
+	uint32 _cacheHits; ///< Resources which were loaded from the compressed copy
+	uint32 _cacheMisses; ///< Resources which had to be loaded from their source
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
@@ -636,6 +682,13 @@ protected:
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
 
+	/** Keep a compressed copy of the data of a resource about to be freed. */
+	void addToCache(Resource *res);
+	/** Drop the compressed copy of a resource, if any. */
+	void removeFromCache(Resource *res);
+	/** Restore the data of a resource from its compressed copy. */
+	bool loadFromCache(Resource *res);
+
 	ResourceCompression getViewCompression();
 	ViewType detectViewType();
 	bool hasSci0Voc999();
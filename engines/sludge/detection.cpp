@@ -83,6 +83,11 @@ public:
 		return "Sludge (C) 2000-2014 Hungry Software and contributors";
 	}
 
+	// The fallback detector writes s_fallbackDesc and opens files with Common::File
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	// for fall back detection
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override;
 };
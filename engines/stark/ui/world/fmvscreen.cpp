@@ -43,6 +43,10 @@ FMVScreen::FMVScreen(Gfx::Driver *gfx, Cursor *cursor) :
 	_decoder = new Video::BinkDecoder();
 	_decoder->setDefaultHighColorFormat(Gfx::Driver::getRGBAPixelFormat());
 	_decoder->setSoundType(Audio::Mixer::kSFXSoundType);
+	// The videos are read on a background thread then. They are opened by
+	// ArchiveLoader::getExternalFile() straight from the game directory,
+	// so their streams are not shared with anything else.
+	_decoder->setDecodeAhead(4);
 
 	_texture = _gfx->createTexture();
 	_texture->setSamplingFilter(StarkSettings->getImageSamplingFilter());
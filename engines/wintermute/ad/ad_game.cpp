@@ -1594,6 +1594,12 @@ bool AdGame::scheduleChangeScene(const char *filename, bool fadeIn) {
 
 		_scheduledFadeIn = fadeIn;
 
+		// The scene is loaded once the current one has faded out, so start
+		// reading it now
+		Common::StringArray prefetch;
+		prefetch.push_back(filename);
+		BaseFileManager::getEngineInstance()->prefetchFiles(prefetch);
+
 		return STATUS_OK;
 	}
 }
@@ -343,10 +343,9 @@ void BaseFileManager::initResources() {
 }
 
 //////////////////////////////////////////////////////////////////////////
-Common::SeekableReadStream *BaseFileManager::openPkgFile(const Common::String &filename) {
+Common::String BaseFileManager::getPackageFilename(const Common::String &filename) {
 	Common::String upcName = filename;
 	upcName.toUppercase();
-	Common::SeekableReadStream *file = nullptr;
 
 	// correct slashes
 	for (uint32 i = 0; i < upcName.size(); i++) {
@@ -354,12 +353,21 @@ Common::SeekableReadStream *BaseFileManager::openPkgFile(const Common::String &f
 			upcName.setChar('\\', (uint32)i);
 		}
 	}
-	Common::ArchiveMemberPtr entry = _packages.getMember(upcName);
-	if (!entry) {
-		return nullptr;
+	return upcName;
+}
+
+Common::SeekableReadStream *BaseFileManager::openPkgFile(const Common::String &filename) {
+	// Goes through the SearchSet, which returns prefetched files from memory
+	return _packages.createReadStreamForMember(getPackageFilename(filename));
+}
+
+//////////////////////////////////////////////////////////////////////////
+void BaseFileManager::prefetchFiles(const Common::StringArray &filenames) {
+	Common::StringArray packageFilenames;
+	for (uint32 i = 0; i < filenames.size(); i++) {
+		packageFilenames.push_back(getPackageFilename(filenames[i]));
 	}
-	file = entry->createReadStream();
-	return file;
+	_packages.prefetchMembers(packageFilenames);
 }
 
 //////////////////////////////////////////////////////////////////////////
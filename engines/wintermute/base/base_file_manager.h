@@ -48,6 +48,7 @@ public:
 	Common::SeekableReadStream *openFile(const Common::String &filename, bool absPathWarning = true, bool keepTrackOf = true);
 	Common::WriteStream *openFileForWrite(const Common::String &filename);
 	byte *readWholeFile(const Common::String &filename, uint32 *size = nullptr, bool mustExist = true);
+	void prefetchFiles(const Common::StringArray &filenames);
 	uint32 getPackageVersion(const Common::String &filename);
 
 	BaseFileManager(Common::Language lang, bool detectionMode = false);
@@ -68,6 +69,7 @@ private:
 	Common::SeekableReadStream *openFileRaw(const Common::String &filename);
 	Common::WriteStream *openFileForWriteRaw(const Common::String &filename);
 	Common::SeekableReadStream *openPkgFile(const Common::String &filename);
+	static Common::String getPackageFilename(const Common::String &filename);
 	Common::FSList _packagePaths;
 	bool registerPackage(Common::FSNode package, const Common::String &filename = "", bool searchSignature = false);
 	bool _detectionMode;
@@ -203,11 +203,19 @@ Common::SeekableReadStream *openDiskFile(const Common::String &filename) {
 			compSize = file->readUint32LE();
 			uncompSize = file->readUint32LE();
 
-			byte *compBuffer = new byte[compSize];
-			if (!compBuffer) {
-				error("Error allocating memory for compressed file '%s'", filename.c_str());
-				delete file;
-				return nullptr;
+			// Memory-mapped files can be uncompressed without a copy
+			const byte *rawData = file->getRawData();
+			byte *compBuffer = nullptr;
+			if (rawData && dataOffset + prefixSize + compSize <= (uint32)file->size()) {
+				rawData += dataOffset + prefixSize;
+			} else {
+				compBuffer = new byte[compSize];
+				if (!compBuffer) {
+					error("Error allocating memory for compressed file '%s'", filename.c_str());
+					delete file;
+					return nullptr;
+				}
+				rawData = compBuffer;
 			}
 
 			byte *data = new byte[uncompSize];
@@ -217,10 +225,13 @@ Common::SeekableReadStream *openDiskFile(const Common::String &filename) {
 				delete file;
 				return nullptr;
 			}
-			file->seek(dataOffset + prefixSize, SEEK_SET);
-			file->read(compBuffer, compSize);
 
-			if (Common::uncompress(data, &uncompSize, compBuffer, compSize) != true) {
+			if (compBuffer) {
+				file->seek(dataOffset + prefixSize, SEEK_SET);
+				file->read(compBuffer, compSize);
+			}
+
+			if (Common::uncompress(data, &uncompSize, rawData, compSize) != true) {
 				error("Error uncompressing file '%s'", filename.c_str());
 				delete[] compBuffer;
 				delete file;
@@ -41,6 +41,8 @@ class BaseFileEntry : public Common::ArchiveMember {
 public:
 	Common::SeekableReadStream *createReadStream() const override;
 	Common::String getName() const override { return _filename; }
+	// Every stream opens the package file again
+	bool isThreadSafe() const override { return true; }
 	uint32 _timeDate2;
 	uint32 _timeDate1;
 	uint32 _flags;
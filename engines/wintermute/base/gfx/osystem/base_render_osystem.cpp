@@ -34,12 +34,14 @@
 #include "engines/wintermute/math/math_util.h"
 #include "engines/wintermute/base/base_game.h"
 #include "engines/wintermute/base/base_sprite.h"
+#include "engines/wintermute/base/font/base_font.h"
 #include "common/system.h"
 #include "graphics/transparent_surface.h"
 #include "common/queue.h"
 #include "common/config-manager.h"
 
 #define DIRTY_RECT_LIMIT 800
+#define DIRTY_TILE_SIZE 32
 
 namespace Wintermute {
 
@@ -58,6 +60,8 @@ BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
 	_borderLeft = _borderRight = _borderTop = _borderBottom = 0;
 	_ratioX = _ratioY = 1.0f;
 	_dirtyRect = nullptr;
+	_tilesX = _tilesY = 0;
+	_redrawnPixels = _redrawnRects = 0;
 	_disableDirtyRects = false;
 	if (ConfMan.hasKey("dirty_rects")) {
 		_disableDirtyRects = !ConfMan.getBool("dirty_rects");
@@ -140,6 +144,11 @@ bool BaseRenderOSystem::initRenderer(int width, int height, bool windowed) {
 	_blankSurface->fillRect(Common::Rect(0, 0, _blankSurface->h, _blankSurface->w), _blankSurface->format.ARGBToColor(255, 0, 0, 0));
 	_active = true;
 
+	_tilesX = (_renderSurface->w + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+	_tilesY = (_renderSurface->h + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+	_dirtyTiles.resize(_tilesX * _tilesY);
+	clearDirtyRects();
+
 	_clearColor = _renderSurface->format.ARGBToColor(255, 0, 0, 0);
 
 	return STATUS_OK;
@@ -162,8 +171,7 @@ bool BaseRenderOSystem::forcedFlip() {
 bool BaseRenderOSystem::flip() {
 	if (_skipThisFrame) {
 		_skipThisFrame = false;
-		delete _dirtyRect;
-		_dirtyRect = nullptr;
+		clearDirtyRects();
 		g_system->updateScreen();
 		_needsFlip = false;
 
@@ -202,9 +210,12 @@ bool BaseRenderOSystem::flip() {
 		if (_disableDirtyRects || screenChanged) {
 			g_system->copyRectToScreen((byte *)_renderSurface->getPixels(), _renderSurface->pitch, 0, 0, _renderSurface->w, _renderSurface->h);
 		}
+		if (_disableDirtyRects) {
+			_redrawnPixels = _renderSurface->w * _renderSurface->h;
+			_redrawnRects = 1;
+		}
 		//  g_system->copyRectToScreen((byte *)_renderSurface->getPixels(), _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
-		delete _dirtyRect;
-		_dirtyRect = nullptr;
+		clearDirtyRects();
 		_needsFlip = false;
 	}
 	_lastFrameIter = _renderQueue.end();
@@ -386,12 +397,89 @@ void BaseRenderOSystem::drawFromQueuedTicket(const RenderQueueIterator &ticket)
 }
 
 void BaseRenderOSystem::addDirtyRect(const Common::Rect &rect) {
+	Common::Rect dirty(rect);
+	dirty.clip(_renderRect);
+	if (dirty.isEmpty()) {
+		return;
+	}
+
 	if (!_dirtyRect) {
-		_dirtyRect = new Common::Rect(rect);
+		_dirtyRect = new Common::Rect(dirty);
 	} else {
-		_dirtyRect->extend(rect);
+		_dirtyRect->extend(dirty);
+	}
+
+	if (_dirtyTiles.empty()) {
+		return;
+	}
+
+	int left = CLIP<int>(dirty.left / DIRTY_TILE_SIZE, 0, _tilesX - 1);
+	int right = CLIP<int>((dirty.right - 1) / DIRTY_TILE_SIZE, 0, _tilesX - 1);
+	int top = CLIP<int>(dirty.top / DIRTY_TILE_SIZE, 0, _tilesY - 1);
+	int bottom = CLIP<int>((dirty.bottom - 1) / DIRTY_TILE_SIZE, 0, _tilesY - 1);
+	for (int y = top; y <= bottom; y++) {
+		for (int x = left; x <= right; x++) {
+			_dirtyTiles[y * _tilesX + x] = true;
+		}
+	}
+}
+
+void BaseRenderOSystem::clearDirtyRects() {
+	delete _dirtyRect;
+	_dirtyRect = nullptr;
+
+	for (uint i = 0; i < _dirtyTiles.size(); i++) {
+		_dirtyTiles[i] = false;
+	}
+}
+
+void BaseRenderOSystem::collectDirtyRects() {
+	_dirtyRects.clear();
+
+	if (_dirtyTiles.empty()) {
+		_dirtyRects.push_back(*_dirtyRect);
+		return;
+	}
+
+	// Merge each row of tiles into runs, and each run with the rect above
+	// it if that spans the same columns.
+	for (int y = 0; y < _tilesY; y++) {
+		int x = 0;
+		while (x < _tilesX) {
+			if (!_dirtyTiles[y * _tilesX + x]) {
+				x++;
+				continue;
+			}
+
+			int runStart = x;
+			while (x < _tilesX && _dirtyTiles[y * _tilesX + x]) {
+				x++;
+			}
+
+			Common::Rect run(runStart * DIRTY_TILE_SIZE, y * DIRTY_TILE_SIZE, x * DIRTY_TILE_SIZE, (y + 1) * DIRTY_TILE_SIZE);
+			bool merged = false;
+			for (uint i = 0; i < _dirtyRects.size(); i++) {
+				Common::Rect &above = _dirtyRects[i];
+				if (above.left == run.left && above.right == run.right && above.bottom == run.top) {
+					above.bottom = run.bottom;
+					merged = true;
+					break;
+				}
+			}
+			if (!merged) {
+				_dirtyRects.push_back(run);
+			}
+		}
+	}
+
+	// Never redraw more than the dirty area itself covers
+	for (uint i = 0; i < _dirtyRects.size(); i++) {
+		_dirtyRects[i].clip(*_dirtyRect);
+		if (_dirtyRects[i].isEmpty()) {
+			_dirtyRects.remove_at(i);
+			i--;
+		}
 	}
-	_dirtyRect->clip(_renderRect);
 }
 
 void BaseRenderOSystem::drawTickets() {
@@ -417,46 +505,58 @@ void BaseRenderOSystem::drawTickets() {
 			ticket->_wantsDraw = false;
 			++it;
 		}
+		_redrawnPixels = _redrawnRects = 0;
 		return;
 	}
 
+	collectDirtyRects();
+
 	it = _renderQueue.begin();
 	_lastFrameIter = _renderQueue.end();
 	// A special case: If the screen has one giant OPAQUE rect to be drawn, then we skip filling
 	// the background color. Typical use-case: Fullscreen FMVs.
 	// Caveat: The FPS-counter will invalidate this.
-	if (it != _lastFrameIter && _renderQueue.front() == _renderQueue.back() && (*it)->_transform._alphaDisable == true) {
+	bool singleOpaque = it != _lastFrameIter && _renderQueue.front() == _renderQueue.back() && (*it)->_transform._alphaDisable == true;
+	for (uint i = 0; i < _dirtyRects.size(); i++) {
 		// If our single opaque rect fills the dirty rect, we can skip filling.
-		if (*_dirtyRect != (*it)->_dstRect) {
+		if (!singleOpaque || !(*it)->_dstRect.contains(_dirtyRects[i])) {
 			// Apply the clear-color to the dirty rect.
-			_renderSurface->fillRect(*_dirtyRect, _clearColor);
+			_renderSurface->fillRect(_dirtyRects[i], _clearColor);
 		}
-		// Otherwise Do NOT fill.
-	} else {
-		// Apply the clear-color to the dirty rect.
-		_renderSurface->fillRect(*_dirtyRect, _clearColor);
 	}
 	for (; it != _renderQueue.end(); ++it) {
 		RenderTicket *ticket = *it;
 		if (ticket->_dstRect.intersects(*_dirtyRect)) {
-			// dstClip is the area we want redrawn.
-			Common::Rect dstClip(ticket->_dstRect);
-			// reduce it to the dirty rect
-			dstClip.clip(*_dirtyRect);
-			// we need to keep track of the position to redraw the dirty rect
-			Common::Rect pos(dstClip);
-			int16 offsetX = ticket->_dstRect.left;
-			int16 offsetY = ticket->_dstRect.top;
-			// convert from screen-coords to surface-coords.
-			dstClip.translate(-offsetX, -offsetY);
-
-			drawFromSurface(ticket, &pos, &dstClip);
-			_needsFlip = true;
+			for (uint i = 0; i < _dirtyRects.size(); i++) {
+				if (!ticket->_dstRect.intersects(_dirtyRects[i])) {
+					continue;
+				}
+				// dstClip is the area we want redrawn.
+				Common::Rect dstClip(ticket->_dstRect);
+				// reduce it to the dirty rect
+				dstClip.clip(_dirtyRects[i]);
+				// we need to keep track of the position to redraw the dirty rect
+				Common::Rect pos(dstClip);
+				int16 offsetX = ticket->_dstRect.left;
+				int16 offsetY = ticket->_dstRect.top;
+				// convert from screen-coords to surface-coords.
+				dstClip.translate(-offsetX, -offsetY);
+
+				drawFromSurface(ticket, &pos, &dstClip);
+				_needsFlip = true;
+			}
 		}
 		// Some tickets want redraw but don't actually clip the dirty area (typically the ones that shouldnt become clear-color)
 		ticket->_wantsDraw = false;
 	}
-	g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(_dirtyRect->left, _dirtyRect->top), _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
+
+	_redrawnPixels = 0;
+	_redrawnRects = _dirtyRects.size();
+	for (uint i = 0; i < _dirtyRects.size(); i++) {
+		const Common::Rect &rect = _dirtyRects[i];
+		g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(rect.left, rect.top), _renderSurface->pitch, rect.left, rect.top, rect.width(), rect.height());
+		_redrawnPixels += rect.width() * rect.height();
+	}
 
 	it = _renderQueue.begin();
 	// Clean out the old tickets
@@ -527,6 +627,14 @@ Common::String BaseRenderOSystem::getName() const {
 	return "ScummVM-OSystem-renderer";
 }
 
+//////////////////////////////////////////////////////////////////////////
+bool BaseRenderOSystem::displayDebugInfo() {
+	char str[100];
+	sprintf(str, "Redrawn: %u px in %u rects", _redrawnPixels, _redrawnRects);
+	_gameRef->getSystemFont()->drawText((byte *)str, 0, 190, _width, TAL_RIGHT);
+	return STATUS_OK;
+}
+
 //////////////////////////////////////////////////////////////////////////
 bool BaseRenderOSystem::setViewport(int left, int top, int right, int bottom) {
 	Common::Rect rect;
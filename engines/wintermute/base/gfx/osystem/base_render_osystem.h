@@ -53,6 +53,10 @@ class RenderTicket;
  * being equal, this information is then used to check whether the draw order changed,
  * which will then create a need for redrawing, as we draw with an alpha-channel here.
  *
+ * The dirty areas are tracked in a grid of tiles, so that changes in different
+ * parts of the screen are redrawn as separate rects, rather than as the one
+ * rect bounding all of them.
+ *
  * There is also a draw path that draws without tickets, for debugging purposes,
  * as well as to accomodate situations with large enough amounts of draw calls,
  * that there will be too much overhead involved with comparing the generated tickets.
@@ -65,6 +69,7 @@ public:
 	typedef Common::List<RenderTicket *>::iterator RenderQueueIterator;
 
 	Common::String getName() const override;
+	bool displayDebugInfo() override;
 
 	bool initRenderer(int width, int height, bool windowed) override;
 	bool flip() override;
@@ -121,6 +126,14 @@ private:
 	 * @param rect the region to be marked as dirty
 	 */
 	void addDirtyRect(const Common::Rect &rect);
+	/**
+	 * Forget about all dirty regions
+	 */
+	void clearDirtyRects();
+	/**
+	 * Merge the dirty tiles into the rects to redraw (_dirtyRects)
+	 */
+	void collectDirtyRects();
 	/**
 	 * Traverse the tickets that are dirty, and draw them
 	 */
@@ -129,9 +142,17 @@ private:
 	void drawFromSurface(RenderTicket *ticket);
 	// Dirty-rects:
 	void drawFromSurface(RenderTicket *ticket, Common::Rect *dstRect, Common::Rect *clipRect);
-	Common::Rect *_dirtyRect;
+	Common::Rect *_dirtyRect; // bounds of the dirty tiles
+	Common::Array<bool> _dirtyTiles;
+	int _tilesX;
+	int _tilesY;
+	Common::Array<Common::Rect> _dirtyRects;
 	Common::List<RenderTicket *> _renderQueue;
 
+	// Statistics of the last frame, for the debug display
+	uint32 _redrawnPixels;
+	uint32 _redrawnRects;
+
 	bool _needsFlip;
 	RenderQueueIterator _lastFrameIter;
 	Common::Rect _renderRect;
@@ -245,10 +245,38 @@ bool ScScript::initTables() {
 
 	_iP = origIP;
 
+	initLookupTables();
+
 	return STATUS_OK;
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+void ScScript::initLookupTables() {
+	_eventMap.clear(true);
+	_methodMap.clear(true);
+	_externalMap.clear(true);
+
+	// the last event handler of a given name wins
+	for (uint32 i = 0; i < _numEvents; i++) {
+		_eventMap[_events[i].name] = _events[i].pos;
+	}
+
+	// the first method and external function of a given name win
+	for (uint32 i = 0; i < _numMethods; i++) {
+		if (!_methodMap.contains(_methods[i].name)) {
+			_methodMap[_methods[i].name] = _methods[i].pos;
+		}
+	}
+
+	for (uint32 i = 0; i < _numExternals; i++) {
+		if (!_externalMap.contains(_externals[i].name)) {
+			_externalMap[_externals[i].name] = &_externals[i];
+		}
+	}
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 bool ScScript::create(const char *filename, byte *buffer, uint32 size, BaseScriptHolder *owner) {
 	cleanup();
@@ -458,6 +486,10 @@ void ScScript::cleanup() {
 	_externals = nullptr;
 	_numExternals = 0;
 
+	_eventMap.clear(true);
+	_methodMap.clear(true);
+	_externalMap.clear(true);
+
 	delete _operand;
 	delete _reg1;
 	_operand = nullptr;
@@ -1175,12 +1207,7 @@ uint32 ScScript::getFuncPos(const Common::String &name) {
 
 //////////////////////////////////////////////////////////////////////////
 uint32 ScScript::getMethodPos(const Common::String &name) const {
-	for (uint32 i = 0; i < _numMethods; i++) {
-		if (name == _methods[i].name) {
-			return _methods[i].pos;
-		}
-	}
-	return 0;
+	return _methodMap.getVal(name, 0);
 }
 
 
@@ -1409,12 +1436,7 @@ ScScript *ScScript::invokeEventHandler(const Common::String &eventName, bool unb
 
 //////////////////////////////////////////////////////////////////////////
 uint32 ScScript::getEventPos(const Common::String &name) const {
-	for (int i = _numEvents - 1; i >= 0; i--) {
-		if (scumm_stricmp(name.c_str(), _events[i].name) == 0) {
-			return _events[i].pos;
-		}
-	}
-	return 0;
+	return _eventMap.getVal(name, 0);
 }
 
 
@@ -1461,12 +1483,11 @@ bool ScScript::resume() {
 
 //////////////////////////////////////////////////////////////////////////
 ScScript::TExternalFunction *ScScript::getExternal(char *name) {
-	for (uint32 i = 0; i < _numExternals; i++) {
-		if (strcmp(name, _externals[i].name) == 0) {
-			return &_externals[i];
-		}
+	ExternalMap::iterator it = _externalMap.find(name);
+	if (it == _externalMap.end()) {
+		return nullptr;
 	}
-	return nullptr;
+	return it->_value;
 }
 
 
@@ -162,8 +162,18 @@ private:
 	uint32 _numMethods;
 	uint32 _numEvents;
 
+	// Lookup tables built from the tables above. Event names are matched
+	// case-insensitively, method and external function names exactly.
+	typedef Common::HashMap<Common::String, uint32, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> EventMap;
+	typedef Common::HashMap<Common::String, uint32> MethodMap;
+	typedef Common::HashMap<Common::String, TExternalFunction *> ExternalMap;
+	EventMap _eventMap;
+	MethodMap _methodMap;
+	ExternalMap _externalMap;
+
 	bool initScript();
 	bool initTables();
+	void initLookupTables();
 
 	virtual void preInstHook(uint32 inst);
 	virtual void postInstHook(uint32 inst);
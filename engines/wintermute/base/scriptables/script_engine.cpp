@@ -75,9 +75,7 @@ ScEngine::ScEngine(BaseGame *inGame) : BaseClass(inGame) {
 	}
 
 	// prepare script cache
-	for (int i = 0; i < MAX_CACHED_SCRIPTS; i++) {
-		_cachedScripts[i] = nullptr;
-	}
+	_cachedScriptsSize = 0;
 
 	_currentScript = nullptr;
 
@@ -199,12 +197,17 @@ bool ScEngine::isRunningScript(const char *filename) {
 byte *ScEngine::getCompiledScript(const char *filename, uint32 *outSize, bool ignoreCache) {
 	// is script in cache?
 	if (!ignoreCache) {
-		for (int i = 0; i < MAX_CACHED_SCRIPTS; i++) {
-			if (_cachedScripts[i] && scumm_stricmp(_cachedScripts[i]->_filename.c_str(), filename) == 0) {
-				_cachedScripts[i]->_timestamp = g_system->getMillis();
-				*outSize = _cachedScripts[i]->_size;
-				return _cachedScripts[i]->_buffer;
-			}
+		CachedScriptMap::iterator it = _cachedScriptsByName.find(filename);
+		if (it != _cachedScriptsByName.end()) {
+			CScCachedScript *cachedScript = *it->_value;
+
+			// move it to the front of the list
+			_cachedScripts.erase(it->_value);
+			_cachedScripts.push_front(cachedScript);
+			it->_value = _cachedScripts.begin();
+
+			*outSize = cachedScript->_size;
+			return cachedScript->_buffer;
 		}
 	}
 
@@ -240,22 +243,26 @@ byte *ScEngine::getCompiledScript(const char *filename, uint32 *outSize, bool ig
 	// add script to cache
 	CScCachedScript *cachedScript = new CScCachedScript(filename, compBuffer, compSize);
 	if (cachedScript) {
-		int index = 0;
-		uint32 minTime = g_system->getMillis();
-		for (int i = 0; i < MAX_CACHED_SCRIPTS; i++) {
-			if (_cachedScripts[i] == nullptr) {
-				index = i;
-				break;
-			} else if (_cachedScripts[i]->_timestamp <= minTime) {
-				minTime = _cachedScripts[i]->_timestamp;
-				index = i;
-			}
+		// replace an outdated copy of the script, when reloading it
+		CachedScriptMap::iterator it = _cachedScriptsByName.find(filename);
+		if (it != _cachedScriptsByName.end()) {
+			_cachedScriptsSize -= (*it->_value)->_size;
+			delete *it->_value;
+			_cachedScripts.erase(it->_value);
 		}
 
-		if (_cachedScripts[index] != nullptr) {
-			delete _cachedScripts[index];
+		_cachedScripts.push_front(cachedScript);
+		_cachedScriptsByName[cachedScript->_filename] = _cachedScripts.begin();
+		_cachedScriptsSize += cachedScript->_size;
+
+		// drop the least recently used scripts, but always keep the new one
+		while (_cachedScriptsSize > MAX_CACHED_SCRIPTS_SIZE && _cachedScripts.back() != cachedScript) {
+			CScCachedScript *oldest = _cachedScripts.back();
+			_cachedScripts.pop_back();
+			_cachedScriptsByName.erase(oldest->_filename);
+			_cachedScriptsSize -= oldest->_size;
+			delete oldest;
 		}
-		_cachedScripts[index] = cachedScript;
 
 		ret = cachedScript->_buffer;
 		*outSize = cachedScript->_size;
@@ -480,12 +487,12 @@ int ScEngine::getNumScripts(int *running, int *waiting, int *persistent) {
 
 //////////////////////////////////////////////////////////////////////////
 bool ScEngine::emptyScriptCache() {
-	for (int i = 0; i < MAX_CACHED_SCRIPTS; i++) {
-		if (_cachedScripts[i]) {
-			delete _cachedScripts[i];
-			_cachedScripts[i] = nullptr;
-		}
+	for (CachedScriptList::iterator it = _cachedScripts.begin(); it != _cachedScripts.end(); ++it) {
+		delete *it;
 	}
+	_cachedScripts.clear();
+	_cachedScriptsByName.clear();
+	_cachedScriptsSize = 0;
 	return STATUS_OK;
 }
 
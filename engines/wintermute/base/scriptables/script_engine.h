@@ -32,10 +32,12 @@
 #include "engines/wintermute/persistent.h"
 #include "engines/wintermute/coll_templ.h"
 #include "engines/wintermute/base/base.h"
+#include "common/list.h"
 
 namespace Wintermute {
 
-#define MAX_CACHED_SCRIPTS 20
+// total size of the compiled scripts kept in the cache
+#define MAX_CACHED_SCRIPTS_SIZE (2 * 1024 * 1024)
 class ScScript;
 class ScValue;
 class BaseObject;
@@ -45,7 +47,6 @@ public:
 	class CScCachedScript {
 	public:
 		CScCachedScript(const char *filename, byte *buffer, uint32 size) {
-			_timestamp = g_system->getMillis();
 			_buffer = new byte[size];
 			if (_buffer) {
 				memcpy(_buffer, buffer, size);
@@ -60,7 +61,6 @@ public:
 			}
 		};
 
-		uint32 _timestamp;
 		byte *_buffer;
 		uint32 _size;
 		Common::String _filename;
@@ -108,7 +108,12 @@ public:
 
 private:
 
-	CScCachedScript *_cachedScripts[MAX_CACHED_SCRIPTS];
+	// compiled scripts, most recently used first
+	typedef Common::List<CScCachedScript *> CachedScriptList;
+	typedef Common::HashMap<Common::String, CachedScriptList::iterator, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> CachedScriptMap;
+	CachedScriptList _cachedScripts;
+	CachedScriptMap _cachedScriptsByName;
+	uint32 _cachedScriptsSize;
 	bool _isProfiling;
 	uint32 _profilingStartTime;
 
@@ -33,14 +33,73 @@
 #include "engines/wintermute/base/scriptables/script.h"
 #include "engines/wintermute/utils/string_util.h"
 #include "engines/wintermute/base/base_scriptable.h"
+#include "common/memorypool.h"
 
 namespace Wintermute {
 
+// objects with more properties than this get a hash index
+#define MAX_UNINDEXED_PROPS 8
+
+//////////////////////////////////////////////////////////////////////////
+// Values are created and destroyed all the time by running scripts, so
+// they come from a memory pool. The pool is created with the first value
+// and freed along with the last one.
+static Common::MemoryPool *g_valuePool = nullptr;
+static uint32 g_numPooledValues = 0;
+
+//////////////////////////////////////////////////////////////////////////
+// Table of interned property names, kept as long as any value has
+// properties. The names are owned by the table.
+struct PropertyNames {
+	~PropertyNames() {
+		for (uint32 i = 0; i < _names.size(); i++) {
+			delete[] _names[i];
+		}
+	}
+
+	struct EqualTo {
+		bool operator()(const char *x, const char *y) const { return strcmp(x, y) == 0; }
+	};
+
+	Common::FlatHashMap<const char *, uint32, Common::Hash<const char *>, EqualTo> _ids;
+	Common::Array<char *> _names;
+};
+
+static PropertyNames *g_propNames = nullptr;
+static uint32 g_numValuesWithProps = 0;
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
 
-IMPLEMENT_PERSISTENT(ScValue, false)
+IMPLEMENT_PERSISTENT_ALLOC(ScValue, false, allocate, release)
+
+//////////////////////////////////////////////////////////////////////////
+void *ScValue::allocate(size_t size) {
+	assert(size == sizeof(ScValue));
+
+	if (!g_valuePool) {
+		g_valuePool = new Common::MemoryPool(sizeof(ScValue));
+	}
+	g_numPooledValues++;
+
+	return g_valuePool->allocChunk();
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+void ScValue::release(void *ptr) {
+	if (!ptr) {
+		return;
+	}
+
+	g_valuePool->freeChunk(ptr);
+
+	if (--g_numPooledValues == 0) {
+		delete g_valuePool;
+		g_valuePool = nullptr;
+	}
+}
 
 //////////////////////////////////////////////////////////////////////////
 ScValue::ScValue(BaseGame *inGame) : BaseClass(inGame) {
@@ -183,24 +242,89 @@ ScValue *ScValue::getProp(const char *name) {
 	}
 
 	if (ret == nullptr) {
-		_valIter = _valObject.find(name);
-		if (_valIter != _valObject.end()) {
-			ret = _valIter->_value;
+		Property *prop = findProp(name);
+		if (prop) {
+			ret = prop->_value;
 		}
 	}
 	return ret;
 }
 
+
+//////////////////////////////////////////////////////////////////////////
+ScValue::Property *ScValue::findProp(const char *name) {
+	if (_valObject.empty()) {
+		return nullptr;
+	}
+
+	// a name that was never interned can't be the name of a property
+	uint32 id;
+	if (!g_propNames || !g_propNames->_ids.tryGetVal(name, id)) {
+		return nullptr;
+	}
+
+	if (_valIndex) {
+		PropertyIndex::const_iterator it = _valIndex->find(id);
+		return (it != _valIndex->end()) ? &_valObject[it->_value] : nullptr;
+	}
+
+	for (uint32 i = 0; i < _valObject.size(); i++) {
+		if (_valObject[i]._name == id) {
+			return &_valObject[i];
+		}
+	}
+	return nullptr;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+void ScValue::addProp(const char *name, ScValue *val) {
+	if (_valObject.empty()) {
+		if (!g_propNames) {
+			g_propNames = new PropertyNames();
+		}
+		g_numValuesWithProps++;
+	}
+
+	uint32 id;
+	if (!g_propNames->_ids.tryGetVal(name, id)) {
+		char *internedName = scumm_strdup(name);
+		id = g_propNames->_names.size();
+		g_propNames->_names.push_back(internedName);
+		g_propNames->_ids[internedName] = id;
+	}
+
+	Property prop;
+	prop._name = id;
+	prop._value = val;
+	_valObject.push_back(prop);
+
+	if (_valIndex) {
+		(*_valIndex)[id] = _valObject.size() - 1;
+	} else if (_valObject.size() > MAX_UNINDEXED_PROPS) {
+		_valIndex.reset(new PropertyIndex());
+		for (uint32 i = 0; i < _valObject.size(); i++) {
+			(*_valIndex)[_valObject[i]._name] = i;
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+const char *ScValue::getPropName(const Property &prop) {
+	return g_propNames->_names[prop._name];
+}
+
 //////////////////////////////////////////////////////////////////////////
 bool ScValue::deleteProp(const char *name) {
 	if (_type == VAL_VARIABLE_REF) {
 		return _valRef->deleteProp(name);
 	}
 
-	_valIter = _valObject.find(name);
-	if (_valIter != _valObject.end()) {
-		delete _valIter->_value;
-		_valIter->_value = nullptr;
+	Property *prop = findProp(name);
+	if (prop) {
+		delete prop->_value;
+		prop->_value = nullptr;
 	}
 
 	return STATUS_OK;
@@ -222,9 +346,9 @@ bool ScValue::setProp(const char *name, ScValue *val, bool copyWhole, bool setAs
 	if (DID_FAIL(ret)) {
 		ScValue *newVal = nullptr;
 
-		_valIter = _valObject.find(name);
-		if (_valIter != _valObject.end()) {
-			newVal = _valIter->_value;
+		Property *prop = findProp(name);
+		if (prop) {
+			newVal = prop->_value;
 		}
 		if (!newVal) {
 			newVal = new ScValue(_gameRef);
@@ -234,7 +358,11 @@ bool ScValue::setProp(const char *name, ScValue *val, bool copyWhole, bool setAs
 
 		newVal->copy(val, copyWhole);
 		newVal->_isConstVar = setAsConst;
-		_valObject[name] = newVal;
+		if (prop) {
+			prop->_value = newVal;
+		} else {
+			addProp(name, newVal);
+		}
 
 		if (_type != VAL_NATIVE) {
 			_type = VAL_OBJECT;
@@ -264,31 +392,36 @@ bool ScValue::propExists(const char *name) {
 	if (_type == VAL_VARIABLE_REF) {
 		return _valRef->propExists(name);
 	}
-	_valIter = _valObject.find(name);
-
-	return (_valIter != _valObject.end());
+	return findProp(name) != nullptr;
 }
 
 
 //////////////////////////////////////////////////////////////////////////
 void ScValue::deleteProps() {
-	_valIter = _valObject.begin();
-	while (_valIter != _valObject.end()) {
-		delete(ScValue *)_valIter->_value;
-		_valIter++;
+	if (_valObject.empty()) {
+		return;
+	}
+
+	for (uint32 i = 0; i < _valObject.size(); i++) {
+		delete _valObject[i]._value;
 	}
 	_valObject.clear();
+	_valIndex.reset();
+
+	if (--g_numValuesWithProps == 0) {
+		delete g_propNames;
+		g_propNames = nullptr;
+	}
 }
 
 
 //////////////////////////////////////////////////////////////////////////
 void ScValue::CleanProps(bool includingNatives) {
-	_valIter = _valObject.begin();
-	while (_valIter != _valObject.end()) {
-		if (!_valIter->_value->_isConstVar && (!_valIter->_value->isNative() || includingNatives)) {
-			_valIter->_value->setNULL();
+	for (uint32 i = 0; i < _valObject.size(); i++) {
+		ScValue *val = _valObject[i]._value;
+		if (!val->_isConstVar && (!val->isNative() || includingNatives)) {
+			val->setNULL();
 		}
-		_valIter++;
 	}
 }
 
@@ -740,15 +873,13 @@ void ScValue::copy(ScValue *orig, bool copyWhole) {
 //!!!! ref->native++
 
 	// copy properties
+	// (our own properties are gone after the cleanup above)
 	if (orig->_type == VAL_OBJECT && orig->_valObject.size() > 0) {
-		orig->_valIter = orig->_valObject.begin();
-		while (orig->_valIter != orig->_valObject.end()) {
-			_valObject[orig->_valIter->_key] = new ScValue(_gameRef);
-			_valObject[orig->_valIter->_key]->copy(orig->_valIter->_value);
-			orig->_valIter++;
+		for (uint32 i = 0; i < orig->_valObject.size(); i++) {
+			ScValue *val = new ScValue(_gameRef);
+			val->copy(orig->_valObject[i]._value);
+			addProp(getPropName(orig->_valObject[i]), val);
 		}
-	} else {
-		_valObject.clear();
 	}
 }
 
@@ -804,13 +935,10 @@ bool ScValue::persist(BasePersistenceManager *persistMgr) {
 	if (persistMgr->getIsSaving()) {
 		size = _valObject.size();
 		persistMgr->transferSint32("", &size);
-		_valIter = _valObject.begin();
-		while (_valIter != _valObject.end()) {
-			str = _valIter->_key.c_str();
+		for (uint32 i = 0; i < _valObject.size(); i++) {
+			str = getPropName(_valObject[i]);
 			persistMgr->transferConstChar("", &str);
-			persistMgr->transferPtr("", &_valIter->_value);
-
-			_valIter++;
+			persistMgr->transferPtr("", &_valObject[i]._value);
 		}
 	} else {
 		ScValue *val = nullptr;
@@ -819,7 +947,12 @@ bool ScValue::persist(BasePersistenceManager *persistMgr) {
 			persistMgr->transferConstChar("", &str);
 			persistMgr->transferPtr("", &val);
 
-			_valObject[str] = val;
+			Property *prop = findProp(str);
+			if (prop) {
+				prop->_value = val;
+			} else {
+				addProp(str, val);
+			}
 			delete[] str;
 		}
 	}
@@ -884,14 +1017,11 @@ bool ScValue::persist(BasePersistenceManager *persistMgr) {
 
 //////////////////////////////////////////////////////////////////////////
 bool ScValue::saveAsText(BaseDynamicBuffer *buffer, int indent) {
-	_valIter = _valObject.begin();
-	while (_valIter != _valObject.end()) {
+	for (uint32 i = 0; i < _valObject.size(); i++) {
 		buffer->putTextIndent(indent, "PROPERTY {\n");
-		buffer->putTextIndent(indent + 2, "NAME=\"%s\"\n", _valIter->_key.c_str());
-		buffer->putTextIndent(indent + 2, "VALUE=\"%s\"\n", _valIter->_value->getString());
+		buffer->putTextIndent(indent + 2, "NAME=\"%s\"\n", getPropName(_valObject[i]));
+		buffer->putTextIndent(indent + 2, "VALUE=\"%s\"\n", _valObject[i]._value->getString());
 		buffer->putTextIndent(indent, "}\n\n");
-
-		_valIter++;
 	}
 	return STATUS_OK;
 }
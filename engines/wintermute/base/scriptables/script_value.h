@@ -34,6 +34,8 @@
 #include "engines/wintermute/persistent.h"
 #include "engines/wintermute/base/scriptables/dcscript.h"   // Added by ClassView
 #include "common/str.h"
+#include "common/ptr.h"
+#include "common/flat-hashmap.h"
 
 namespace Wintermute {
 
@@ -98,14 +100,35 @@ public:
 	ScValue(BaseGame *inGame, double Val);
 	ScValue(BaseGame *inGame, const char *Val);
 	~ScValue() override;
-	Common::HashMap<Common::String, ScValue *> _valObject;
-	Common::HashMap<Common::String, ScValue *>::iterator _valIter;
+
+	// Object property. Property names are interned, so that properties can
+	// be matched by comparing numbers.
+	struct Property {
+		uint32 _name;
+		ScValue *_value;
+	};
+
+	// object properties, in the order they were first set
+	Common::Array<Property> _valObject;
+	static const char *getPropName(const Property &prop);
 
 	bool setProperty(const char *propName, int32 value);
 	bool setProperty(const char *propName, const char *value);
 	bool setProperty(const char *propName, double value);
 	bool setProperty(const char *propName, bool value);
 	bool setProperty(const char *propName);
+
+private:
+	// position of each property in _valObject, only kept for objects with
+	// many properties
+	typedef Common::FlatHashMap<uint32, uint> PropertyIndex;
+	Common::ScopedPtr<PropertyIndex> _valIndex;
+
+	Property *findProp(const char *name);
+	void addProp(const char *name, ScValue *val);
+
+	static void *allocate(size_t size);
+	static void release(void *ptr);
 };
 
 } // End of namespace Wintermute
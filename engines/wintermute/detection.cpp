@@ -89,6 +89,11 @@ public:
 		return "Copyright (C) 2011 Jan Nedoma";
 	}
 
+	// The fallback detector uses PluginMan, ConfMan and static variables
+	bool isDetectionThreadSafe() const override {
+		return false;
+	}
+
 	ADDetectedGame fallbackDetect(const FileMap &allFiles, const Common::FSList &fslist) const override {
 		/**
 		 * Fallback detection for Wintermute heavily depends on engine resources, so it's not possible
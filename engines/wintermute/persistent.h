@@ -55,9 +55,14 @@ namespace Wintermute {
 
 
 #define IMPLEMENT_PERSISTENT(className, persistentClass)\
+	IMPLEMENT_PERSISTENT_ALLOC(className, persistentClass, ::operator new, ::operator delete)
+
+// Same as IMPLEMENT_PERSISTENT, with the instances allocated and freed by
+// the given functions (e.g. from a memory pool)
+#define IMPLEMENT_PERSISTENT_ALLOC(className, persistentClass, allocFunc, freeFunc)\
 	const char className::_className[] = #className;\
 	void* className::persistBuild() {\
-		return ::new className(DYNAMIC_CONSTRUCTOR, DYNAMIC_CONSTRUCTOR);\
+		return ::new (allocFunc(sizeof(className))) className(DYNAMIC_CONSTRUCTOR, DYNAMIC_CONSTRUCTOR);\
 	}\
 	\
 	bool className::persistLoad(void *instance, BasePersistenceManager *persistMgr) {\
@@ -71,14 +76,14 @@ namespace Wintermute {
 	/*SystemClass Register##class_name(class_name::_className, class_name::PersistBuild, class_name::PersistLoad, persistent_class);*/\
 	\
 	void* className::operator new(size_t size) {\
-		void* ret = ::operator new(size);\
+		void* ret = allocFunc(size);\
 		SystemClassRegistry::getInstance()->registerInstance(#className, ret);\
 		return ret;\
 	}\
 	\
 	void className::operator delete(void *p) {\
 		SystemClassRegistry::getInstance()->unregisterInstance(#className, p);\
-		::operator delete(p);\
+		freeFunc(p);\
 	}\
 
 #define TMEMBER(memberName) #memberName, &memberName
@@ -0,0 +1,160 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/scaler/intern.h"
+
+#ifndef USE_NASM
+
+#if defined(__SSE2__)
+#define USE_SSE2_HQ_PATTERNS
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define USE_NEON_HQ_PATTERNS
+#include <arm_neon.h>
+#endif
+
+extern "C" uint32 *RGBtoYUV;
+
+/**
+ * The thresholds of diffYUV(), as one byte per YUV component. The unused top
+ * byte never exceeds its threshold.
+ */
+static const uint32 kYUVThresholds = 0xFF300706;
+
+static inline int computeHQPattern(const uint32 *above, const uint32 *row, const uint32 *below) {
+	const int yuv5 = row[1];
+	int pattern = 0;
+	if (diffYUV(yuv5, above[0])) pattern |= 0x0001;
+	if (diffYUV(yuv5, above[1])) pattern |= 0x0002;
+	if (diffYUV(yuv5, above[2])) pattern |= 0x0004;
+	if (diffYUV(yuv5, row[0]))   pattern |= 0x0008;
+	if (diffYUV(yuv5, row[2]))   pattern |= 0x0010;
+	if (diffYUV(yuv5, below[0])) pattern |= 0x0020;
+	if (diffYUV(yuv5, below[1])) pattern |= 0x0040;
+	if (diffYUV(yuv5, below[2])) pattern |= 0x0080;
+	return pattern;
+}
+
+#ifdef USE_SSE2_HQ_PATTERNS
+
+/**
+ * Return the pattern bit @p bit in the lanes where diffYUV() is true for
+ * the YUV values in @p yuv5 and @p yuv.
+ */
+static inline __m128i diffYUVBitSSE2(__m128i yuv5, __m128i yuv, __m128i thresholds, __m128i bit) {
+	const __m128i diff = _mm_or_si128(_mm_subs_epu8(yuv5, yuv), _mm_subs_epu8(yuv, yuv5));
+	const __m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(diff, thresholds), _mm_setzero_si128());
+	return _mm_andnot_si128(same, bit);
+}
+
+/**
+ * SSE2 version of computeHQPattern, computing the patterns of four pixels
+ * at a time.
+ */
+static inline void computeHQPatternsSSE2(const uint32 *above, const uint32 *row, const uint32 *below, uint8 *patterns) {
+	const __m128i thresholds = _mm_set1_epi32((int)kYUVThresholds);
+	const __m128i yuv5 = _mm_loadu_si128((const __m128i *)(row + 1));
+
+	__m128i pattern = diffYUVBitSSE2(yuv5, _mm_loadu_si128((const __m128i *)above), thresholds, _mm_set1_epi32(0x0001));
+	pattern = _mm_or_si128(pattern, diffYUVBitSSE2(yuv5, _mm_loadu_si128((const __m128i *)(above + 1)), thresholds, _mm_set1_epi32(0x0002)));
+	pattern = _mm_or_si128(pattern, diffYUVBitSSE2(yuv5, _mm_loadu_si128((const __m128i *)(above + 2)), thresholds, _mm_set1_epi32(0x0004)));
+	pattern = _mm_or_si128(pattern, diffYUVBitSSE2(yuv5, _mm_loadu_si128((const __m128i *)row), thresholds, _mm_set1_epi32(0x0008)));
+	pattern = _mm_or_si128(pattern, diffYUVBitSSE2(yuv5, _mm_loadu_si128((const __m128i *)(row + 2)), thresholds, _mm_set1_epi32(0x0010)));
+	pattern = _mm_or_si128(pattern, diffYUVBitSSE2(yuv5, _mm_loadu_si128((const __m128i *)below), thresholds, _mm_set1_epi32(0x0020)));
+	pattern = _mm_or_si128(pattern, diffYUVBitSSE2(yuv5, _mm_loadu_si128((const __m128i *)(below + 1)), thresholds, _mm_set1_epi32(0x0040)));
+	pattern = _mm_or_si128(pattern, diffYUVBitSSE2(yuv5, _mm_loadu_si128((const __m128i *)(below + 2)), thresholds, _mm_set1_epi32(0x0080)));
+
+	// Each pattern fits in the low byte of its lane
+	pattern = _mm_packs_epi32(pattern, pattern);
+	pattern = _mm_packus_epi16(pattern, pattern);
+	const uint32 packed = _mm_cvtsi128_si32(pattern);
+	memcpy(patterns, &packed, 4);
+}
+
+#endif // USE_SSE2_HQ_PATTERNS
+
+#ifdef USE_NEON_HQ_PATTERNS
+
+/**
+ * Return the pattern bit @p bit in the lanes where diffYUV() is true for
+ * the YUV values in @p yuv5 and @p yuv.
+ */
+static inline uint32x4_t diffYUVBitNEON(uint8x16_t yuv5, const uint32 *yuv, uint8x16_t thresholds, uint32 bit) {
+	const uint8x16_t exceeds = vcgtq_u8(vabdq_u8(yuv5, vreinterpretq_u8_u32(vld1q_u32(yuv))), thresholds);
+	const uint32x4_t differs = vreinterpretq_u32_u8(exceeds);
+	return vandq_u32(vtstq_u32(differs, differs), vdupq_n_u32(bit));
+}
+
+/**
+ * NEON version of computeHQPattern, computing the patterns of four pixels
+ * at a time.
+ */
+static inline void computeHQPatternsNEON(const uint32 *above, const uint32 *row, const uint32 *below, uint8 *patterns) {
+	const uint8x16_t thresholds = vreinterpretq_u8_u32(vdupq_n_u32(kYUVThresholds));
+	const uint8x16_t yuv5 = vreinterpretq_u8_u32(vld1q_u32(row + 1));
+
+	uint32x4_t pattern = diffYUVBitNEON(yuv5, above, thresholds, 0x0001);
+	pattern = vorrq_u32(pattern, diffYUVBitNEON(yuv5, above + 1, thresholds, 0x0002));
+	pattern = vorrq_u32(pattern, diffYUVBitNEON(yuv5, above + 2, thresholds, 0x0004));
+	pattern = vorrq_u32(pattern, diffYUVBitNEON(yuv5, row, thresholds, 0x0008));
+	pattern = vorrq_u32(pattern, diffYUVBitNEON(yuv5, row + 2, thresholds, 0x0010));
+	pattern = vorrq_u32(pattern, diffYUVBitNEON(yuv5, below, thresholds, 0x0020));
+	pattern = vorrq_u32(pattern, diffYUVBitNEON(yuv5, below + 1, thresholds, 0x0040));
+	pattern = vorrq_u32(pattern, diffYUVBitNEON(yuv5, below + 2, thresholds, 0x0080));
+
+	// Each pattern fits in the low byte of its lane
+	const uint8x8_t narrowed = vmovn_u16(vcombine_u16(vmovn_u32(pattern), vmovn_u32(pattern)));
+	vst1_lane_u32((uint32_t *)patterns, vreinterpret_u32_u8(narrowed), 0);
+}
+
+#endif // USE_NEON_HQ_PATTERNS
+
+void computeHQPatterns(const uint16 *p, uint32 nextlineSrc, int width, uint8 *patterns) {
+	assert(width <= kHQPatternChunk);
+
+	// The YUV values of the rows above, at and below the pixels, including
+	// the pixels to the left and right of them.
+	uint32 above[kHQPatternChunk + 2];
+	uint32 row[kHQPatternChunk + 2];
+	uint32 below[kHQPatternChunk + 2];
+	const uint16 *pAbove = p - 1 - nextlineSrc;
+	const uint16 *pRow = p - 1;
+	const uint16 *pBelow = p - 1 + nextlineSrc;
+	for (int x = 0; x < width + 2; x++) {
+		above[x] = RGBtoYUV[pAbove[x]];
+		row[x] = RGBtoYUV[pRow[x]];
+		below[x] = RGBtoYUV[pBelow[x]];
+	}
+
+	int x = 0;
+#if defined(USE_SSE2_HQ_PATTERNS)
+	for (; x + 4 <= width; x += 4)
+		computeHQPatternsSSE2(above + x, row + x, below + x, patterns + x);
+#elif defined(USE_NEON_HQ_PATTERNS)
+	for (; x + 4 <= width; x += 4)
+		computeHQPatternsNEON(above + x, row + x, below + x, patterns + x);
+#endif
+	for (; x < width; x++)
+		patterns[x] = computeHQPattern(above + x, row + x, below + x);
+}
+
+#endif // USE_NASM
@@ -524,4 +524,21 @@ static inline bool diffYUV(int yuv1, int yuv2) {
 */
 }
 
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+
+enum {
+	/** The maximum number of pixels computeHQPatterns() handles at once. */
+	kHQPatternChunk = 64
+};
+
+/**
+ * Compute the patterns of the hq scaler family for @p width consecutive
+ * pixels of a row, starting at @p p. Bit n of a pattern is set if diffYUV()
+ * is true for the pixel and its n-th neighbour, counting the neighbours from
+ * the top left to the bottom right. Uses vector instructions if available.
+ */
+void computeHQPatterns(const uint16 *p, uint32 nextlineSrc, int width, uint8 *patterns);
+
+#endif
+
 #endif
@@ -243,6 +243,7 @@ void glClose() {
 
 	tglDisposeDrawCallLists(c);
 	tglDisposeResources(c);
+	tglDisposeTileContexts(c);
 
 	specbuf_cleanup(c);
 	for (int i = 0; i < 3; i++)
@@ -80,7 +80,7 @@ void memset_l(void *adr, int val, int count) {
 		*p++ = val;
 }
 
-FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelBuffer &frame_buffer) : _depthWrite(true), _enableScissor(false) {
+FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelBuffer &frame_buffer) : _sharedBuffers(false), _depthWrite(true), _enableScissor(false) {
 	this->xsize = width;
 	this->ysize = height;
 	this->cmode = frame_buffer.getFormat();
@@ -106,7 +106,7 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelBuffer &fra
 	_depthFunc = TGL_LESS;
 }
 
-FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &format) : _depthWrite(true), _enableScissor(false) {
+FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &format) : _sharedBuffers(false), _depthWrite(true), _enableScissor(false) {
 	this->xsize = width;
 	this->ysize = height;
 	this->cmode = format;
@@ -133,10 +133,44 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_depthFunc = TGL_LESS;
 }
 
+FrameBuffer::FrameBuffer(const FrameBuffer *parent) : _sharedBuffers(true), _depthWrite(true), _enableScissor(false) {
+	this->frame_buffer_allocated = 0;
+	this->current_texture = NULL;
+	_blendingEnabled = false;
+	_alphaTestEnabled = false;
+	_depthTestEnabled = false;
+	_depthFunc = TGL_LESS;
+
+	shareBuffers(parent);
+}
+
 FrameBuffer::~FrameBuffer() {
 	if (frame_buffer_allocated)
 		pbuf.free();
-	gl_free(_zbuf);
+	if (!_sharedBuffers)
+		gl_free(_zbuf);
+}
+
+void FrameBuffer::shareBuffers(const FrameBuffer *parent) {
+	assert(_sharedBuffers);
+
+	this->xsize = parent->xsize;
+	this->ysize = parent->ysize;
+	this->cmode = parent->cmode;
+	this->pixelbytes = parent->pixelbytes;
+	this->linesize = parent->linesize;
+
+	// Use the currently selected buffers, which may be an offscreen buffer
+	this->pbuf = parent->pbuf;
+	this->_zbuf = parent->_zbuf;
+	this->buffer = parent->buffer;
+
+	this->shadow_mask_buf = parent->shadow_mask_buf;
+	this->shadow_color_r = parent->shadow_color_r;
+	this->shadow_color_g = parent->shadow_color_g;
+	this->shadow_color_b = parent->shadow_color_b;
+	this->_textureSize = parent->_textureSize;
+	this->_textureSizeMask = parent->_textureSizeMask;
 }
 
 Buffer *FrameBuffer::genOffscreenBuffer() {
@@ -103,8 +103,14 @@ struct ZBufferPoint {
 struct FrameBuffer {
 	FrameBuffer(int xsize, int ysize, const Graphics::PixelBuffer &frame_buffer);
 	FrameBuffer(int xsize, int ysize, const Graphics::PixelFormat &format);
+	explicit FrameBuffer(const FrameBuffer *parent);
 	~FrameBuffer();
 
+	// Draw into the buffers of another frame buffer, keeping a separate
+	// rendering state, so that several threads can draw into different
+	// parts of the same buffers.
+	void shareBuffers(const FrameBuffer *parent);
+
 	Buffer *genOffscreenBuffer();
 	void delOffscreenBuffer(Buffer *buffer);
 	void clear(int clear_z, int z, int clear_color, int r, int g, int b);
@@ -516,6 +522,7 @@ private:
 	void drawLine(const ZBufferPoint *p1, const ZBufferPoint *p2);
 
 	unsigned int *_zbuf;
+	bool _sharedBuffers;
 	bool _depthWrite;
 	Graphics::PixelBuffer pbuf;
 	bool _blendingEnabled;
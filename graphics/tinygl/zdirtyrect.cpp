@@ -30,7 +30,9 @@
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/gl.h"
 #include "common/debug.h"
+#include "common/jobs.h"
 #include "common/math.h"
+#include "common/system.h"
 
 namespace TinyGL {
 
@@ -113,6 +115,164 @@ void tglDisposeDrawCallLists(TinyGL::GLContext *c) {
 	c->_drawCallsQueue.clear();
 }
 
+// Number of frame buffer lines in each tile rasterized in parallel. Tiles
+// span the whole width, so that the rasterizer can skip the lines of a
+// triangle which are outside of its tile.
+static const int kTileHeight = 32;
+
+void tglDisposeTileContexts(TinyGL::GLContext *c) {
+	for (uint i = 0; i < c->_tileContexts.size(); i++) {
+		TinyGL::GLContext *tileContext = c->_tileContexts[i];
+		delete tileContext->fb;
+		gl_free(tileContext->vertex);
+		delete tileContext;
+	}
+	c->_tileContexts.clear();
+}
+
+static void tglPrepareTileContexts(TinyGL::GLContext *c, uint count) {
+	while (c->_tileContexts.size() < count) {
+		TinyGL::GLContext *tileContext = new TinyGL::GLContext();
+		tileContext->fb = new FrameBuffer(c->fb);
+		tileContext->vertex_max = POLYGON_MAX_VERTEX;
+		tileContext->vertex = (GLVertex *)gl_malloc(POLYGON_MAX_VERTEX * sizeof(GLVertex));
+		c->_tileContexts.push_back(tileContext);
+	}
+
+	// The draw calls apply their own state, copy the rest
+	for (uint i = 0; i < count; i++) {
+		TinyGL::GLContext *tileContext = c->_tileContexts[i];
+		tileContext->fb->shareBuffers(c->fb);
+		tileContext->renderRect = c->renderRect;
+		tileContext->render_mode = c->render_mode;
+		tileContext->current_cull_face = c->current_cull_face;
+		tileContext->vertex_n = c->vertex_n;
+		tileContext->_textureSize = c->_textureSize;
+		tileContext->_enableDirtyRectangles = c->_enableDirtyRectangles;
+	}
+}
+
+static Common::Rect tglGetDrawCallRegion(const TinyGL::GLContext *c, const Graphics::DrawCall &call) {
+	// Dirty regions are only computed when dirty rectangles are enabled
+	return c->_enableDirtyRectangles ? call.getDirtyRegion() : c->renderRect;
+}
+
+static void tglExecuteDrawCall(TinyGL::GLContext *c, const Graphics::DrawCall &call, const Common::Array<Common::Rect> &regions) {
+	if (!c->_enableDirtyRectangles) {
+		call.execute(true);
+		return;
+	}
+
+	Common::Rect drawCallRegion = call.getDirtyRegion();
+	for (uint i = 0; i < regions.size(); i++) {
+		if (regions[i].intersects(drawCallRegion)) {
+			call.execute(regions[i], true);
+		}
+	}
+}
+
+struct TileRasterizer {
+	typedef Common::Array<const Graphics::DrawCall *> DrawCallBin;
+
+	TinyGL::GLContext *c;
+	const Common::Array<Common::Rect> &regions;
+	const Common::Array<DrawCallBin> &bins;
+	Common::Atomic<int32> nextTile;
+
+	TileRasterizer(TinyGL::GLContext *context, const Common::Array<Common::Rect> &r, const Common::Array<DrawCallBin> &b) :
+		c(context), regions(r), bins(b), nextTile(0) {
+	}
+
+	// Each job renders tiles until there are none left, using the context
+	// of its slot
+	void operator()(uint begin, uint end) {
+		for (uint slot = begin; slot < end; slot++) {
+			for (;;) {
+				int32 tile = nextTile.fetchAdd(1);
+				if (tile >= (int32)bins.size())
+					break;
+				rasterizeTile(c->_tileContexts[slot], tile);
+			}
+		}
+	}
+
+	void rasterizeTile(TinyGL::GLContext *tileContext, int tile) {
+		const Common::Rect tileRect(0, tile * kTileHeight, c->fb->xsize, MIN((tile + 1) * kTileHeight, c->fb->ysize));
+		const DrawCallBin &bin = bins[tile];
+		for (uint i = 0; i < bin.size(); i++) {
+			const Graphics::DrawCall &call = *bin[i];
+			Common::Rect drawCallRegion = tglGetDrawCallRegion(c, call);
+			for (uint j = 0; j < regions.size(); j++) {
+				Common::Rect clippingRectangle = regions[j].findIntersectingRect(tileRect);
+				if (clippingRectangle.isEmpty() || !clippingRectangle.intersects(drawCallRegion))
+					continue;
+
+				if (call.getType() == Graphics::DrawCall::DrawCall_Rasterization) {
+					((const Graphics::RasterizationDrawCall &)call).execute(tileContext, clippingRectangle);
+				} else {
+					((const Graphics::ClearBufferDrawCall &)call).execute(tileContext, clippingRectangle);
+				}
+			}
+		}
+	}
+};
+
+// Execute the queued draw calls within the given regions. Consecutive
+// rasterization and clear calls are sorted by tile, and the tiles are
+// rasterized in parallel. Blits run on the calling thread in between.
+static void tglExecuteDrawCalls(TinyGL::GLContext *c, const Common::Array<Common::Rect> &regions) {
+	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
+
+	Common::JobSystem *jobSystem = g_system->getJobSystem();
+	const uint threadCount = jobSystem ? jobSystem->getThreadCount() : 1;
+	const int tileCount = (c->fb->ysize + kTileHeight - 1) / kTileHeight;
+
+	// Selection writes to the selection buffer of the main context
+	if (threadCount <= 1 || tileCount <= 1 || c->render_mode == TGL_SELECT) {
+		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
+			tglExecuteDrawCall(c, **it, regions);
+		}
+		return;
+	}
+
+	tglPrepareTileContexts(c, threadCount);
+
+	Common::Array<TileRasterizer::DrawCallBin> bins;
+	bins.resize(tileCount);
+
+	DrawCallIterator it = c->_drawCallsQueue.begin();
+	while (it != c->_drawCallsQueue.end()) {
+		if ((*it)->getType() == Graphics::DrawCall::DrawCall_Blitting) {
+			tglExecuteDrawCall(c, **it, regions);
+			++it;
+			continue;
+		}
+
+		for (int i = 0; i < tileCount; i++) {
+			bins[i].clear();
+		}
+
+		bool empty = true;
+		for ( ; it != c->_drawCallsQueue.end() && (*it)->getType() != Graphics::DrawCall::DrawCall_Blitting; ++it) {
+			Common::Rect drawCallRegion = tglGetDrawCallRegion(c, **it);
+			if (drawCallRegion.isEmpty())
+				continue;
+
+			int firstTile = MAX<int>(drawCallRegion.top, 0) / kTileHeight;
+			int lastTile = MIN<int>((drawCallRegion.bottom - 1) / kTileHeight, tileCount - 1);
+			for (int i = firstTile; i <= lastTile; i++) {
+				bins[i].push_back(*it);
+			}
+			empty = false;
+		}
+
+		if (!empty) {
+			TileRasterizer rasterizer(c, regions, bins);
+			jobSystem->parallelFor(0, threadCount, 1, rasterizer);
+		}
+	}
+}
+
 static inline void _appendDirtyRectangle(const Graphics::DrawCall &call, Common::List<DirtyRectangle> &rectangles, int r, int g, int b) {
 	Common::Rect dirty_region = call.getDirtyRegion();
 	if (rectangles.empty() || dirty_region != rectangles.back().rectangle)
@@ -195,15 +355,11 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 
 	if (!rectangles.empty()) {
 		// Execute draw calls.
-		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
-			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
-				}
-			}
+		Common::Array<Common::Rect> regions;
+		for (RectangleIterator it = rectangles.begin(); it != rectangles.end(); ++it) {
+			regions.push_back((*it).rectangle);
 		}
+		tglExecuteDrawCalls(c, regions);
 #if TGL_DIRTY_RECT_SHOW
 		// Draw debug rectangles.
 		// Note: white rectangles are rectangle that contained other rectangles
@@ -242,8 +398,11 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 static void tglPresentBufferSimple(TinyGL::GLContext *c) {
 	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
 
+	Common::Array<Common::Rect> regions;
+	regions.push_back(c->renderRect);
+	tglExecuteDrawCalls(c, regions);
+
 	for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
 		delete *it;
 	}
 
@@ -294,7 +453,7 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleFront = c->draw_triangle_front;
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(TinyGL::GLVertex) * _vertexCount);
-	_state = captureState();
+	_state = captureState(c);
 	if (c->_enableDirtyRectangles) {
 		computeDirtyRegion();
 	}
@@ -338,14 +497,22 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 
 	RasterizationDrawCall::RasterizationState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_state);
+	applyState(c, _state);
 
+	rasterize(c, _vertex);
+
+	if (restoreState) {
+		applyState(c, backupState);
+	}
+}
+
+void RasterizationDrawCall::rasterize(TinyGL::GLContext *c, TinyGL::GLVertex *vertex) const {
 	TinyGL::GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
-	c->vertex = _vertex;
+	c->vertex = vertex;
 	c->vertex_cnt = _vertexCount;
 	c->draw_triangle_front = (TinyGL::gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (TinyGL::gl_draw_triangle_func)_drawTriangleBack;
@@ -427,15 +594,10 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 
 	c->vertex = prevVertex;
 	c->vertex_cnt = prevVertexCount;
-
-	if (restoreState) {
-		applyState(backupState);
-	}
 }
 
-RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
+RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState(TinyGL::GLContext *c) const {
 	RasterizationState state;
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	state.alphaTest = c->fb->isAlphaTestEnabled();
 	c->fb->getBlendingFactors(state.sfactor, state.dfactor);
 	state.enableBlending = c->fb->isBlendingEnabled();
@@ -469,8 +631,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
+void RasterizationDrawCall::applyState(TinyGL::GLContext *c, const RasterizationDrawCall::RasterizationState &state) const {
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->enableAlphaTest(state.alphaTest);
@@ -506,6 +667,21 @@ void RasterizationDrawCall::execute(const Common::Rect &clippingRectangle, bool
 	c->fb->resetScissorRectangle();
 }
 
+void RasterizationDrawCall::execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle) const {
+	// Drawing modifies the vertices, so each tile uses its own copy
+	if (c->vertex_max < _vertexCount) {
+		TinyGL::gl_free(c->vertex);
+		c->vertex_max = _vertexCount;
+		c->vertex = (TinyGL::GLVertex *)TinyGL::gl_malloc(c->vertex_max * sizeof(TinyGL::GLVertex));
+	}
+	memcpy(c->vertex, _vertex, _vertexCount * sizeof(TinyGL::GLVertex));
+
+	applyState(c, _state);
+	c->fb->setScissorRectangle(clippingRectangle);
+	rasterize(c, c->vertex);
+	c->fb->resetScissorRectangle();
+}
+
 bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const {
 	if (_vertexCount == other._vertexCount && 
 		_drawTriangleFront == other._drawTriangleFront && 
@@ -646,6 +822,11 @@ void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool re
 	c->fb->clearRegion(clearRect.left, clearRect.top, clearRect.width(), clearRect.height(), _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue);
 }
 
+void ClearBufferDrawCall::execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle) const {
+	Common::Rect clearRect = clippingRectangle.findIntersectingRect(c->renderRect);
+	c->fb->clearRegion(clearRect.left, clearRect.top, clearRect.width(), clearRect.height(), _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue);
+}
+
 bool ClearBufferDrawCall::operator==(const ClearBufferDrawCall &other) const {
 	return	_clearZBuffer == other._clearZBuffer &&
 			_clearColorBuffer == other._clearColorBuffer &&
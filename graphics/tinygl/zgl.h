@@ -396,6 +396,9 @@ struct GLContext {
 	Common::List<Graphics::DrawCall *> _previousFrameDrawCallsQueue;
 	int _currentAllocatorIndex;
 	LinearAllocator _drawCallAllocator[2];
+
+	// Contexts used to rasterize tiles of the frame buffer in parallel
+	Common::Array<GLContext *> _tileContexts;
 };
 
 extern GLContext *gl_ctx;
@@ -438,6 +441,7 @@ void tglIssueDrawCall(Graphics::DrawCall *drawCall);
 // zdirtyrect.cpp
 void tglDisposeResources(GLContext *c);
 void tglDisposeDrawCallLists(TinyGL::GLContext *c);
+void tglDisposeTileContexts(GLContext *c);
 
 GLContext *gl_get_context();
 
@@ -31,24 +31,113 @@
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
 
+#if defined(__SSE2__)
+#define USE_SSE2_DEPTH_TEST
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define USE_NEON_DEPTH_TEST
+#include <arm_neon.h>
+#endif
+
 namespace TinyGL {
 
 static const int NB_INTERP = 8;
 
+/**
+ * Run the depth test on four consecutive pixels of a span, the first one at
+ * depth z and the others stepping by dzdx. Bit n of the result is set when
+ * pixel n passes the test, so the span loops can skip hidden pixels and
+ * fully hidden groups without testing each pixel on its own.
+ */
+FORCEINLINE static unsigned int depthTestMask(FrameBuffer *buffer, unsigned int z, int dzdx, unsigned int *pz) {
+	if (!buffer->getDepthTestEnabled())
+		return 0xf;
+
+#if defined(USE_SSE2_DEPTH_TEST)
+	// SSE2 only has signed compares, so flip the sign bits first
+	const __m128i bias = _mm_set1_epi32((int)0x80000000);
+	const __m128i src = _mm_xor_si128(_mm_set_epi32(z + 3 * dzdx, z + 2 * dzdx, z + dzdx, z), bias);
+	const __m128i dst = _mm_xor_si128(_mm_loadu_si128((const __m128i *)pz), bias);
+
+	switch (buffer->getDepthFunc()) {
+	case TGL_LESS:
+		return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(src, dst)));
+	case TGL_EQUAL:
+		return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(dst, src)));
+	case TGL_LEQUAL:
+		return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(dst, src))) ^ 0xf;
+	case TGL_GREATER:
+		return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(dst, src)));
+	case TGL_NOTEQUAL:
+		return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(dst, src))) ^ 0xf;
+	case TGL_GEQUAL:
+		return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(src, dst))) ^ 0xf;
+	case TGL_ALWAYS:
+		return 0xf;
+	default:
+		return 0;
+	}
+#elif defined(USE_NEON_DEPTH_TEST)
+	const uint32 steps[4] = { z, z + dzdx, z + 2 * dzdx, z + 3 * dzdx };
+	const uint32 bits[4] = { 1, 2, 4, 8 };
+	const uint32x4_t src = vld1q_u32(steps);
+	const uint32x4_t dst = vld1q_u32(pz);
+
+	uint32x4_t pass;
+	switch (buffer->getDepthFunc()) {
+	case TGL_LESS:
+		pass = vcltq_u32(dst, src);
+		break;
+	case TGL_EQUAL:
+		pass = vceqq_u32(dst, src);
+		break;
+	case TGL_LEQUAL:
+		pass = vcleq_u32(dst, src);
+		break;
+	case TGL_GREATER:
+		pass = vcgtq_u32(dst, src);
+		break;
+	case TGL_NOTEQUAL:
+		pass = vmvnq_u32(vceqq_u32(dst, src));
+		break;
+	case TGL_GEQUAL:
+		pass = vcgeq_u32(dst, src);
+		break;
+	case TGL_ALWAYS:
+		return 0xf;
+	default:
+		return 0;
+	}
+
+	const uint32x4_t masked = vandq_u32(pass, vld1q_u32(bits));
+	uint32x2_t sum = vpadd_u32(vget_low_u32(masked), vget_high_u32(masked));
+	sum = vpadd_u32(sum, sum);
+	return vget_lane_u32(sum, 0);
+#else
+	unsigned int mask = 0;
+	for (int i = 0; i < 4; i++) {
+		if (buffer->compareDepth(z, pz[i]))
+			mask |= 1 << i;
+		z += dzdx;
+	}
+	return mask;
+#endif
+}
+
 template <bool kDepthWrite, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending>
-FORCEINLINE static void putPixelFlat(FrameBuffer *buffer, int buf, unsigned int *pz, int _a,
+FORCEINLINE static void putPixelFlat(FrameBuffer *buffer, int buf, unsigned int *pz, int _a, unsigned int depthMask,
                                      int x, int y, unsigned int &z, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a, int &dzdx) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a])) {
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && (depthMask & (1 << _a))) {
 		buffer->writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(buf + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
 	}
 	z += dzdx;
 }
 
 template <bool kDepthWrite, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending>
-FORCEINLINE static void putPixelSmooth(FrameBuffer *buffer, int buf, unsigned int *pz, int _a,
+FORCEINLINE static void putPixelSmooth(FrameBuffer *buffer, int buf, unsigned int *pz, int _a, unsigned int depthMask,
                                        int x, int y, unsigned int &z, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a,
                                        int &dzdx, int &drdx, int &dgdx, int &dbdx, unsigned int dadx) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a])) {
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && (depthMask & (1 << _a))) {
 		buffer->writePixel<kEnableAlphaTest, kEnableBlending, kDepthWrite>(buf + _a, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
 	}
 	z += dzdx;
@@ -59,8 +148,8 @@ FORCEINLINE static void putPixelSmooth(FrameBuffer *buffer, int buf, unsigned in
 }
 
 template <bool kDepthWrite, bool kEnableScissor>
-FORCEINLINE static void putPixelDepth(FrameBuffer *buffer, int buf, unsigned int *pz, int _a, int x, int y, unsigned int &z, int &dzdx) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a])) {
+FORCEINLINE static void putPixelDepth(FrameBuffer *buffer, int buf, unsigned int *pz, int _a, unsigned int depthMask, int x, int y, unsigned int &z, int &dzdx) {
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && (depthMask & (1 << _a))) {
 		if (kDepthWrite) {
 			pz[_a] = z;
 		}
@@ -69,8 +158,8 @@ FORCEINLINE static void putPixelDepth(FrameBuffer *buffer, int buf, unsigned int
 }
 
 template <bool kDepthWrite, bool kAlphaTestEnabled, bool kEnableScissor, bool kBlendingEnabled>
-FORCEINLINE static void putPixelShadow(FrameBuffer *buffer, int buf, unsigned int *pz, int _a, int x, int y, unsigned int &z, unsigned int &r, unsigned int &g, unsigned int &b, int &dzdx, unsigned char *pm) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a]) && pm[_a]) {
+FORCEINLINE static void putPixelShadow(FrameBuffer *buffer, int buf, unsigned int *pz, int _a, unsigned int depthMask, int x, int y, unsigned int &z, unsigned int &r, unsigned int &g, unsigned int &b, int &dzdx, unsigned char *pm) {
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && (depthMask & (1 << _a)) && pm[_a]) {
 		buffer->writePixel<kAlphaTestEnabled, kBlendingEnabled, kDepthWrite>(buf + _a, 255, r >> (ZB_POINT_RED_BITS - 8), g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
 	}
 	z += dzdx;
@@ -78,10 +167,10 @@ FORCEINLINE static void putPixelShadow(FrameBuffer *buffer, int buf, unsigned in
 
 template <bool kDepthWrite, bool kLightsMode, bool kSmoothMode, bool kEnableAlphaTest, bool kEnableScissor, bool kEnableBlending>
 FORCEINLINE static void putPixelTextureMappingPerspective(FrameBuffer *buffer, int buf,
-                        const Graphics::TexelBuffer *texture, unsigned int wrap_s, unsigned int wrap_t, unsigned int *pz, int _a,
+                        const Graphics::TexelBuffer *texture, unsigned int wrap_s, unsigned int wrap_t, unsigned int *pz, int _a, unsigned int depthMask,
                         int x, int y, unsigned int &z, int &t, int &s, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a,
                         int &dzdx, int &dsdx, int &dtdx, int &drdx, int &dgdx, int &dbdx, unsigned int dadx) {
-	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && buffer->compareDepth(z, pz[_a])) {
+	if ((!kEnableScissor || !buffer->scissorPixel(x + _a, y)) && (depthMask & (1 << _a))) {
 		uint8 c_a, c_r, c_g, c_b;
 		texture->getARGBAt(wrap_s, wrap_t, s, t, c_a, c_r, c_g, c_b);
 		if (kLightsMode) {
@@ -360,8 +449,12 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
+			// the scissor rectangle is usually a tile, so skip whole lines
+			if (kEnableScissor && y >= _clipRectangle.bottom)
+				return;
+
 			int x = x1;
-			{
+			if (!kEnableScissor || y >= _clipRectangle.top) {
 				if (kDrawLogic == DRAW_DEPTH_ONLY ||
 						(kDrawLogic == DRAW_FLAT && !(kInterpST || kInterpSTZ))) {
 					int pp;
@@ -382,18 +475,19 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						a = a1;
 					}
 					while (n >= 3) {
+						const unsigned int depthMask = depthTestMask(this, z, dzdx, pz);
 						if (kDrawLogic == DRAW_DEPTH_ONLY) {
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 0, x, y, z, dzdx);
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 1, x, y, z, dzdx);
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 2, x, y, z, dzdx);
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 3, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 0, depthMask, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 1, depthMask, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 2, depthMask, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 3, depthMask, x, y, z, dzdx);
 							buf += 4;
 						}
 						if (kDrawLogic == DRAW_FLAT) {
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, x, y, z, r, g, b, a, dzdx);
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 1, x, y, z, r, g, b, a, dzdx);
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 2, x, y, z, r, g, g, a, dzdx);
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 3, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, depthMask, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 1, depthMask, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 2, depthMask, x, y, z, r, g, g, a, dzdx);
+							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 3, depthMask, x, y, z, r, g, b, a, dzdx);
 						}
 						if (kInterpZ) {
 							pz += 4;
@@ -404,11 +498,11 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					}
 					while (n >= 0) {
 						if (kDrawLogic == DRAW_DEPTH_ONLY) {
-							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 0, x, y, z, dzdx);
+							putPixelDepth<kDepthWrite, kEnableScissor>(this, buf, pz, 0, compareDepth(z, pz[0]), x, y, z, dzdx);
 							buf ++;
 						}
 						if (kDrawLogic == DRAW_FLAT) {
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, x, y, z, r, g, b, a, dzdx);
+							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, compareDepth(z, pz[0]), x, y, z, r, g, b, a, dzdx);
 						}
 						if (kInterpZ) {
 							pz += 1;
@@ -455,10 +549,11 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					pz = pz1 + x1;
 					z = z1;
 					while (n >= 3) {
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, dzdx, pm);
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 1, x, y, z, r, g, b, dzdx, pm);
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 2, x, y, z, r, g, b, dzdx, pm);
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 3, x, y, z, r, g, b, dzdx, pm);
+						const unsigned int depthMask = depthTestMask(this, z, dzdx, pz);
+						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, depthMask, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 1, depthMask, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 2, depthMask, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 3, depthMask, x, y, z, r, g, b, dzdx, pm);
 						pz += 4;
 						pm += 4;
 						buf += 4;
@@ -466,7 +561,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						x += 4;
 					}
 					while (n >= 0) {
-						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, dzdx, pm);
+						putPixelShadow<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, compareDepth(z, pz[0]), x, y, z, r, g, b, dzdx, pm);
 						pz += 1;
 						pm += 1;
 						buf += 1;
@@ -486,17 +581,18 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 					b = b1;
 					a = a1;
 					while (n >= 3) {
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 1, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 2, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 3, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						const unsigned int depthMask = depthTestMask(this, z, dzdx, pz);
+						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, depthMask, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 1, depthMask, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 2, depthMask, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 3, depthMask, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
 						pz += 4;
 						buf += 4;
 						n -= 4;
 						x += 4;
 					}
 					while (n >= 0) {
-						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						putPixelSmooth<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, pz, 0, compareDepth(z, pz[0]), x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
 						buf += 1;
 						pz += 1;
 						n -= 1;
@@ -536,9 +632,22 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 							fz += fndzdx;
 							zinv = (float)(1.0 / fz);
 						}
-						for (int _a = 0; _a < NB_INTERP; _a++) {
-							putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
-							                           pz, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						const unsigned int depthMask = depthTestMask(this, z, dzdx, pz) |
+						                               (depthTestMask(this, z + 4 * dzdx, dzdx, pz + 4) << 4);
+						if (depthMask == 0) {
+							// the whole group is hidden, skip the texture lookups
+							z += NB_INTERP * dzdx;
+							if (kDrawLogic == DRAW_SMOOTH) {
+								a += NB_INTERP * dadx;
+								r += NB_INTERP * drdx;
+								g += NB_INTERP * dgdx;
+								b += NB_INTERP * dbdx;
+							}
+						} else {
+							for (int _a = 0; _a < NB_INTERP; _a++) {
+								putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
+								                           pz, _a, depthMask, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+							}
 						}
 						pz += NB_INTERP;
 						buf += NB_INTERP;
@@ -560,7 +669,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 					while (n >= 0) {
 						putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
-						                           pz, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						                           pz, 0, compareDepth(z, pz[0]), x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
 						pz += 1;
 						buf += 1;
 						n -= 1;
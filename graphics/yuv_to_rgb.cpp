@@ -83,9 +83,18 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/endian.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+#if defined(__SSE2__)
+#define USE_SSE2_YUV_TO_RGB
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define USE_NEON_YUV_TO_RGB
+#include <arm_neon.h>
+#endif
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -98,12 +107,14 @@ public:
 
 	Graphics::PixelFormat getFormat() const { return _format; }
 	YUVToRGBManager::LuminanceScale getScale() const { return _scale; }
+	bool getAlphaMode() const { return _alphaMode; }
 	const uint32 *getRGBToPix() const { return _rgbToPix; }
 	const uint32 *getAlphaToPix() const { return _alphaToPix; }
 
 private:
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
+	bool _alphaMode;
 	uint32 _rgbToPix[3 * 768]; // 9216 bytes
 	uint32 _alphaToPix[256];   // 958 bytes
 };
@@ -111,6 +122,7 @@ private:
 YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale, bool alphaMode) {
 	_format = format;
 	_scale = scale;
+	_alphaMode = alphaMode;
 
 	int alphaValue = alphaMode ? 0 : 255;
 
@@ -167,9 +179,6 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 }
 
 YUVToRGBManager::YUVToRGBManager() {
-	_lookup = 0;
-	_alphaMode = false;
-
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
 	int16 *Cb_g_tab = &_colorTab[2 * 256];
@@ -190,19 +199,283 @@ YUVToRGBManager::YUVToRGBManager() {
 }
 
 YUVToRGBManager::~YUVToRGBManager() {
-	delete _lookup;
+	for (uint i = 0; i < _lookups.size(); i++)
+		delete _lookups[i];
 }
 
 const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale, bool alphaMode) {
-	if (_lookup && _lookup->getFormat() == format && _lookup->getScale() == scale && _alphaMode == alphaMode)
-		return _lookup;
+	// A spin lock is enough, since it is only held for long when a new
+	// lookup is built, which happens once per format
+	int32 unlocked = 0;
+	while (!_lookupLock.compareExchange(unlocked, 1))
+		unlocked = 0;
+
+	YUVToRGBLookup *lookup = 0;
+	for (uint i = 0; i < _lookups.size() && !lookup; i++)
+		if (_lookups[i]->getFormat() == format && _lookups[i]->getScale() == scale && _lookups[i]->getAlphaMode() == alphaMode)
+			lookup = _lookups[i];
+
+	if (!lookup) {
+		lookup = new YUVToRGBLookup(format, scale, alphaMode);
+		_lookups.push_back(lookup);
+	}
 
-	_alphaMode = alphaMode;
-	delete _lookup;
-	_lookup = new YUVToRGBLookup(format, scale, alphaMode);
-	return _lookup;
+	_lookupLock.store(0);
+	return lookup;
+}
+
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+
+// The vector versions of the conversions below handle eight pixels at a time
+// and compute the color components directly instead of looking them up in
+// YUVToRGBLookup. Their results are identical to the lookup tables, which is
+// checked by the unit tests.
+
+/**
+ * Fixed point versions of the factors used for _colorTab, as a left shift of
+ * the chroma value followed by a 16 bit high multiply. For every chroma value
+ * they give the same truncated result as the floating point factors.
+ */
+enum {
+	kCrRShift = 1, kCrRFactor = 45876, // 0.419 / 0.299
+	kCrGShift = 0, kCrGFactor = 46735, // 0.299 / 0.419
+	kCbGShift = 0, kCbGFactor = 22562, // 0.114 / 0.331
+	kCbBShift = 1, kCbBFactor = 58109, // 0.587 / 0.331
+	kITUShift = 1, kITUFactor = 38155  // 255 / 219
+};
+
+#endif
+
+#ifdef USE_SSE2_YUV_TO_RGB
+
+typedef __m128i YUVVector;
+
+struct YUVToRGBVectorFormat {
+	YUVToRGBVectorFormat(const YUVToRGBLookup *lookup) {
+		const Graphics::PixelFormat &format = lookup->getFormat();
+		loss[0] = _mm_cvtsi32_si128(format.rLoss);
+		loss[1] = _mm_cvtsi32_si128(format.gLoss);
+		loss[2] = _mm_cvtsi32_si128(format.bLoss);
+		loss[3] = _mm_cvtsi32_si128(format.aLoss);
+		shift[0] = _mm_cvtsi32_si128(format.rShift);
+		shift[1] = _mm_cvtsi32_si128(format.gShift);
+		shift[2] = _mm_cvtsi32_si128(format.bShift);
+		shift[3] = _mm_cvtsi32_si128(format.aShift);
+		itu = lookup->getScale() == YUVToRGBManager::kScaleITU;
+	}
+
+	__m128i loss[4];
+	__m128i shift[4];
+	bool itu;
+};
+
+struct YUVChromaVector {
+	__m128i r, g, b;
+};
+
+static inline YUVVector splatYUV(int16 value) {
+	return _mm_set1_epi16(value);
+}
+
+static inline YUVVector loadYUV8(const byte *src) {
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128());
+}
+
+/** Load four values and use each of them for two pixels. */
+static inline YUVVector loadYUV4Doubled(const byte *src) {
+	const __m128i values = _mm_cvtsi32_si128((int)READ_UINT32(src));
+	return _mm_unpacklo_epi8(_mm_unpacklo_epi8(values, values), _mm_setzero_si128());
+}
+
+/** Vector version of the bilinear chroma interpolation of convertYUV410ToRGB. */
+static inline YUVVector interpolateYUV410(const byte *src, int uvPitch, int yDiff) {
+	const __m128i xDiff = _mm_setr_epi16(0, 1, 2, 3, 0, 1, 2, 3);
+	const __m128i xInv = _mm_setr_epi16(4, 3, 2, 1, 4, 3, 2, 1);
+	const byte *below = src + uvPitch;
+
+	const __m128i a = _mm_setr_epi16(src[0], src[0], src[0], src[0], src[1], src[1], src[1], src[1]);
+	const __m128i b = _mm_setr_epi16(src[1], src[1], src[1], src[1], src[2], src[2], src[2], src[2]);
+	const __m128i c = _mm_setr_epi16(below[0], below[0], below[0], below[0], below[1], below[1], below[1], below[1]);
+	const __m128i d = _mm_setr_epi16(below[1], below[1], below[1], below[1], below[2], below[2], below[2], below[2]);
+
+	const __m128i top = _mm_add_epi16(_mm_mullo_epi16(a, xInv), _mm_mullo_epi16(b, xDiff));
+	const __m128i bottom = _mm_add_epi16(_mm_mullo_epi16(c, xInv), _mm_mullo_epi16(d, xDiff));
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(top, _mm_set1_epi16(4 - yDiff)), _mm_mullo_epi16(bottom, _mm_set1_epi16(yDiff))), 4);
+}
+
+/** Multiply by a fixed point factor, truncating towards zero like a cast from double. */
+static inline __m128i mulTruncSSE2(__m128i x, int shift, int factor) {
+	const __m128i sign = _mm_srai_epi16(x, 15);
+	const __m128i abs = _mm_sub_epi16(_mm_xor_si128(x, sign), sign);
+	const __m128i product = _mm_mulhi_epu16(_mm_sll_epi16(abs, _mm_cvtsi32_si128(shift)), _mm_set1_epi16((int16)factor));
+	return _mm_sub_epi16(_mm_xor_si128(product, sign), sign);
+}
+
+static inline void computeChromaVector(YUVVector u, YUVVector v, YUVChromaVector &chroma) {
+	const __m128i cr = _mm_sub_epi16(v, _mm_set1_epi16(128));
+	const __m128i cb = _mm_sub_epi16(u, _mm_set1_epi16(128));
+
+	chroma.r = mulTruncSSE2(cr, kCrRShift, kCrRFactor);
+	chroma.g = _mm_add_epi16(mulTruncSSE2(cr, kCrGShift, kCrGFactor), mulTruncSSE2(cb, kCbGShift, kCbGFactor));
+	chroma.b = mulTruncSSE2(cb, kCbBShift, kCbBFactor);
+}
+
+static inline __m128i clampComponentSSE2(__m128i x, bool itu) {
+	if (itu) {
+		x = _mm_sub_epi16(_mm_min_epi16(_mm_max_epi16(x, _mm_set1_epi16(16)), _mm_set1_epi16(235)), _mm_set1_epi16(16));
+		return _mm_mulhi_epu16(_mm_slli_epi16(x, kITUShift), _mm_set1_epi16((int16)kITUFactor));
+	}
+
+	return _mm_min_epi16(_mm_max_epi16(x, _mm_setzero_si128()), _mm_set1_epi16(255));
+}
+
+template<typename PixelInt>
+static inline void convertYUVVector(PixelInt *dst, YUVVector y, YUVVector a, const YUVChromaVector &chroma, const YUVToRGBVectorFormat &format) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i components[4];
+	components[0] = clampComponentSSE2(_mm_add_epi16(y, chroma.r), format.itu);
+	components[1] = clampComponentSSE2(_mm_sub_epi16(y, chroma.g), format.itu);
+	components[2] = clampComponentSSE2(_mm_add_epi16(y, chroma.b), format.itu);
+	components[3] = a;
+
+	if (sizeof(PixelInt) == 2) {
+		__m128i pixels = zero;
+		for (int i = 0; i < 4; i++)
+			pixels = _mm_or_si128(pixels, _mm_sll_epi16(_mm_srl_epi16(components[i], format.loss[i]), format.shift[i]));
+		_mm_storeu_si128((__m128i *)dst, pixels);
+	} else {
+		__m128i low = zero, high = zero;
+		for (int i = 0; i < 4; i++) {
+			const __m128i component = _mm_srl_epi16(components[i], format.loss[i]);
+			low = _mm_or_si128(low, _mm_sll_epi32(_mm_unpacklo_epi16(component, zero), format.shift[i]));
+			high = _mm_or_si128(high, _mm_sll_epi32(_mm_unpackhi_epi16(component, zero), format.shift[i]));
+		}
+		_mm_storeu_si128((__m128i *)dst, low);
+		_mm_storeu_si128((__m128i *)(dst + 4), high);
+	}
+}
+
+#endif // USE_SSE2_YUV_TO_RGB
+
+#ifdef USE_NEON_YUV_TO_RGB
+
+typedef int16x8_t YUVVector;
+
+struct YUVToRGBVectorFormat {
+	YUVToRGBVectorFormat(const YUVToRGBLookup *lookup) {
+		const Graphics::PixelFormat &format = lookup->getFormat();
+		const int losses[4] = { format.rLoss, format.gLoss, format.bLoss, format.aLoss };
+		const int shifts[4] = { format.rShift, format.gShift, format.bShift, format.aShift };
+		for (int i = 0; i < 4; i++) {
+			// NEON shifts right by negative counts
+			loss[i] = vdupq_n_s16(-losses[i]);
+			shift16[i] = vdupq_n_s16(shifts[i]);
+			shift32[i] = vdupq_n_s32(shifts[i]);
+		}
+		itu = lookup->getScale() == YUVToRGBManager::kScaleITU;
+	}
+
+	int16x8_t loss[4];
+	int16x8_t shift16[4];
+	int32x4_t shift32[4];
+	bool itu;
+};
+
+struct YUVChromaVector {
+	int16x8_t r, g, b;
+};
+
+static inline YUVVector splatYUV(int16 value) {
+	return vdupq_n_s16(value);
+}
+
+static inline YUVVector loadYUV8(const byte *src) {
+	return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src)));
+}
+
+/** Load four values and use each of them for two pixels. */
+static inline YUVVector loadYUV4Doubled(const byte *src) {
+	const uint8x8_t values = vreinterpret_u8_u32(vdup_n_u32(READ_UINT32(src)));
+	return vreinterpretq_s16_u16(vmovl_u8(vzip_u8(values, values).val[0]));
+}
+
+/** Vector version of the bilinear chroma interpolation of convertYUV410ToRGB. */
+static inline YUVVector interpolateYUV410(const byte *src, int uvPitch, int yDiff) {
+	static const uint16 xDiffValues[8] = { 0, 1, 2, 3, 0, 1, 2, 3 };
+	static const uint16 xInvValues[8] = { 4, 3, 2, 1, 4, 3, 2, 1 };
+	const uint16x8_t xDiff = vld1q_u16(xDiffValues);
+	const uint16x8_t xInv = vld1q_u16(xInvValues);
+	const byte *below = src + uvPitch;
+
+	const uint16x8_t a = vcombine_u16(vdup_n_u16(src[0]), vdup_n_u16(src[1]));
+	const uint16x8_t b = vcombine_u16(vdup_n_u16(src[1]), vdup_n_u16(src[2]));
+	const uint16x8_t c = vcombine_u16(vdup_n_u16(below[0]), vdup_n_u16(below[1]));
+	const uint16x8_t d = vcombine_u16(vdup_n_u16(below[1]), vdup_n_u16(below[2]));
+
+	const uint16x8_t top = vmlaq_u16(vmulq_u16(a, xInv), b, xDiff);
+	const uint16x8_t bottom = vmlaq_u16(vmulq_u16(c, xInv), d, xDiff);
+	const uint16x8_t sum = vmlaq_u16(vmulq_n_u16(top, 4 - yDiff), bottom, vdupq_n_u16(yDiff));
+	return vreinterpretq_s16_u16(vshrq_n_u16(sum, 4));
+}
+
+static inline uint16x8_t mulHighNEON(uint16x8_t x, uint16 factor) {
+	const uint32x4_t low = vmull_n_u16(vget_low_u16(x), factor);
+	const uint32x4_t high = vmull_n_u16(vget_high_u16(x), factor);
+	return vcombine_u16(vshrn_n_u32(low, 16), vshrn_n_u32(high, 16));
+}
+
+/** Multiply by a fixed point factor, truncating towards zero like a cast from double. */
+static inline int16x8_t mulTruncNEON(int16x8_t x, int shift, uint16 factor) {
+	const uint16x8_t abs = vreinterpretq_u16_s16(vshlq_s16(vabsq_s16(x), vdupq_n_s16(shift)));
+	const int16x8_t product = vreinterpretq_s16_u16(mulHighNEON(abs, factor));
+	return vbslq_s16(vcltq_s16(x, vdupq_n_s16(0)), vnegq_s16(product), product);
+}
+
+static inline void computeChromaVector(YUVVector u, YUVVector v, YUVChromaVector &chroma) {
+	const int16x8_t cr = vsubq_s16(v, vdupq_n_s16(128));
+	const int16x8_t cb = vsubq_s16(u, vdupq_n_s16(128));
+
+	chroma.r = mulTruncNEON(cr, kCrRShift, kCrRFactor);
+	chroma.g = vaddq_s16(mulTruncNEON(cr, kCrGShift, kCrGFactor), mulTruncNEON(cb, kCbGShift, kCbGFactor));
+	chroma.b = mulTruncNEON(cb, kCbBShift, kCbBFactor);
 }
 
+static inline uint16x8_t clampComponentNEON(int16x8_t x, bool itu) {
+	if (itu) {
+		x = vsubq_s16(vminq_s16(vmaxq_s16(x, vdupq_n_s16(16)), vdupq_n_s16(235)), vdupq_n_s16(16));
+		return mulHighNEON(vshlq_n_u16(vreinterpretq_u16_s16(x), kITUShift), kITUFactor);
+	}
+
+	return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(x, vdupq_n_s16(0)), vdupq_n_s16(255)));
+}
+
+template<typename PixelInt>
+static inline void convertYUVVector(PixelInt *dst, YUVVector y, YUVVector a, const YUVChromaVector &chroma, const YUVToRGBVectorFormat &format) {
+	uint16x8_t components[4];
+	components[0] = clampComponentNEON(vaddq_s16(y, chroma.r), format.itu);
+	components[1] = clampComponentNEON(vsubq_s16(y, chroma.g), format.itu);
+	components[2] = clampComponentNEON(vaddq_s16(y, chroma.b), format.itu);
+	components[3] = vreinterpretq_u16_s16(a);
+
+	if (sizeof(PixelInt) == 2) {
+		uint16x8_t pixels = vdupq_n_u16(0);
+		for (int i = 0; i < 4; i++)
+			pixels = vorrq_u16(pixels, vshlq_u16(vshlq_u16(components[i], format.loss[i]), format.shift16[i]));
+		vst1q_u16((uint16 *)dst, pixels);
+	} else {
+		uint32x4_t low = vdupq_n_u32(0), high = vdupq_n_u32(0);
+		for (int i = 0; i < 4; i++) {
+			const uint16x8_t component = vshlq_u16(components[i], format.loss[i]);
+			low = vorrq_u32(low, vshlq_u32(vmovl_u16(vget_low_u16(component)), format.shift32[i]));
+			high = vorrq_u32(high, vshlq_u32(vmovl_u16(vget_high_u16(component)), format.shift32[i]));
+		}
+		vst1q_u32((uint32 *)dst, low);
+		vst1q_u32((uint32 *)dst + 4, high);
+	}
+}
+
+#endif // USE_NEON_YUV_TO_RGB
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -216,8 +489,27 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+	const YUVToRGBVectorFormat vectorFormat(lookup);
+	const YUVVector opaque = splatYUV(255);
+#endif
+
 	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
+		int w = 0;
+
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+		for (; w + 8 <= yWidth; w += 8) {
+			YUVChromaVector chroma;
+			computeChromaVector(loadYUV8(uSrc), loadYUV8(vSrc), chroma);
+			convertYUVVector((PixelInt *)dstPtr, loadYUV8(ySrc), opaque, chroma, vectorFormat);
+			uSrc += 8;
+			vSrc += 8;
+			ySrc += 8;
+			dstPtr += 8 * sizeof(PixelInt);
+		}
+#endif
+
+		for (; w < yWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -265,8 +557,28 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+	const YUVToRGBVectorFormat vectorFormat(lookup);
+	const YUVVector opaque = splatYUV(255);
+#endif
+
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		int w = 0;
+
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+		for (; w + 4 <= halfWidth; w += 4) {
+			YUVChromaVector chroma;
+			computeChromaVector(loadYUV4Doubled(uSrc), loadYUV4Doubled(vSrc), chroma);
+			convertYUVVector((PixelInt *)dstPtr, loadYUV8(ySrc), opaque, chroma, vectorFormat);
+			convertYUVVector((PixelInt *)(dstPtr + dstPitch), loadYUV8(ySrc + yPitch), opaque, chroma, vectorFormat);
+			uSrc += 4;
+			vSrc += 4;
+			ySrc += 8;
+			dstPtr += 8 * sizeof(PixelInt);
+		}
+#endif
+
+		for (; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -326,8 +638,28 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *look
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 	const uint32 *aToPix = lookup->getAlphaToPix();
 
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+	const YUVToRGBVectorFormat vectorFormat(lookup);
+#endif
+
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		int w = 0;
+
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+		for (; w + 4 <= halfWidth; w += 4) {
+			YUVChromaVector chroma;
+			computeChromaVector(loadYUV4Doubled(uSrc), loadYUV4Doubled(vSrc), chroma);
+			convertYUVVector((PixelInt *)dstPtr, loadYUV8(ySrc), loadYUV8(aSrc), chroma, vectorFormat);
+			convertYUVVector((PixelInt *)(dstPtr + dstPitch), loadYUV8(ySrc + yPitch), loadYUV8(aSrc + yPitch), chroma, vectorFormat);
+			uSrc += 4;
+			vSrc += 4;
+			ySrc += 8;
+			aSrc += 8;
+			dstPtr += 8 * sizeof(PixelInt);
+		}
+#endif
+
+		for (; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -408,8 +740,27 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 
 	int quarterWidth = yWidth >> 2;
 
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+	const YUVToRGBVectorFormat vectorFormat(lookup);
+	const YUVVector opaque = splatYUV(255);
+#endif
+
 	for (int y = 0; y < yHeight; y++) {
-		for (int x = 0; x < quarterWidth; x++) {
+		int x = 0;
+
+#if defined(USE_SSE2_YUV_TO_RGB) || defined(USE_NEON_YUV_TO_RGB)
+		for (; x + 2 <= quarterWidth; x += 2) {
+			int index = (y >> 2) * uvPitch + x;
+
+			YUVChromaVector chroma;
+			computeChromaVector(interpolateYUV410(uSrc + index, uvPitch, y & 3), interpolateYUV410(vSrc + index, uvPitch, y & 3), chroma);
+			convertYUVVector((PixelInt *)dstPtr, loadYUV8(ySrc), opaque, chroma, vectorFormat);
+			ySrc += 8;
+			dstPtr += 8 * sizeof(PixelInt);
+		}
+#endif
+
+		for (; x < quarterWidth; x++) {
 			// Perform bilinear interpolation on the the chroma values
 			// Based on the algorithm found here: http://tech-algorithm.com/articles/bilinear-image-scaling/
 			// Feel free to optimize further
@@ -39,6 +39,8 @@
 #define GRAPHICS_YUV_TO_RGB_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
+#include "common/atomic.h"
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
@@ -128,9 +130,11 @@ private:
 
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale, bool alphaMode = false);
 
-	YUVToRGBLookup *_lookup;
+	// The lookups are only freed on destruction, since videos may be
+	// decoded on several threads at once
+	Common::Array<YUVToRGBLookup *> _lookups;
+	Common::Atomic<int32> _lookupLock;
 	int16 _colorTab[4 * 256]; // 2048 bytes
-	bool _alphaMode;
 };
  /** @} */
 } // End of namespace Graphics
@@ -35,6 +35,8 @@
 #include "common/stream.h"
 #endif
 
+#include "audio/mixer.h"
+
 #include "engines/engine.h"
 
 #include "gui/debugger.h"
@@ -79,6 +81,8 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+
+	registerCmd("mixer",			WRAP_METHOD(Debugger, cmdMixer));
 }
 
 Debugger::~Debugger() {
@@ -788,6 +792,35 @@ bool Debugger::cmdExecFile(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmdMixer(int argc, const char **argv) {
+	static const char *const soundTypeNames[] = { "plain", "music", "sfx", "speech" };
+
+	Audio::Mixer *mixer = g_system->getMixer();
+	if (!mixer) {
+		debugPrintf("No mixer available\n");
+		return true;
+	}
+
+	uint used = 0;
+	for (uint i = 0; i < mixer->getChannelCount(); i++) {
+		Audio::Mixer::ChannelStats stats;
+		if (!mixer->getChannelStats(i, stats))
+			continue;
+
+		debugPrintf("%3d: %-6s id %d, volume %d, balance %d, %u samples mixed%s%s\n", i,
+		            soundTypeNames[stats.type], stats.id, stats.volume, stats.balance, stats.samplesMixed,
+		            stats.permanent ? ", permanent" : "", stats.paused ? ", paused" : "");
+		used++;
+	}
+	debugPrintf("%d of %d channels in use\n", used, mixer->getChannelCount());
+
+	debugPrintf("Samples mixed per sound type:\n");
+	for (int i = 0; i < ARRAYSIZE(soundTypeNames); i++) {
+		debugPrintf("  %-6s %u\n", soundTypeNames[i], mixer->getSamplesMixedForSoundType((Audio::Mixer::SoundType)i));
+	}
+	return true;
+}
+
 bool Debugger::cmdDebugFlagDisable(int argc, const char **argv) {
 	if (argc < 2) {
 		debugPrintf("debugflag_disable [<flag> | all]\n");
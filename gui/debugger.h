@@ -243,6 +243,7 @@ protected:
 	bool cmdDebugFlagEnable(int argc, const char **argv);
 	bool cmdDebugFlagDisable(int argc, const char **argv);
 	bool cmdExecFile(int argc, const char **argv);
+	bool cmdMixer(int argc, const char **argv);
 
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 private:
@@ -20,6 +20,7 @@
  *
  */
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
@@ -57,6 +58,12 @@ enum {
 
 MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	: Dialog("MassAdd"),
+	_plugins(EngineMan.getPlugins(PLUGIN_TYPE_ENGINE_DETECTION)),
+	_scanningDir(false),
+	_nextPlugin(0),
+	_jobSystem(g_system->getJobSystem()),
+	_nextRunnerPlugin(0),
+	_cancelDetection(0),
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
@@ -114,6 +121,16 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 		if (!path.empty())
 			_pathToTargets[path].push_back(iter->_key);
 	}
+
+	// The thread running the GUI does not help the runners, so that it
+	// stays responsive
+	_runners.resize(_jobSystem->getThreadCount() - 1);
+	for (uint i = 0; i < _runners.size(); ++i)
+		_runners[i].dialog = this;
+}
+
+MassAddDialog::~MassAddDialog() {
+	stopDetection();
 }
 
 struct GameTargetLess {
@@ -160,106 +177,213 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 
 		close();
 	} else if (cmd == kCancelCmd) {
-		// User cancelled, so we don't do anything and just leave.
+		// User cancelled, so we don't do anything and just leave. The
+		// checksums computed so far are still worth keeping though.
+		stopDetection();
 		_games.clear();
+		DetectionCacheMan.flush();
 		close();
 	} else {
 		Dialog::handleCommand(sender, cmd, data);
 	}
 }
 
-void MassAddDialog::handleTickle() {
-	if (_scanStack.empty())
-		return;	// We have finished scanning
+void MassAddDialog::scanNextDirectory() {
+	_currentDir = _scanStack.pop();
+	_currentFiles.clear();
+	_currentCandidates.clear();
+	_nextPlugin = 0;
 
-	uint32 t = g_system->getMillis();
+	if (!_currentDir.getChildren(_currentFiles, Common::FSNode::kListAll))
+		return;
 
-	// Perform a breadth-first scan of the filesystem.
-	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
-		Common::FSNode dir = _scanStack.pop();
+	// Queue all subdirs right away, so that the total is known early
+	for (Common::FSList::const_iterator file = _currentFiles.begin(); file != _currentFiles.end(); ++file) {
+		if (file->isDirectory()) {
+			_scanStack.push(*file);
 
-		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
-			continue;
+			_dirTotal++;
 		}
+	}
 
-		// Run the detector on the dir
-		DetectionResults detectionResults = EngineMan.detectGames(files);
+	_scanningDir = !_currentFiles.empty();
+	if (!_scanningDir) {
+		_dirsScanned++;
+		return;
+	}
 
-		if (detectionResults.foundUnknownGames()) {
-			Common::U32String report = detectionResults.generateUnknownGameReport(false, 80);
-			g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
-		}
+	if (_runners.empty())
+		return;
 
-		// Just add all detected games / game variants. If we get more than one,
-		// that either means the directory contains multiple games, or the detector
-		// could not fully determine which game variant it was seeing. In either
-		// case, let the user choose which entries he wants to keep.
-		//
-		// However, we only add games which are not already in the config file.
-		DetectedGames candidates = detectionResults.listRecognizedGames();
-		for (DetectedGames::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
-			const DetectedGame &result = *cand;
-
-			Common::String path = dir.getPath();
-
-			// Remove trailing slashes
-			while (path != "/" && path.lastChar() == '/')
-				path.deleteLastChar();
-
-			// Check for existing config entries for this path/engineid/gameid/lang/platform combination
-			if (_pathToTargets.contains(path)) {
-				Common::String resultPlatformCode = Common::getPlatformCode(result.platform);
-				Common::String resultLanguageCode = Common::getLanguageCode(result.language);
-
-				bool duplicate = false;
-				const StringArray &targets = _pathToTargets[path];
-				for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
-					// If the engineid, gameid, platform and language match -> skip it
-					Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
-					assert(dom);
-
-					if ((*dom)["engineid"] == result.engineId &&
-						(*dom)["gameid"] == result.gameId &&
-					    (*dom)["platform"] == resultPlatformCode &&
-					    (*dom)["language"] == resultLanguageCode) {
-						duplicate = true;
-						break;
-					}
-				}
-				if (duplicate) {
-					_oldGamesCount++;
-					continue;	// Skip duplicates
+	// FSNodes and strings are reference counted without any locking, so
+	// each runner gets its own copy of the nodes of the directory
+	_nextRunnerPlugin.store(0);
+	for (uint i = 0; i < _runners.size(); ++i) {
+		Common::FSList &files = _runners[i].files;
+		files.clear();
+		for (Common::FSList::const_iterator file = _currentFiles.begin(); file != _currentFiles.end(); ++file)
+			files.push_back(Common::FSNode(Common::String(file->getPath().c_str())));
+
+		_jobSystem->run(_detectionJobs, runDetection, &_runners[i]);
+	}
+}
+
+void MassAddDialog::runDetection(void *refCon) {
+	DetectionRunner *runner = (DetectionRunner *)refCon;
+	MassAddDialog *dialog = runner->dialog;
+
+	for (;;) {
+		const int32 index = dialog->_nextRunnerPlugin.fetchAdd(1);
+		if (index >= (int32)dialog->_plugins.size() || dialog->_cancelDetection.load())
+			break;
+
+		const Plugin *plugin = dialog->_plugins[index];
+		if (!plugin->get<MetaEngineDetection>().isDetectionThreadSafe())
+			continue;
+
+		DetectedGames candidates = EngineMan.detectGames(plugin, runner->files);
+		if (candidates.empty())
+			continue;
+
+		// Release our references to the strings of the candidates before
+		// the main thread can access them
+		Common::StackLock lock(dialog->_detectedGamesMutex);
+		for (uint i = 0; i < candidates.size(); ++i)
+			dialog->_detectedGames.push_back(candidates[i]);
+		candidates.clear();
+	}
+}
+
+void MassAddDialog::stopDetection() {
+	_cancelDetection.store(1);
+	_jobSystem->wait(_detectionJobs);
+}
+
+void MassAddDialog::collectDetectedGames() {
+	DetectedGames candidates;
+	{
+		Common::StackLock lock(_detectedGamesMutex);
+		candidates = _detectedGames;
+		_detectedGames.clear();
+	}
+
+	if (!candidates.empty())
+		addDetectedGames(candidates);
+}
+
+void MassAddDialog::finishDirectory() {
+	DetectionResults detectionResults(_currentCandidates);
+
+	if (detectionResults.foundUnknownGames()) {
+		Common::U32String report = detectionResults.generateUnknownGameReport(false, 80);
+		g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
+	}
+
+	_currentCandidates.clear();
+	_scanningDir = false;
+	_dirsScanned++;
+
+#if defined(USE_TASKBAR)
+	g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
+	g_system->getTaskbarManager()->setCount(_games.size());
+#endif
+}
+
+void MassAddDialog::addDetectedGames(const DetectedGames &candidates) {
+	Common::String path = _currentDir.getPath();
+
+	// Remove trailing slashes
+	while (path != "/" && path.lastChar() == '/')
+		path.deleteLastChar();
+
+	// Just add all detected games / game variants. If we get more than one,
+	// that either means the directory contains multiple games, or the detector
+	// could not fully determine which game variant it was seeing. In either
+	// case, let the user choose which entries he wants to keep.
+	//
+	// However, we only add games which are not already in the config file.
+	for (DetectedGames::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
+		const DetectedGame &result = *cand;
+
+		_currentCandidates.push_back(result);
+
+		if (!result.canBeAdded)
+			continue;
+
+		// Check for existing config entries for this path/engineid/gameid/lang/platform combination
+		if (_pathToTargets.contains(path)) {
+			Common::String resultPlatformCode = Common::getPlatformCode(result.platform);
+			Common::String resultLanguageCode = Common::getLanguageCode(result.language);
+
+			bool duplicate = false;
+			const StringArray &targets = _pathToTargets[path];
+			for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
+				// If the engineid, gameid, platform and language match -> skip it
+				Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
+				assert(dom);
+
+				if ((*dom)["engineid"] == result.engineId &&
+					(*dom)["gameid"] == result.gameId &&
+				    (*dom)["platform"] == resultPlatformCode &&
+				    (*dom)["language"] == resultLanguageCode) {
+					duplicate = true;
+					break;
 				}
 			}
-			_games.push_back(result);
-
-			_list->append(result.description);
+			if (duplicate) {
+				_oldGamesCount++;
+				continue;	// Skip duplicates
+			}
 		}
+		_games.push_back(result);
+
+		_list->append(result.description);
+	}
+}
 
+void MassAddDialog::handleTickle() {
+	if (_scanStack.empty() && !_scanningDir)
+		return;	// We have finished scanning
 
-		// Recurse into all subdirs
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-			if (file->isDirectory()) {
-				_scanStack.push(*file);
+	uint32 t = g_system->getMillis();
 
-				_dirTotal++;
-			}
+	// Perform a depth-first scan of the filesystem. The runners detect the
+	// games in the current directory on the worker threads, while the
+	// detectors which are not thread safe run here, one at a time, so that
+	// the dialog is updated with the games found as soon as possible.
+	while ((_scanningDir || !_scanStack.empty()) && (g_system->getMillis() - t) < kMaxScanTime) {
+		if (!_scanningDir) {
+			scanNextDirectory();
+			continue;
 		}
 
-		_dirsScanned++;
+		if (_nextPlugin < _plugins.size()) {
+			const Plugin *plugin = _plugins[_nextPlugin++];
+			if (_runners.empty() || !plugin->get<MetaEngineDetection>().isDetectionThreadSafe())
+				addDetectedGames(EngineMan.detectGames(plugin, _currentFiles));
+			continue;
+		}
 
-#if defined(USE_TASKBAR)
-		g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
-		g_system->getTaskbarManager()->setCount(_games.size());
-#endif
+		// Wait for the runners in the next calls
+		if (!_detectionJobs.isDone())
+			break;
+
+		collectDetectedGames();
+		finishDirectory();
+	}
+
+	collectDetectedGames();
+
+	if (_scanStack.empty() && !_scanningDir) {
+		// Save the file checksums computed during the scan
+		DetectionCacheMan.flush();
 	}
 
 
 	// Update the dialog
 	Common::U32String buf;
 
-	if (_scanStack.empty()) {
+	if (_scanStack.empty() && !_scanningDir) {
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -25,8 +25,12 @@
 
 #include "gui/dialog.h"
 #include "gui/widgets/list.h"
+#include "base/plugins.h"
+#include "common/atomic.h"
 #include "common/fs.h"
 #include "common/hashmap.h"
+#include "common/jobs.h"
+#include "common/mutex.h"
 #include "common/stack.h"
 #include "common/str.h"
 
@@ -39,6 +43,7 @@ class MassAddDialog : public Dialog {
 	typedef Common::Array<Common::U32String> U32StringArray;
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog() override;
 
 	//void open();
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
@@ -51,9 +56,53 @@ public:
 	}
 
 private:
+	/**
+	 * A job running the thread safe engine detectors on the current
+	 * directory, on a worker thread.
+	 */
+	struct DetectionRunner {
+		MassAddDialog *dialog;
+		/** Copy of _currentFiles, which shares nothing with other threads. */
+		Common::FSList files;
+	};
+
+	static void runDetection(void *refCon);
+
+	void scanNextDirectory();
+	void finishDirectory();
+	void stopDetection();
+	void collectDetectedGames();
+	void addDetectedGames(const DetectedGames &candidates);
+
 	Common::Stack<Common::FSNode>  _scanStack;
 	DetectedGames _games;
 
+	const PluginList &_plugins;
+
+	/**
+	 * The directory currently being scanned. Each call to handleTickle()
+	 * runs as many engine detectors on it as fit in its time budget, so the
+	 * scan of a directory may be spread over several calls. With worker
+	 * threads, handleTickle() only runs the detectors which are not thread
+	 * safe, and the runners take care of the other ones.
+	 */
+	bool _scanningDir;
+	Common::FSNode _currentDir;
+	Common::FSList _currentFiles;
+	DetectedGames _currentCandidates;
+	uint _nextPlugin;
+
+	Common::JobSystem *_jobSystem;
+	Common::Array<DetectionRunner> _runners;
+	Common::JobGroup _detectionJobs;
+	/** Index in _plugins of the next detector for the runners to run. */
+	Common::Atomic<int32> _nextRunnerPlugin;
+	Common::Atomic<int32> _cancelDetection;
+
+	/** Games found by the runners, not yet added to the dialog. */
+	Common::Mutex _detectedGamesMutex;
+	DetectedGames _detectedGames;
+
 	/**
 	 * Map each path occuring in the config file to the target(s) using that path.
 	 * Used to detect whether a potential new target is already present in the
@@ -0,0 +1,179 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/rate.h"
+#include "audio/mixer.h"
+#include "audio/audiostream.h"
+
+#include "helper.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	static int16 clamp16(int val) {
+		return (int16)CLIP<int>(val, -32768, 32767);
+	}
+
+	static int16 scale(int16 sample, int vol) {
+		return (int16)((sample * vol) / Audio::Mixer::kMaxMixerVolume);
+	}
+
+	static int16 *createMixBuffer(const int outPairs) {
+		int16 *obuf = new int16[outPairs * 2];
+		for (int i = 0; i < outPairs * 2; ++i)
+			obuf[i] = (i % 3) ? 30000 : -30000;
+		return obuf;
+	}
+
+	// Check the output of a converter, mixed on top of the buffer from
+	// createMixBuffer, against the expected resampled left and right
+	// channels. The non-zero buffer exercises clamping as well.
+	void checkMixBuffer(const int16 *obuf, const int16 *resampled, const int outPairs,
+	                    const bool reverseStereo, const int volL, const int volR) {
+		for (int i = 0; i < outPairs; ++i) {
+			const int16 expected0 = clamp16(((2 * i + reverseStereo) % 3 ? 30000 : -30000) + scale(resampled[2 * i], volL));
+			const int16 expected1 = clamp16(((2 * i + !reverseStereo) % 3 ? 30000 : -30000) + scale(resampled[2 * i + 1], volR));
+
+			TS_ASSERT_EQUALS(obuf[2 * i + reverseStereo], expected0);
+			TS_ASSERT_EQUALS(obuf[2 * i + !reverseStereo], expected1);
+		}
+	}
+
+	// Each output pair of a converter with rate ratio 'step' uses the input
+	// pair (step * i + offset).
+	void flowTestTemplate(const int inRate, const int outRate, const int step, const int offset,
+	                      const bool isStereo, const bool reverseStereo, const int volL, const int volR) {
+		const int outPairs = 1003;
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, &sine, true, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo);
+
+		int16 *obuf = createMixBuffer(outPairs);
+		TS_ASSERT_EQUALS(converter->flow(*s, obuf, outPairs, volL, volR), outPairs);
+
+		int16 *resampled = new int16[outPairs * 2];
+		for (int i = 0; i < outPairs; ++i) {
+			const int inPair = i * step + offset;
+			resampled[2 * i] = sine[inPair * (isStereo ? 2 : 1)];
+			resampled[2 * i + 1] = isStereo ? sine[inPair * 2 + 1] : resampled[2 * i];
+		}
+		checkMixBuffer(obuf, resampled, outPairs, reverseStereo, volL, volR);
+
+		delete[] resampled;
+		delete[] obuf;
+		delete converter;
+		delete[] sine;
+		delete s;
+	}
+
+	// Rates that are not integer multiples of each other are linearly
+	// interpolated. The reference computation walks the input the same way
+	// as the converter, starting from silence. The output is requested in
+	// two parts, so that the converter has to carry its position over.
+	void linearFlowTestTemplate(const int inRate, const int outRate, const bool isStereo,
+	                            const bool reverseStereo, const int volL, const int volR) {
+		const int outPairs = 1003;
+		const int firstPairs = 389;
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, &sine, true, isStereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, isStereo, reverseStereo);
+
+		int16 *obuf = createMixBuffer(outPairs);
+		TS_ASSERT_EQUALS(converter->flow(*s, obuf, firstPairs, volL, volR), firstPairs);
+		TS_ASSERT_EQUALS(converter->flow(*s, obuf + firstPairs * 2, outPairs - firstPairs, volL, volR), outPairs - firstPairs);
+
+		const int fracBits = 15;
+		const int posIncrement = (inRate << fracBits) / outRate;
+		int pos = 1 << fracBits;
+		int inPair = -1;
+		int last[2] = { 0, 0 };
+		int cur[2] = { 0, 0 };
+
+		int16 *resampled = new int16[outPairs * 2];
+		for (int i = 0; i < outPairs; ++i) {
+			for (; pos >= (1 << fracBits); pos -= (1 << fracBits)) {
+				++inPair;
+				for (int channel = 0; channel < 2; ++channel) {
+					last[channel] = cur[channel];
+					cur[channel] = sine[inPair * (isStereo ? 2 : 1) + (isStereo ? channel : 0)];
+				}
+			}
+
+			for (int channel = 0; channel < 2; ++channel)
+				resampled[2 * i + channel] = (int16)(last[channel] + (((cur[channel] - last[channel]) * pos + (1 << (fracBits - 1))) >> fracBits));
+			pos += posIncrement;
+		}
+		checkMixBuffer(obuf, resampled, outPairs, reverseStereo, volL, volR);
+
+		delete[] resampled;
+		delete[] obuf;
+		delete converter;
+		delete[] sine;
+		delete s;
+	}
+
+public:
+	void test_copy_mono() {
+		flowTestTemplate(11025, 11025, 1, 0, false, false, 256, 100);
+	}
+
+	void test_copy_stereo() {
+		flowTestTemplate(11025, 11025, 1, 0, true, false, 200, 256);
+	}
+
+	void test_copy_stereo_reverse() {
+		flowTestTemplate(11025, 11025, 1, 0, true, true, 37, 255);
+	}
+
+	void test_simple_mono() {
+		flowTestTemplate(22050, 11025, 2, 1, false, false, 128, 256);
+	}
+
+	void test_simple_stereo() {
+		flowTestTemplate(22050, 11025, 2, 1, true, false, 256, 1);
+	}
+
+	void test_simple_stereo_reverse() {
+		flowTestTemplate(33075, 11025, 3, 1, true, true, 256, 64);
+	}
+
+	void test_linear_mono_upsample() {
+		linearFlowTestTemplate(11025, 22050, false, false, 256, 100);
+	}
+
+	void test_linear_stereo_upsample() {
+		linearFlowTestTemplate(22050, 44100, true, false, 200, 256);
+	}
+
+	void test_linear_mono_fractional() {
+		linearFlowTestTemplate(8000, 11025, false, false, 256, 256);
+	}
+
+	void test_linear_stereo_fractional() {
+		linearFlowTestTemplate(44100, 48000, true, false, 256, 37);
+	}
+
+	void test_linear_stereo_reverse_downsample() {
+		linearFlowTestTemplate(48000, 44100, true, true, 64, 256);
+	}
+
+	void test_end_of_data() {
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(11025, 1, &sine, true, true);
+		Audio::RateConverter *converter = Audio::makeRateConverter(11025, 22050, true);
+
+		int16 *obuf = new int16[2 * 2 * 11025 + 100];
+		memset(obuf, 0, sizeof(int16) * (2 * 2 * 11025 + 100));
+
+		// Upsampling by two produces two output pairs per input pair, the
+		// first one being interpolated from silence.
+		TS_ASSERT_EQUALS(converter->flow(*s, obuf, 2 * 11025 + 50, 256, 256), 2 * 11025);
+		TS_ASSERT_EQUALS(obuf[0], 0);
+		TS_ASSERT_EQUALS(obuf[4], sine[0]);
+		TS_ASSERT_EQUALS(obuf[5], sine[1]);
+
+		delete[] obuf;
+		delete converter;
+		delete[] sine;
+		delete s;
+	}
+};
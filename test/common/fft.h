@@ -0,0 +1,63 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/fft.h"
+#include "common/math.h"
+
+class FFTTestSuite : public CxxTest::TestSuite
+{
+	uint32 _seed;
+
+	float nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return ((_seed >> 8) & 1023) / 512.0f - 1.0f;
+	}
+
+	// Compare against a direct evaluation of the DFT, for every size that
+	// goes through a different combination of the fixed size and the
+	// vectorized transforms.
+	void checkTransform(int inverse) {
+		for (int bits = 2; bits <= 10; ++bits) {
+			const int n = 1 << bits;
+			Common::FFT fft(bits, inverse);
+			Common::Complex *z = new Common::Complex[n];
+			Common::Complex *input = new Common::Complex[n];
+
+			for (int i = 0; i < n; ++i) {
+				input[i].re = nextRandom();
+				input[i].im = nextRandom();
+				z[i] = input[i];
+			}
+
+			fft.permute(z);
+			fft.calc(z);
+
+			for (int k = 0; k < n; ++k) {
+				double re = 0.0, im = 0.0;
+				for (int j = 0; j < n; ++j) {
+					const double angle = (inverse ? 2.0 : -2.0) * M_PI * ((j * k) % n) / n;
+					re += input[j].re * cos(angle) - input[j].im * sin(angle);
+					im += input[j].re * sin(angle) + input[j].im * cos(angle);
+				}
+
+				TS_ASSERT_DELTA(z[k].re, re, 1e-4);
+				TS_ASSERT_DELTA(z[k].im, im, 1e-4);
+			}
+
+			delete[] input;
+			delete[] z;
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 1;
+	}
+
+	void test_forward() {
+		checkTransform(0);
+	}
+
+	void test_inverse() {
+		checkTransform(1);
+	}
+};
@@ -0,0 +1,186 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flat-hashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		Common::FlatHashMap<Common::String, Common::String> container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		container2.clear();
+		TS_ASSERT(container2.empty());
+	}
+
+	void test_contains() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(container.contains(0));
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.contains(17));
+		TS_ASSERT(!container.contains(-1));
+
+		Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> container2;
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(container2.contains("foo"));
+		TS_ASSERT(container2.contains("QUUX"));
+		TS_ASSERT(!container2.contains("bar"));
+		TS_ASSERT(!container2.contains("asdf"));
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT(container.contains(1));
+		container.erase(0);
+		TS_ASSERT(!container.empty());
+		container.erase(1);
+		TS_ASSERT(!container.empty());
+		container.erase(2);
+		TS_ASSERT(!container.empty());
+		container.erase(3);
+		TS_ASSERT(!container.empty());
+		container.erase(4);
+		TS_ASSERT(container.empty());
+		container[1] = 33;
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.empty());
+		container.erase(container.find(1));
+		TS_ASSERT(container.empty());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+		container[2] = 45;
+
+		// We take a const ref now to ensure that the map
+		// is not modified by getVal.
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(0, -10), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(container.size(), 3u);
+
+		int val;
+		TS_ASSERT(containerRef.tryGetVal(1, val));
+		TS_ASSERT_EQUALS(val, -1);
+		TS_ASSERT(!containerRef.tryGetVal(3, val));
+	}
+
+	void test_copy() {
+		Common::FlatHashMap<Common::String, int> map1, container2;
+		map1["abc"] = 32;
+		map1["def"] = 16;
+		map1.erase("def");
+		container2 = map1;
+		Common::FlatHashMap<Common::String, int> container3(container2);
+		TS_ASSERT_EQUALS(container2["abc"], 32);
+		TS_ASSERT_EQUALS(container3["abc"], 32);
+		TS_ASSERT(!container3.contains("def"));
+		TS_ASSERT_EQUALS(container3.size(), 1u);
+	}
+
+	void test_collision() {
+		// Identical low bits make all of these keys probe the same slots
+		Common::FlatHashMap<int, int> h;
+		h[5] = 1;
+		h[32+5] = 2;
+		h[64+5] = 3;
+		h[128+5] = 4;
+		h.erase(32+5);
+		TS_ASSERT(h.contains(5));
+		TS_ASSERT(h.contains(64+5));
+		TS_ASSERT(h.contains(128+5));
+		h.erase(5);
+		TS_ASSERT_EQUALS(h[64+5], 3);
+		TS_ASSERT_EQUALS(h[128+5], 4);
+		h[32+5] = 5;
+		TS_ASSERT_EQUALS(h[32+5], 5);
+		TS_ASSERT_EQUALS(h.size(), 3u);
+	}
+
+	void test_erase_while_iterating() {
+		Common::FlatHashMap<int, int> container;
+		for (int i = 0; i < 100; ++i)
+			container[i] = i;
+
+		int visited = 0;
+		for (Common::FlatHashMap<int, int>::iterator i = container.begin(); i != container.end(); ++i) {
+			visited++;
+			if (i->_key % 2)
+				container.erase(i);
+		}
+		TS_ASSERT_EQUALS(visited, 100);
+		TS_ASSERT_EQUALS(container.size(), 50u);
+
+		int sum = 0;
+		for (Common::FlatHashMap<int, int>::const_iterator i = container.begin(); i != container.end(); ++i) {
+			TS_ASSERT_EQUALS(i->_key % 2, 0);
+			sum += i->_value;
+		}
+		TS_ASSERT_EQUALS(sum, 2450);
+	}
+
+	void test_against_hashmap() {
+		// Mix insertions and erasures, which exercises growing as well as
+		// reusing erased slots, and compare with HashMap.
+		Common::FlatHashMap<Common::String, uint> flat;
+		Common::HashMap<Common::String, uint> reference;
+
+		uint seed = 12345;
+		for (int i = 0; i < 20000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint key = (seed >> 16) % 2000;
+			const Common::String keyStr = Common::String::format("key%u", key);
+			if ((seed >> 8) % 3 == 0) {
+				flat.erase(keyStr);
+				reference.erase(keyStr);
+			} else {
+				flat[keyStr] = i;
+				reference[keyStr] = i;
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+		for (Common::HashMap<Common::String, uint>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			TS_ASSERT_EQUALS(flat.getVal(i->_key, 0xFFFFFFFF), i->_value);
+
+		uint count = 0;
+		for (Common::FlatHashMap<Common::String, uint>::const_iterator i = flat.begin(); i != flat.end(); ++i) {
+			TS_ASSERT(reference.contains(i->_key));
+			count++;
+		}
+		TS_ASSERT_EQUALS(count, flat.size());
+
+		flat.clear(true);
+		TS_ASSERT(flat.empty());
+		TS_ASSERT_EQUALS(flat.begin(), flat.end());
+	}
+};
@@ -0,0 +1,197 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/jobs.h"
+#include "common/array.h"
+
+#ifdef POSIX
+#include "common/config-manager.h"
+#include "backends/jobs/pthread/pthread-jobsystem.h"
+#endif
+
+struct JobsTestRecorder {
+	Common::Array<int> order;
+};
+
+struct JobsTestRange {
+	JobsTestRecorder &recorder;
+	explicit JobsTestRange(JobsTestRecorder &r) : recorder(r) {}
+
+	void operator()(uint begin, uint end) {
+		recorder.order.push_back(begin);
+		recorder.order.push_back(end);
+	}
+};
+
+struct JobsTestMark {
+	Common::Array<int> &marks;
+	explicit JobsTestMark(Common::Array<int> &m) : marks(m) {}
+
+	void operator()(uint begin, uint end) {
+		for (uint i = begin; i < end; ++i)
+			marks[i]++;
+	}
+};
+
+struct JobsTestNested {
+	Common::JobSystem *jobSystem;
+	Common::Atomic<int32> count;
+
+	JobsTestNested() : jobSystem(nullptr), count(0) {}
+
+	static void leaf(void *refCon) {
+		((JobsTestNested *)refCon)->count.fetchAdd(1);
+	}
+
+	static void branch(void *refCon) {
+		JobsTestNested *nested = (JobsTestNested *)refCon;
+		Common::JobGroup group;
+		for (int i = 0; i < 10; ++i)
+			nested->jobSystem->run(group, leaf, nested);
+		nested->jobSystem->wait(group);
+		nested->count.fetchAdd(100);
+	}
+};
+
+#ifdef POSIX
+struct JobsTestBackground {
+	pthread_t waitingThread;
+	Common::Atomic<int32> onWaitingThread;
+	JobsTestNested nested;
+
+	JobsTestBackground() : waitingThread(pthread_self()), onWaitingThread(0) {}
+
+	static void proc(void *refCon) {
+		JobsTestBackground *background = (JobsTestBackground *)refCon;
+		if (pthread_equal(pthread_self(), background->waitingThread))
+			background->onWaitingThread.fetchAdd(1);
+
+		// Background jobs may queue regular jobs and wait for them
+		JobsTestNested::branch(&background->nested);
+	}
+};
+#endif
+
+class JobsTestSuite : public CxxTest::TestSuite
+{
+	static void record(void *refCon) {
+		JobsTestRecorder *recorder = (JobsTestRecorder *)refCon;
+		recorder->order.push_back(recorder->order.size());
+	}
+
+	void checkParallelFor(Common::JobSystem &jobSystem) {
+		Common::Array<int> marks;
+		marks.resize(10007);
+		for (uint i = 0; i < marks.size(); ++i)
+			marks[i] = 0;
+
+		JobsTestMark mark(marks);
+		jobSystem.parallelFor(3, 10007, 64, mark);
+
+		for (uint i = 0; i < marks.size(); ++i)
+			TS_ASSERT_EQUALS(marks[i], i < 3 ? 0 : 1);
+	}
+
+	void checkNested(Common::JobSystem &jobSystem) {
+		JobsTestNested nested;
+		nested.jobSystem = &jobSystem;
+
+		// More jobs than fit in a queue, so that some are run right away
+		Common::JobGroup group;
+		for (int i = 0; i < 300; ++i)
+			jobSystem.run(group, JobsTestNested::branch, &nested);
+		jobSystem.wait(group);
+
+		TS_ASSERT(group.isDone());
+		TS_ASSERT_EQUALS(nested.count.load(), 300 * 110);
+	}
+
+public:
+	void test_single_thread_order() {
+		Common::JobSystem jobSystem;
+		TS_ASSERT_EQUALS(jobSystem.getThreadCount(), 1U);
+
+		JobsTestRecorder recorder;
+		Common::JobGroup group;
+		for (int i = 0; i < 5; ++i)
+			jobSystem.run(group, record, &recorder);
+		TS_ASSERT(group.isDone());
+		jobSystem.wait(group);
+
+		TS_ASSERT_EQUALS(recorder.order.size(), 5U);
+		for (uint i = 0; i < recorder.order.size(); ++i)
+			TS_ASSERT_EQUALS(recorder.order[i], (int)i);
+	}
+
+	void test_single_thread_parallel_for() {
+		Common::JobSystem jobSystem;
+
+		JobsTestRecorder recorder;
+		JobsTestRange range(recorder);
+		jobSystem.parallelFor(10, 35, 10, range);
+
+		TS_ASSERT_EQUALS(recorder.order.size(), 6U);
+		TS_ASSERT_EQUALS(recorder.order[0], 10);
+		TS_ASSERT_EQUALS(recorder.order[1], 20);
+		TS_ASSERT_EQUALS(recorder.order[2], 20);
+		TS_ASSERT_EQUALS(recorder.order[3], 30);
+		TS_ASSERT_EQUALS(recorder.order[4], 30);
+		TS_ASSERT_EQUALS(recorder.order[5], 35);
+
+		recorder.order.clear();
+		jobSystem.parallelFor(5, 5, 10, range);
+		TS_ASSERT(recorder.order.empty());
+
+		checkParallelFor(jobSystem);
+		checkNested(jobSystem);
+	}
+
+	void test_single_thread_background() {
+		Common::JobSystem jobSystem;
+		TS_ASSERT(!jobSystem.hasBackgroundThreads());
+
+		JobsTestRecorder recorder;
+		Common::JobGroup group;
+		jobSystem.runInBackground(group, record, &recorder);
+		TS_ASSERT(group.isDone());
+		TS_ASSERT_EQUALS(recorder.order.size(), 1U);
+	}
+
+	void test_threads() {
+#ifdef POSIX
+		ConfMan.setInt("job_threads", 4, Common::ConfigManager::kTransientDomain);
+		PthreadJobSystem jobSystem;
+		ConfMan.removeKey("job_threads", Common::ConfigManager::kTransientDomain);
+
+		TS_ASSERT_EQUALS(jobSystem.getThreadCount(), 4U);
+
+		for (int i = 0; i < 20; ++i) {
+			checkParallelFor(jobSystem);
+			checkNested(jobSystem);
+		}
+#endif
+	}
+
+	void test_threads_background() {
+#ifdef POSIX
+		// Background threads do not depend on the number of workers
+		ConfMan.setInt("job_threads", 1, Common::ConfigManager::kTransientDomain);
+		PthreadJobSystem jobSystem;
+		ConfMan.removeKey("job_threads", Common::ConfigManager::kTransientDomain);
+
+		TS_ASSERT_EQUALS(jobSystem.getThreadCount(), 1U);
+		TS_ASSERT(jobSystem.hasBackgroundThreads());
+
+		JobsTestBackground background;
+		background.nested.jobSystem = &jobSystem;
+
+		Common::JobGroup group;
+		for (int i = 0; i < 50; ++i)
+			jobSystem.runInBackground(group, JobsTestBackground::proc, &background);
+		jobSystem.wait(group);
+
+		TS_ASSERT(group.isDone());
+		TS_ASSERT_EQUALS(background.nested.count.load(), 50 * 110);
+		TS_ASSERT_EQUALS(background.onWaitingThread.load(), 0);
+#endif
+	}
+};
@@ -0,0 +1,96 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/lz4.h"
+
+class LZ4TestSuite : public CxxTest::TestSuite
+{
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	uint32 roundTrip(const byte *data, uint32 size) {
+		const uint32 bound = Common::getLZ4CompressBound(size);
+		byte *compressed = new byte[bound];
+		byte *decompressed = new byte[size + 1];
+
+		const uint32 compressedSize = Common::compressLZ4(data, size, compressed, bound);
+		TS_ASSERT(compressedSize > 0);
+		TS_ASSERT(compressedSize <= bound);
+
+		TS_ASSERT(Common::decompressLZ4(compressed, compressedSize, decompressed, size));
+		TS_ASSERT_EQUALS(memcmp(data, decompressed, size), 0);
+
+		// The size of the decompressed data has to match exactly
+		TS_ASSERT(!Common::decompressLZ4(compressed, compressedSize, decompressed, size + 1));
+		if (size > 0)
+			TS_ASSERT(!Common::decompressLZ4(compressed, compressedSize, decompressed, size - 1));
+
+		delete[] decompressed;
+		delete[] compressed;
+		return compressedSize;
+	}
+
+public:
+	void setUp() {
+		_seed = 1;
+	}
+
+	void test_empty() {
+		byte data = 0;
+		TS_ASSERT_EQUALS(roundTrip(&data, 0), 1u);
+	}
+
+	void test_small() {
+		byte data[20];
+		for (uint32 size = 1; size <= sizeof(data); ++size) {
+			for (uint32 i = 0; i < size; ++i)
+				data[i] = i % 3;
+			roundTrip(data, size);
+		}
+	}
+
+	void test_random() {
+		const uint32 size = 70000;
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; ++i)
+			data[i] = nextRandom() & 0xff;
+
+		roundTrip(data, size);
+		delete[] data;
+	}
+
+	void test_repetitive() {
+		const uint32 size = 100000;
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; ++i) {
+			// Runs of bytes, repeated text and noise
+			if (i < 30000)
+				data[i] = (i / 100) & 0xff;
+			else if (i < 80000)
+				data[i] = "The quick brown fox jumps over the lazy dog. "[i % 45];
+			else
+				data[i] = (nextRandom() & 3) + 'a';
+		}
+
+		TS_ASSERT_LESS_THAN(roundTrip(data, size), size / 4);
+		delete[] data;
+	}
+
+	void test_invalid() {
+		const byte data[] = "abcdabcdabcdabcdabcdabcdabcdabcd";
+		byte compressed[64], decompressed[sizeof(data)];
+		const uint32 compressedSize = Common::compressLZ4(data, sizeof(data), compressed, sizeof(compressed));
+		TS_ASSERT(compressedSize > 0);
+
+		// Truncated data
+		for (uint32 size = 0; size < compressedSize; ++size)
+			TS_ASSERT(!Common::decompressLZ4(compressed, size, decompressed, sizeof(decompressed)));
+
+		// An offset pointing before the start of the output
+		const byte invalidOffset[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+		TS_ASSERT(!Common::decompressLZ4(invalidOffset, sizeof(invalidOffset), decompressed, 5));
+	}
+};
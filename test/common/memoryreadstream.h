@@ -104,4 +104,14 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_raw_data() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		// The raw data does not depend on the position
+		TS_ASSERT_EQUALS(ms.getRawData(), contents);
+		ms.readUint16LE();
+		TS_ASSERT_EQUALS(ms.getRawData(), contents);
+	}
 };
@@ -0,0 +1,100 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#if defined(POSIX) && defined(HAS_POSIX_MMAP)
+#include "backends/fs/posix/posix-iostream.h"
+#include "backends/fs/posix/posix-mmapstream.h"
+#endif
+
+// Keep the temporary file out of the current directory
+static const char *const kMmapTestFile = "/tmp/scummvm_mmapstream_test.bin";
+
+class MmapStreamTestSuite : public CxxTest::TestSuite {
+#if defined(POSIX) && defined(HAS_POSIX_MMAP)
+	static byte patternAt(uint32 pos) {
+		return (pos * 7 + (pos >> 8)) & 0xFF;
+	}
+
+	static bool writeTestFile(uint32 size) {
+		PosixIoStream *file = PosixIoStream::makeFromPath(kMmapTestFile, true);
+		if (!file)
+			return false;
+
+		byte buffer[1024];
+		for (uint32 pos = 0; pos < size; pos += sizeof(buffer)) {
+			const uint32 len = MIN<uint32>(sizeof(buffer), size - pos);
+			for (uint32 i = 0; i < len; ++i)
+				buffer[i] = patternAt(pos + i);
+			file->write(buffer, len);
+		}
+
+		const bool ok = !file->err();
+		delete file;
+		return ok;
+	}
+#endif
+
+public:
+	void test_read_seek_eos() {
+#if defined(POSIX) && defined(HAS_POSIX_MMAP)
+		const uint32 size = PosixMmapStream::kMinMappedSize + 1000;
+		TS_ASSERT(writeTestFile(size));
+
+		PosixMmapStream *stream = PosixMmapStream::makeFromPath(kMmapTestFile);
+		TS_ASSERT(stream != nullptr);
+		if (stream) {
+			TS_ASSERT_EQUALS(stream->size(), (int64)size);
+			TS_ASSERT_EQUALS(stream->pos(), 0);
+
+			byte buffer[16];
+			TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), sizeof(buffer));
+			for (uint32 i = 0; i < sizeof(buffer); ++i)
+				TS_ASSERT_EQUALS(buffer[i], patternAt(i));
+
+			TS_ASSERT(stream->seek(100000, SEEK_SET));
+			TS_ASSERT_EQUALS(stream->readByte(), patternAt(100000));
+			TS_ASSERT(stream->seek(-11, SEEK_CUR));
+			TS_ASSERT_EQUALS(stream->readByte(), patternAt(99990));
+
+			TS_ASSERT(stream->seek(-4, SEEK_END));
+			TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 4U);
+			TS_ASSERT_EQUALS(buffer[3], patternAt(size - 1));
+			TS_ASSERT(stream->eos());
+
+			TS_ASSERT(stream->seek(0, SEEK_SET));
+			TS_ASSERT(!stream->eos());
+
+			const byte *data = stream->getRawData();
+			TS_ASSERT(data != nullptr);
+			if (data) {
+				uint32 mismatches = 0;
+				for (uint32 i = 0; i < size; ++i) {
+					if (data[i] != patternAt(i))
+						mismatches++;
+				}
+				TS_ASSERT_EQUALS(mismatches, 0U);
+			}
+
+			delete stream;
+		}
+
+		remove(kMmapTestFile);
+#endif
+	}
+
+	void test_small_file() {
+#if defined(POSIX) && defined(HAS_POSIX_MMAP)
+		// Small files are left to PosixIoStream
+		TS_ASSERT(writeTestFile(1000));
+		TS_ASSERT(PosixMmapStream::makeFromPath(kMmapTestFile) == nullptr);
+		remove(kMmapTestFile);
+#endif
+	}
+
+	void test_missing_file() {
+#if defined(POSIX) && defined(HAS_POSIX_MMAP)
+		TS_ASSERT(PosixMmapStream::makeFromPath("/tmp/scummvm_mmapstream_missing.bin") == nullptr);
+#endif
+	}
+};
@@ -70,4 +70,20 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_raw_data() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SeekableSubReadStream ssrs(&ms, 3, 7);
+		TS_ASSERT_EQUALS(ssrs.getRawData(), contents + 3);
+
+		// Not all of the range is backed by the parent stream
+		Common::SeekableSubReadStream past(&ms, 3, 12);
+		TS_ASSERT(!past.getRawData());
+
+		// Nested sub streams add up their offsets
+		Common::SeekableSubReadStream nested(&ssrs, 1, 2);
+		TS_ASSERT_EQUALS(nested.getRawData(), contents + 4);
+	}
 };
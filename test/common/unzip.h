@@ -0,0 +1,195 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+class UnzipTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kStoredSize = 10000,
+		kDeflatedSize = 3 * 1024 * 1024 + 123
+	};
+
+	byte *_stored;
+	byte *_deflated;
+
+	static byte *makeData(uint32 size, uint32 seed) {
+		// Somewhat compressible data which is not trivial to deflate
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; ++i) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = 'a' + ((seed >> 24) & 15);
+		}
+		return data;
+	}
+
+	static void writeMember(Common::MemoryWriteStreamDynamic &zip, Common::MemoryWriteStreamDynamic &dir,
+	                        const char *name, const byte *data, uint32 size, bool deflate) {
+		// Use the gzip writer to deflate the data, and strip the 10 byte
+		// header and the 8 byte trailer holding the CRC and the size.
+		Common::MemoryWriteStreamDynamic *gzipData = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(gzipData);
+		gzip->write(data, size);
+		gzip->finalize();
+		const uint32 gzipSize = gzipData->size();
+		byte *gzipBuffer = gzipData->getData();
+		delete gzip;
+
+		const uint32 crc = READ_LE_UINT32(gzipBuffer + gzipSize - 8);
+		const byte *memberData = deflate ? gzipBuffer + 10 : data;
+		const uint32 memberSize = deflate ? gzipSize - 18 : size;
+		const uint32 offset = zip.pos();
+
+		zip.writeUint32LE(0x04034b50);
+		zip.writeUint16LE(20);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(deflate ? 8 : 0);
+		zip.writeUint32LE(0);
+		zip.writeUint32LE(crc);
+		zip.writeUint32LE(memberSize);
+		zip.writeUint32LE(size);
+		zip.writeUint16LE(strlen(name));
+		zip.writeUint16LE(0);
+		zip.write(name, strlen(name));
+		zip.write(memberData, memberSize);
+
+		dir.writeUint32LE(0x02014b50);
+		dir.writeUint16LE(20);
+		dir.writeUint16LE(20);
+		dir.writeUint16LE(0);
+		dir.writeUint16LE(deflate ? 8 : 0);
+		dir.writeUint32LE(0);
+		dir.writeUint32LE(crc);
+		dir.writeUint32LE(memberSize);
+		dir.writeUint32LE(size);
+		dir.writeUint16LE(strlen(name));
+		dir.writeUint16LE(0);
+		dir.writeUint16LE(0);
+		dir.writeUint16LE(0);
+		dir.writeUint16LE(0);
+		dir.writeUint32LE(0);
+		dir.writeUint32LE(offset);
+		dir.write(name, strlen(name));
+
+		free(gzipBuffer);
+	}
+
+	Common::Archive *makeArchive() {
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+		Common::MemoryWriteStreamDynamic dir(DisposeAfterUse::YES);
+
+		writeMember(zip, dir, "stored.dat", _stored, kStoredSize, false);
+		writeMember(zip, dir, "deflated.dat", _deflated, kDeflatedSize, true);
+
+		const uint32 dirOffset = zip.pos();
+		zip.write(dir.getData(), dir.size());
+		zip.writeUint32LE(0x06054b50);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(2);
+		zip.writeUint16LE(2);
+		zip.writeUint32LE(dir.size());
+		zip.writeUint32LE(dirOffset);
+		zip.writeUint16LE(0);
+
+		return Common::makeZipArchive(new Common::MemoryReadStream(zip.getData(), zip.size(), DisposeAfterUse::YES));
+	}
+
+	void checkRead(Common::SeekableReadStream *stream, const byte *expected, uint32 offset, uint32 size) {
+		byte *buffer = new byte[size];
+		TS_ASSERT(stream->seek(offset));
+		TS_ASSERT_EQUALS(stream->read(buffer, size), size);
+		TS_ASSERT_EQUALS(memcmp(buffer, expected + offset, size), 0);
+		TS_ASSERT_EQUALS(stream->pos(), (int32)(offset + size));
+		delete[] buffer;
+	}
+
+public:
+	void setUp() {
+		_stored = makeData(kStoredSize, 1);
+		_deflated = makeData(kDeflatedSize, 2);
+	}
+
+	void tearDown() {
+		delete[] _stored;
+		delete[] _deflated;
+	}
+
+	void test_stored_member() {
+		Common::Archive *archive = makeArchive();
+		TS_ASSERT(archive);
+		TS_ASSERT(archive->hasFile("stored.dat"));
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("stored.dat");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), kStoredSize);
+		checkRead(stream, _stored, 0, kStoredSize);
+		checkRead(stream, _stored, 1234, 100);
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_deflated_sequential() {
+		Common::Archive *archive = makeArchive();
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("deflated.dat");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), kDeflatedSize);
+
+		byte buffer[1000];
+		uint32 pos = 0;
+		while (!stream->eos()) {
+			const uint32 got = stream->read(buffer, sizeof(buffer));
+			TS_ASSERT_EQUALS(memcmp(buffer, _deflated + pos, got), 0);
+			pos += got;
+		}
+		TS_ASSERT_EQUALS(pos, (uint32)kDeflatedSize);
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_deflated_random_access() {
+		Common::Archive *archive = makeArchive();
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("deflated.dat");
+		TS_ASSERT(stream);
+
+		// Going forward first, then going back past the restart points
+		checkRead(stream, _deflated, 100, 4096);
+		checkRead(stream, _deflated, 2500000, 4096);
+		checkRead(stream, _deflated, 1100000, 4096);
+		checkRead(stream, _deflated, 50, 10);
+		checkRead(stream, _deflated, kDeflatedSize - 4096, 4096);
+		checkRead(stream, _deflated, 3000000, 70000);
+		checkRead(stream, _deflated, 1048570, 20);
+
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		byte buffer[20];
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 10u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_members_outlive_archive() {
+		Common::Archive *archive = makeArchive();
+		Common::SeekableReadStream *stored = archive->createReadStreamForMember("stored.dat");
+		Common::SeekableReadStream *deflated = archive->createReadStreamForMember("deflated.dat");
+		delete archive;
+
+		// Reads from both members are interleaved on the same archive stream
+		checkRead(deflated, _deflated, 5000, 300);
+		checkRead(stored, _stored, 5000, 300);
+		checkRead(deflated, _deflated, 5300, 300);
+		checkRead(stored, _stored, 9000, 1000);
+
+		delete stored;
+		delete deflated;
+	}
+};
@@ -0,0 +1,122 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler.h"
+#include "graphics/scaler/intern.h"
+
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+extern "C" uint32 *RGBtoYUV;
+#endif
+
+class HQScalerTestSuite : public CxxTest::TestSuite
+{
+	enum {
+		kWidth = 80,
+		kHeight = 3,
+		// One pixel of border around the image
+		kPitch = kWidth + 2
+	};
+
+	uint16 _pixels[(kHeight + 2) * kPitch];
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	/**
+	 * Fill the image with colors close to each other, so that some of the
+	 * neighbours are just within the thresholds of diffYUV() and some are
+	 * just outside of them.
+	 */
+	void fillImage(uint16 base) {
+		for (int i = 0; i < (kHeight + 2) * kPitch; ++i) {
+			const uint32 r = nextRandom();
+			if (r % 4 == 0)
+				_pixels[i] = base;
+			else
+				_pixels[i] = base ^ ((r >> 2) & 0x18e3);
+		}
+	}
+
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+	// The pattern computation as done by the original per pixel code
+	static int referencePattern(const uint16 *p, uint32 nextlineSrc) {
+		const int w1 = *(p - 1 - nextlineSrc), w2 = *(p - nextlineSrc), w3 = *(p + 1 - nextlineSrc);
+		const int w4 = *(p - 1), w5 = *p, w6 = *(p + 1);
+		const int w7 = *(p - 1 + nextlineSrc), w8 = *(p + nextlineSrc), w9 = *(p + 1 + nextlineSrc);
+
+		int pattern = 0;
+		const int yuv5 = RGBtoYUV[w5];
+		if (w5 != w1 && diffYUV(yuv5, RGBtoYUV[w1])) pattern |= 0x0001;
+		if (w5 != w2 && diffYUV(yuv5, RGBtoYUV[w2])) pattern |= 0x0002;
+		if (w5 != w3 && diffYUV(yuv5, RGBtoYUV[w3])) pattern |= 0x0004;
+		if (w5 != w4 && diffYUV(yuv5, RGBtoYUV[w4])) pattern |= 0x0008;
+		if (w5 != w6 && diffYUV(yuv5, RGBtoYUV[w6])) pattern |= 0x0010;
+		if (w5 != w7 && diffYUV(yuv5, RGBtoYUV[w7])) pattern |= 0x0020;
+		if (w5 != w8 && diffYUV(yuv5, RGBtoYUV[w8])) pattern |= 0x0040;
+		if (w5 != w9 && diffYUV(yuv5, RGBtoYUV[w9])) pattern |= 0x0080;
+		return pattern;
+	}
+
+	void checkPatterns(uint32 bitFormat) {
+		InitScalers(bitFormat);
+
+		const uint16 bases[] = { 0x0000, 0x8410, 0xffff, 0x39e7, 0xc618 };
+		for (int b = 0; b < ARRAYSIZE(bases); ++b) {
+			fillImage(bases[b]);
+
+			// Check every width, so that both the vector and the scalar
+			// code paths are compared against the reference.
+			for (int width = 1; width <= kHQPatternChunk; ++width) {
+				for (int x = 0; x + width <= kWidth; x += 7) {
+					uint8 patterns[kHQPatternChunk];
+					const uint16 *p = _pixels + 2 * kPitch + 1 + x;
+					computeHQPatterns(p, kPitch, width, patterns);
+
+					for (int i = 0; i < width; ++i)
+						TS_ASSERT_EQUALS(patterns[i], referencePattern(p + i, kPitch));
+				}
+			}
+		}
+
+		DestroyScalers();
+	}
+#endif
+
+public:
+	void setUp() {
+		_seed = 1;
+	}
+
+	void test_patterns_565() {
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+		checkPatterns(565);
+#endif
+	}
+
+	void test_patterns_555() {
+#if defined(USE_HQ_SCALERS) && !defined(USE_NASM)
+		checkPatterns(555);
+#endif
+	}
+
+	void test_hq2x_flat() {
+#ifdef USE_HQ_SCALERS
+		InitScalers(565);
+
+		for (int i = 0; i < (kHeight + 2) * kPitch; ++i)
+			_pixels[i] = 0x7bef;
+
+		uint16 output[kHeight * 2][kWidth * 2];
+		HQ2x((const uint8 *)(_pixels + kPitch + 1), kPitch * sizeof(uint16),
+		     (uint8 *)output, kWidth * 2 * sizeof(uint16), kWidth, kHeight);
+
+		for (int y = 0; y < kHeight * 2; ++y)
+			for (int x = 0; x < kWidth * 2; ++x)
+				TS_ASSERT_EQUALS(output[y][x], 0x7bef);
+
+		DestroyScalers();
+#endif
+	}
+};
@@ -0,0 +1,162 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/util.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+	enum {
+		kWidth = 36,
+		kHeight = 12,
+		// Wider than the image, so that the pitch is not ignored
+		kPitch = kWidth + 5
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	void fillPlane(byte *plane, int size) {
+		for (int i = 0; i < size; ++i)
+			plane[i] = nextRandom() & 0xff;
+	}
+
+	static int scaleComponent(int value, Graphics::YUVToRGBManager::LuminanceScale scale) {
+		if (scale == Graphics::YUVToRGBManager::kScaleFull)
+			return CLIP(value, 0, 255);
+
+		return (CLIP(value, 16, 235) - 16) * 255 / 219;
+	}
+
+	// The conversion as done by the YUVToRGBLookup tables
+	static uint32 referencePixel(const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale, byte y, byte u, byte v, byte a) {
+		const int16 cr = v - 128, cb = u - 128;
+		const int r = y + (int16)((0.419 / 0.299) * cr);
+		const int g = y + (int16)(-(0.299 / 0.419) * cr) + (int16)(-(0.114 / 0.331) * cb);
+		const int b = y + (int16)((0.587 / 0.331) * cb);
+		return format.ARGBToColor(a, scaleComponent(r, scale), scaleComponent(g, scale), scaleComponent(b, scale));
+	}
+
+	static const Graphics::PixelFormat *formats(int &count) {
+		static const Graphics::PixelFormat pixelFormats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 12, 8, 4, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0)
+		};
+		count = ARRAYSIZE(pixelFormats);
+		return pixelFormats;
+	}
+
+	void checkPixel(const Graphics::Surface &surface, int x, int y, uint32 expected) {
+		if (surface.format.bytesPerPixel == 2) {
+			TS_ASSERT_EQUALS(*(const uint16 *)surface.getBasePtr(x, y), expected);
+		} else {
+			TS_ASSERT_EQUALS(*(const uint32 *)surface.getBasePtr(x, y), expected);
+		}
+	}
+
+	void checkConversion(int planes, bool alpha, Graphics::YUVToRGBManager::LuminanceScale scale) {
+		// The chroma planes are large enough for the extra 410 row and column
+		byte yPlane[kHeight * kPitch], aPlane[kHeight * kPitch];
+		byte uPlane[(kHeight + 1) * kPitch], vPlane[(kHeight + 1) * kPitch];
+		fillPlane(yPlane, sizeof(yPlane));
+		fillPlane(aPlane, sizeof(aPlane));
+		fillPlane(uPlane, sizeof(uPlane));
+		fillPlane(vPlane, sizeof(vPlane));
+
+		int formatCount;
+		const Graphics::PixelFormat *pixelFormats = formats(formatCount);
+		for (int f = 0; f < formatCount; ++f) {
+			Graphics::Surface surface;
+			surface.create(kWidth, kHeight, pixelFormats[f]);
+
+			if (alpha)
+				YUVToRGBMan.convert420Alpha(&surface, scale, yPlane, uPlane, vPlane, aPlane, kWidth, kHeight, kPitch, kPitch);
+			else if (planes == 1)
+				YUVToRGBMan.convert444(&surface, scale, yPlane, uPlane, vPlane, kWidth, kHeight, kPitch, kPitch);
+			else if (planes == 2)
+				YUVToRGBMan.convert420(&surface, scale, yPlane, uPlane, vPlane, kWidth, kHeight, kPitch, kPitch);
+			else
+				YUVToRGBMan.convert410(&surface, scale, yPlane, uPlane, vPlane, kWidth, kHeight, kPitch, kPitch);
+
+			for (int y = 0; y < kHeight; ++y) {
+				for (int x = 0; x < kWidth; ++x) {
+					const int index = (y / planes) * kPitch + x / planes;
+					byte u = uPlane[index], v = vPlane[index];
+
+					if (planes == 4) {
+						const int xDiff = x & 3, yDiff = y & 3;
+						const int weights[4] = { (4 - xDiff) * (4 - yDiff), xDiff * (4 - yDiff), (4 - xDiff) * yDiff, xDiff * yDiff };
+						u = (uPlane[index] * weights[0] + uPlane[index + 1] * weights[1] + uPlane[index + kPitch] * weights[2] + uPlane[index + kPitch + 1] * weights[3]) >> 4;
+						v = (vPlane[index] * weights[0] + vPlane[index + 1] * weights[1] + vPlane[index + kPitch] * weights[2] + vPlane[index + kPitch + 1] * weights[3]) >> 4;
+					}
+
+					const byte a = alpha ? aPlane[y * kPitch + x] : 255;
+					checkPixel(surface, x, y, referencePixel(pixelFormats[f], scale, yPlane[y * kPitch + x], u, v, a));
+				}
+			}
+
+			surface.free();
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 1;
+	}
+
+	void test_all_chroma_values() {
+		// Every combination of u and v, with random luminance
+		byte yPlane[256], uPlane[256], vPlane[256];
+		for (int i = 0; i < 256; ++i)
+			uPlane[i] = i;
+
+		const Graphics::YUVToRGBManager::LuminanceScale scales[] = { Graphics::YUVToRGBManager::kScaleFull, Graphics::YUVToRGBManager::kScaleITU };
+		int formatCount;
+		const Graphics::PixelFormat *pixelFormats = formats(formatCount);
+		for (int s = 0; s < ARRAYSIZE(scales); ++s) {
+			for (int f = 0; f < formatCount; ++f) {
+				Graphics::Surface surface;
+				surface.create(256, 1, pixelFormats[f]);
+
+				for (int v = 0; v < 256; ++v) {
+					fillPlane(yPlane, sizeof(yPlane));
+					memset(vPlane, v, sizeof(vPlane));
+					YUVToRGBMan.convert444(&surface, scales[s], yPlane, uPlane, vPlane, 256, 1, 256, 256);
+
+					for (int x = 0; x < 256; ++x)
+						checkPixel(surface, x, 0, referencePixel(pixelFormats[f], scales[s], yPlane[x], x, v, 255));
+				}
+
+				surface.free();
+			}
+		}
+	}
+
+	void test_convert444() {
+		checkConversion(1, false, Graphics::YUVToRGBManager::kScaleFull);
+		checkConversion(1, false, Graphics::YUVToRGBManager::kScaleITU);
+	}
+
+	void test_convert420() {
+		checkConversion(2, false, Graphics::YUVToRGBManager::kScaleFull);
+		checkConversion(2, false, Graphics::YUVToRGBManager::kScaleITU);
+	}
+
+	void test_convert420Alpha() {
+		checkConversion(2, true, Graphics::YUVToRGBManager::kScaleFull);
+		checkConversion(2, true, Graphics::YUVToRGBManager::kScaleITU);
+	}
+
+	void test_convert410() {
+		checkConversion(4, false, Graphics::YUVToRGBManager::kScaleFull);
+		checkConversion(4, false, Graphics::YUVToRGBManager::kScaleITU);
+	}
+};
@@ -0,0 +1,74 @@
+#include <cxxtest/TestSuite.h>
+
+#include "video/decode_ahead.h"
+
+class DecodeAheadRingTestSuite : public CxxTest::TestSuite
+{
+public:
+	void test_empty_and_full() {
+		Video::DecodeAheadRing ring;
+		ring.reset(3);
+		TS_ASSERT_EQUALS(ring.getSize(), 3U);
+		TS_ASSERT(ring.isEmpty());
+		TS_ASSERT(!ring.isFull());
+
+		// One slot is kept for the frame handed out last
+		ring.commitProduced();
+		TS_ASSERT(!ring.isEmpty());
+		TS_ASSERT(!ring.isFull());
+		ring.commitProduced();
+		TS_ASSERT(ring.isFull());
+
+		ring.commitConsumed();
+		TS_ASSERT(!ring.isEmpty());
+		TS_ASSERT(!ring.isFull());
+		ring.commitConsumed();
+		TS_ASSERT(ring.isEmpty());
+
+		ring.reset(3);
+		TS_ASSERT(ring.isEmpty());
+		TS_ASSERT_EQUALS(ring.getProducerSlot(), 0U);
+		TS_ASSERT_EQUALS(ring.getConsumerSlot(), 0U);
+	}
+
+	void test_slot_order() {
+		Video::DecodeAheadRing ring;
+		ring.reset(4);
+
+		uint frameInSlot[4];
+		uint nextFrame = 0;
+		uint lastSlot = 4;
+
+		for (uint frame = 0; frame < 50; frame++) {
+			// Decode as far ahead as possible, sparing the frame shown
+			while (!ring.isFull()) {
+				const uint slot = ring.getProducerSlot();
+				TS_ASSERT_LESS_THAN(slot, 4U);
+				TS_ASSERT_DIFFERS(slot, lastSlot);
+				frameInSlot[slot] = nextFrame++;
+				ring.commitProduced();
+			}
+
+			// Frames are handed out in the order they were decoded
+			TS_ASSERT(!ring.isEmpty());
+			lastSlot = ring.getConsumerSlot();
+			TS_ASSERT_EQUALS(frameInSlot[lastSlot], frame);
+			ring.commitConsumed();
+		}
+	}
+
+	void test_consumer_decoding() {
+		// Without a frame decoded ahead, the consumer decodes it itself
+		Video::DecodeAheadRing ring;
+		ring.reset(2);
+
+		for (uint frame = 0; frame < 5; frame++) {
+			TS_ASSERT(ring.isEmpty());
+			const uint slot = ring.getProducerSlot();
+			ring.commitProduced();
+			TS_ASSERT(ring.isFull());
+			TS_ASSERT_EQUALS(ring.getConsumerSlot(), slot);
+			ring.commitConsumed();
+		}
+	}
+};
@@ -38,6 +38,7 @@
 #include "common/huffman.h"
 #include "common/rdft.h"
 #include "common/dct.h"
+#include "common/jobs.h"
 #include "common/system.h"
 
 #include "graphics/yuv_to_rgb.h"
@@ -61,6 +62,39 @@ static const uint32 kDCStartBits = 11;
 
 namespace Video {
 
+/**
+ * Converts bands of rows of the YUV planes of a frame, so that they can be
+ * converted in parallel. The bands start on even rows, to keep the chroma
+ * rows shared by two luma rows in the same band.
+ */
+struct BinkConversionBands {
+	enum {
+		kBandHeight = 32
+	};
+
+	Graphics::YUVToRGBManager *manager;
+	Graphics::Surface *surface;
+	const byte *planes[4];
+	int width;
+	int yPitch;
+	int uvPitch;
+
+	void operator()(uint begin, uint end) const {
+		Graphics::Surface band;
+		band.init(width, end - begin, surface->pitch, surface->getBasePtr(0, begin), surface->format);
+
+		const byte *y = planes[0] + begin * yPitch;
+		const byte *u = planes[1] + (begin / 2) * uvPitch;
+		const byte *v = planes[2] + (begin / 2) * uvPitch;
+
+		if (planes[3])
+			manager->convert420Alpha(&band, Graphics::YUVToRGBManager::kScaleITU, y, u, v, planes[3] + begin * yPitch,
+					width, end - begin, yPitch, uvPitch);
+		else
+			manager->convert420(&band, Graphics::YUVToRGBManager::kScaleITU, y, u, v, width, end - begin, yPitch, uvPitch);
+	}
+};
+
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
 }
@@ -246,6 +280,10 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id) {
 	_curFrame = -1;
 
+	// Frames may be decoded ahead from a job, which must not call into
+	// OSystem, so the job system is looked up here
+	_jobSystem = g_system->getJobSystem();
+
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
 
@@ -492,18 +530,16 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 			break;
 	}
 
-	// Convert the YUV data we have to our format
+	// Convert the YUV data we have to our format, in parallel bands.
 	// The width used here is the surface-width, and not the video-width
 	// to allow for odd-sized videos.
-	if (_hasAlpha) {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && _curPlanes[3]);
-		YUVToRGBMan.convert420Alpha(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2], _curPlanes[3],
-				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
-	} else {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-		YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
-				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
-	}
+	assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && (!_hasAlpha || _curPlanes[3]));
+	BinkConversionBands bands = {
+		&YUVToRGBMan, &_surface,
+		{ _curPlanes[0], _curPlanes[1], _curPlanes[2], _hasAlpha ? _curPlanes[3] : nullptr },
+		_surfaceWidth, (int)_yBlockWidth * 8, (int)_uvBlockWidth * 8
+	};
+	_jobSystem->parallelFor(0, _surfaceHeight, BinkConversionBands::kBandHeight, bands);
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
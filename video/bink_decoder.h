@@ -78,6 +78,7 @@ public:
 protected:
 	void readNextPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
+	bool supportsDecodeAhead() const { return true; }
 	AudioTrack *getAudioTrack(int index);
 	bool seekIntern(const Audio::Timestamp &time);
 	uint32 findKeyFrame(uint32 frame) const;
@@ -270,6 +271,9 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		/** Splits the color conversion over several threads. */
+		Common::JobSystem *_jobSystem;
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
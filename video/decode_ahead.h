@@ -0,0 +1,80 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef VIDEO_DECODE_AHEAD_H
+#define VIDEO_DECODE_AHEAD_H
+
+#include "common/atomic.h"
+
+namespace Video {
+
+/**
+ * Bookkeeping of the pool of frames decoded ahead of time.
+ *
+ * One thread decodes frames into the slots of the pool, in order, while
+ * another one hands them out. The slot handed out last stays reserved
+ * until the next one is handed out, since its frame may still be shown,
+ * so at most size - 1 frames are waiting at any time.
+ */
+class DecodeAheadRing {
+public:
+	DecodeAheadRing() : _size(0), _produced(0), _consumed(0) {}
+
+	/** Drop all frames and resize the pool. No thread may be decoding. */
+	void reset(uint size) {
+		_size = size;
+		_produced.store(0);
+		_consumed.store(0);
+	}
+
+	uint getSize() const { return _size; }
+
+	/** Return true if no decoded frame is waiting to be handed out. */
+	bool isEmpty() const { return _produced.load() == _consumed.load(); }
+
+	/** Return true if there is no slot left to decode a frame into. */
+	bool isFull() const { return _produced.load() - _consumed.load() >= _size - 1; }
+
+	/** Return the slot to decode the next frame into. */
+	uint getProducerSlot() const { return _produced.load() % _size; }
+
+	/** Publish the frame decoded into the producer slot. */
+	void commitProduced() { _produced.store(_produced.load() + 1); }
+
+	/** Return the slot of the next frame to hand out. */
+	uint getConsumerSlot() const { return _consumed.load() % _size; }
+
+	/**
+	 * Mark the frame in the consumer slot as handed out. Its slot is
+	 * released by the next call.
+	 */
+	void commitConsumed() { _consumed.store(_consumed.load() + 1); }
+
+private:
+	uint _size;
+	Common::Atomic<uint32> _produced;
+	Common::Atomic<uint32> _consumed;
+};
+
+} // End of namespace Video
+
+#endif
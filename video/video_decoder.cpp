@@ -30,9 +30,18 @@
 #include "common/system.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+struct VideoDecoder::DecodeAheadFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	bool dirtyPalette;
+	byte palette[256 * 3];
+	DecodeAheadState state;
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -49,6 +58,9 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAheadFrames = 0;
+	_decodeAheadActive = false;
+	_decodeAheadBlocked = false;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -57,7 +69,13 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	setDecodeAhead(0);
+}
+
 void VideoDecoder::close() {
+	stopDecodeAhead();
+
 	if (isPlaying())
 		stop();
 
@@ -185,6 +203,9 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	if (canDecodeAhead())
+		return decodeNextFrameAhead();
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -213,6 +234,8 @@ bool VideoDecoder::setReverse(bool reverse) {
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
+			stopDecodeAhead();
+
 			if (!((VideoTrack *)*it)->setReverse(reverse))
 				return false;
 
@@ -230,6 +253,9 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	if (_decodeAheadActive)
+		return _decodeAheadState.curFrame;
+
 	int32 frame = -1;
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
@@ -275,7 +301,7 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getVideoTrackNextFrameStartTime(_nextVideoTrack);
 
 	if (_nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
@@ -296,8 +322,10 @@ bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool isVideoTrack = track->getTrackType() == Track::kTrackTypeVideo;
+		bool videoEndTimeReached = _endTimeSet && isVideoTrack && getVideoTrackNextFrameStartTime((const VideoTrack *)track) >= (uint)_endTime.msecs();
+		bool trackEndReached = isVideoTrack ? isVideoTrackAtEnd((const VideoTrack *)track) : track->endOfTrack();
+		bool endReached = trackEndReached || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return false;
 	}
@@ -320,6 +348,8 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	stopDecodeAhead();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -358,8 +388,14 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (isPlaying())
 		stopAudio();
 
-	// Do the actual seeking
-	if (!seekIntern(time))
+	// Do the actual seeking. This may decode frames to get to the requested
+	// time, which must not happen ahead of time.
+	stopDecodeAhead();
+	_decodeAheadBlocked = true;
+	bool seeked = seekIntern(time);
+	_decodeAheadBlocked = false;
+
+	if (!seeked)
 		return false;
 
 	// Seek any external track too
@@ -715,6 +751,8 @@ bool VideoDecoder::StreamFileAudioTrack::loadFromFile(const Common::String &base
 }
 
 void VideoDecoder::addTrack(Track *track, bool isExternal) {
+	stopDecodeAhead();
+
 	_tracks.push_back(track);
 
 	if (isExternal)
@@ -861,7 +899,7 @@ const VideoDecoder::Track *VideoDecoder::getTrack(uint track) const {
 
 bool VideoDecoder::endOfVideoTracks() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack())
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !isVideoTrackAtEnd((const VideoTrack *)*it))
 			return false;
 
 	return true;
@@ -921,8 +959,8 @@ bool VideoDecoder::hasFramesLeft() const {
 
 		const VideoTrack *track = (const VideoTrack *)*it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && getVideoTrackNextFrameStartTime(track) >= (uint)_endTime.msecs();
+		bool endReached = isVideoTrackAtEnd(track) || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return true;
 	}
@@ -939,6 +977,8 @@ bool VideoDecoder::hasAudio() const {
 }
 
 void VideoDecoder::eraseTrack(Track *track) {
+	stopDecodeAhead();
+
 	for (uint idx = 0; idx < _externalTracks.size(); ++idx) {
 		if (_externalTracks[idx] == track)
 			_externalTracks.remove_at(idx);
@@ -955,4 +995,144 @@ void VideoDecoder::eraseTrack(Track *track) {
 	}
 }
 
+bool VideoDecoder::setDecodeAhead(uint frames) {
+	stopDecodeAhead();
+
+	for (uint i = 0; i < _decodeAheadRing.getSize(); i++)
+		_decodeAheadFrames[i].surface.free();
+
+	delete[] _decodeAheadFrames;
+	_decodeAheadFrames = 0;
+	_decodeAheadRing.reset(0);
+
+	// One frame is the one currently shown, so at least two are needed
+	if (frames < 2 || !supportsDecodeAhead() || !g_system->getJobSystem()->hasBackgroundThreads())
+		return false;
+
+	_decodeAheadRing.reset(frames);
+	_decodeAheadFrames = new DecodeAheadFrame[frames];
+	return true;
+}
+
+bool VideoDecoder::canDecodeAhead() const {
+	if (!_decodeAheadRing.getSize() || _decodeAheadBlocked || !_nextVideoTrack || _nextVideoTrack->isReversed())
+		return false;
+
+	// The state of the decoded frames is only kept for a single video track
+	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && *it != _nextVideoTrack)
+			return false;
+
+	return true;
+}
+
+const Graphics::Surface *VideoDecoder::decodeNextFrameAhead() {
+	if (!_decodeAheadActive) {
+		// From now on, the state of the video track is reported as of the
+		// last frame handed out, since the track itself may be ahead
+		_decodeAheadState.curFrame = _nextVideoTrack->getCurFrame();
+		_decodeAheadState.nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+		_decodeAheadState.endOfTrack = _nextVideoTrack->endOfTrack();
+		_decodeAheadRing.reset(_decodeAheadRing.getSize());
+		_decodeAheadActive = true;
+	}
+
+	// If no frame is ready, decoding it right here is faster than waiting
+	// for the job to finish all of the frames it is about to decode.
+	if (_decodeAheadRing.isEmpty()) {
+		if (!_decodeAheadJob.isDone()) {
+			_decodeAheadStop.store(1);
+			g_system->getJobSystem()->wait(_decodeAheadJob);
+			_decodeAheadStop.store(0);
+		}
+
+		if (_decodeAheadRing.isEmpty())
+			decodeFrameAhead();
+	}
+
+	DecodeAheadFrame &frame = _decodeAheadFrames[_decodeAheadRing.getConsumerSlot()];
+
+	if (frame.dirtyPalette) {
+		memcpy(_decodeAheadPalette, frame.palette, sizeof(_decodeAheadPalette));
+		_palette = _decodeAheadPalette;
+		_dirtyPalette = true;
+	}
+
+	_decodeAheadState = frame.state;
+
+	// The frame stays reserved until the next call
+	_decodeAheadRing.commitConsumed();
+	startDecodeAhead();
+
+	return frame.hasSurface ? &frame.surface : 0;
+}
+
+void VideoDecoder::decodeFrameAhead() {
+	DecodeAheadFrame &frame = _decodeAheadFrames[_decodeAheadRing.getProducerSlot()];
+
+	readNextPacket();
+	const Graphics::Surface *surface = _nextVideoTrack->decodeNextFrame();
+
+	frame.hasSurface = surface != 0;
+	if (surface) {
+		if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format) {
+			frame.surface.free();
+			frame.surface.create(surface->w, surface->h, surface->format);
+		}
+
+		frame.surface.copyRectToSurface(surface->getPixels(), surface->pitch, 0, 0, surface->w, surface->h);
+	}
+
+	frame.dirtyPalette = _nextVideoTrack->hasDirtyPalette();
+	if (frame.dirtyPalette)
+		memcpy(frame.palette, _nextVideoTrack->getPalette(), sizeof(frame.palette));
+
+	frame.state.curFrame = _nextVideoTrack->getCurFrame();
+	frame.state.nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	frame.state.endOfTrack = _nextVideoTrack->endOfTrack();
+
+	_decodeAheadRing.commitProduced();
+}
+
+void VideoDecoder::startDecodeAhead() {
+	// Decoding ahead takes long and reads the stream, so it must not be
+	// picked up by threads waiting for other jobs
+	if (_decodeAheadJob.isDone() && !_nextVideoTrack->endOfTrack())
+		g_system->getJobSystem()->runInBackground(_decodeAheadJob, &decodeAheadProc, this);
+}
+
+void VideoDecoder::stopDecodeAhead() {
+	if (!_decodeAheadActive)
+		return;
+
+	_decodeAheadStop.store(1);
+	g_system->getJobSystem()->wait(_decodeAheadJob);
+	_decodeAheadStop.store(0);
+
+	// The frames decoded ahead are dropped, which is fine for callers
+	// that move the tracks to another position anyway.
+	_decodeAheadActive = false;
+}
+
+void VideoDecoder::decodeAheadProc(void *refCon) {
+	VideoDecoder *decoder = (VideoDecoder *)refCon;
+
+	while (!decoder->_decodeAheadStop.load() && !decoder->_nextVideoTrack->endOfTrack() && !decoder->_decodeAheadRing.isFull())
+		decoder->decodeFrameAhead();
+}
+
+bool VideoDecoder::isVideoTrackAtEnd(const VideoTrack *track) const {
+	if (_decodeAheadActive && track == _nextVideoTrack)
+		return _decodeAheadState.endOfTrack;
+
+	return track->endOfTrack();
+}
+
+uint32 VideoDecoder::getVideoTrackNextFrameStartTime(const VideoTrack *track) const {
+	if (_decodeAheadActive && track == _nextVideoTrack)
+		return _decodeAheadState.nextFrameStartTime;
+
+	return track->getNextFrameStartTime();
+}
+
 } // End of namespace Video
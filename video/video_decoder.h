@@ -26,9 +26,12 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/atomic.h"
+#include "common/jobs.h"
 #include "common/rational.h"
 #include "common/str.h"
 #include "graphics/pixelformat.h"
+#include "video/decode_ahead.h"
 
 namespace Audio {
 class AudioStream;
@@ -52,7 +55,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -396,6 +399,30 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Decode frames ahead of time on a background thread of the job system.
+	 *
+	 * Up to @p frames - 1 frames are then decoded in the background while
+	 * the current one is shown, so that decodeNextFrame() usually only has
+	 * to hand out a frame which is already decoded. The frames are copied
+	 * into a pool of surfaces owned by the VideoDecoder.
+	 *
+	 * The stream passed to loadStream() is then read on the background
+	 * thread. It must not share any state with streams used elsewhere in
+	 * the meantime. Files opened from the file system, such as the ones
+	 * returned by SearchMan for plain directories, and memory streams are
+	 * fine, but not sub-streams of an archive file which is still read by
+	 * other code.
+	 *
+	 * This only works with decoders supporting it, for videos with a single
+	 * video track played forward. In all other cases, and if the backend
+	 * has no background threads, frames are decoded when requested as usual.
+	 *
+	 * @param frames the number of frames to keep decoded, or 0 to disable
+	 * @return true if frames may be decoded ahead, false otherwise
+	 */
+	bool setDecodeAhead(uint frames);
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -926,6 +953,19 @@ protected:
 	 */
 	virtual AudioTrack *getAudioTrack(int index) { return 0; }
 
+	/**
+	 * Whether or not frames may be decoded ahead on a background thread.
+	 *
+	 * Returning true means that readNextPacket() and the decodeNextFrame()
+	 * function of the video track may run on another thread while the
+	 * video is playing. They must then only access data owned by the
+	 * decoder and its tracks, and audio tracks must accept data while they
+	 * are playing.
+	 *
+	 * @see setDecodeAhead()
+	 */
+	virtual bool supportsDecodeAhead() const { return false; }
+
 private:
 	// Tracks owned by this VideoDecoder
 	TrackList _tracks;
@@ -964,6 +1004,33 @@ private:
 	Audio::Mixer::SoundType _soundType;
 
 	AudioTrack *_mainAudioTrack;
+
+	// Decoding frames ahead on a background thread
+	struct DecodeAheadState {
+		int curFrame;
+		uint32 nextFrameStartTime;
+		bool endOfTrack;
+	};
+
+	struct DecodeAheadFrame;
+
+	DecodeAheadRing _decodeAheadRing;
+	DecodeAheadFrame *_decodeAheadFrames;
+	bool _decodeAheadActive;
+	bool _decodeAheadBlocked;
+	DecodeAheadState _decodeAheadState;
+	byte _decodeAheadPalette[256 * 3];
+	Common::Atomic<int32> _decodeAheadStop;
+	Common::JobGroup _decodeAheadJob;
+
+	bool canDecodeAhead() const;
+	const Graphics::Surface *decodeNextFrameAhead();
+	void decodeFrameAhead();
+	void startDecodeAhead();
+	void stopDecodeAhead();
+	static void decodeAheadProc(void *refCon);
+	bool isVideoTrackAtEnd(const VideoTrack *track) const;
+	uint32 getVideoTrackNextFrameStartTime(const VideoTrack *track) const;
 };
 
 } // End of namespace Video
@@ -0,0 +1,46 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef VIDEO_VIDEO_FACTORY_H
+#define VIDEO_VIDEO_FACTORY_H
+
+#include "common/str.h"
+
+namespace Video {
+
+class VideoDecoder;
+
+/**
+ * Create a decoder for a stand-alone video file, based on its extension.
+ *
+ * AVI, QuickTime and Smacker files are supported, as well as Bink files
+ * when Bink support is compiled in. The decoder still has to be given the
+ * file contents with loadStream().
+ *
+ * @param fileName	the name of the video file
+ * @return a new decoder, or 0 if the format is not supported
+ */
+VideoDecoder *createDecoderForFile(const Common::String &fileName);
+
+} // End of namespace Video
+
+#endif